@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Java compile daemon keeps a JVM with the system Java compiler loaded, so that compiling Java
+ * doesn't pay for the startup of javac every time. It's compiled and started by Core::JavaCompileDaemon.
+ *
+ * Each request is a line of space separated Base64 encoded UTF-8 javac arguments.
+ * Each response is a line of the exit code of javac and its Base64 encoded diagnostics, separated by a space.
+ * The daemon exits when its stdin is closed.
+ */
+
+import java.io.BufferedReader;
+import java.io.ByteArrayOutputStream;
+import java.io.FileDescriptor;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.PrintStream;
+import java.nio.charset.StandardCharsets;
+import java.util.Base64;
+import javax.tools.JavaCompiler;
+import javax.tools.ToolProvider;
+
+public class CompileDaemon
+{
+    public static void main(String[] args) throws IOException
+    {
+        JavaCompiler compiler = ToolProvider.getSystemJavaCompiler();
+        BufferedReader in = new BufferedReader(new InputStreamReader(System.in, StandardCharsets.UTF_8));
+        PrintStream out = new PrintStream(new FileOutputStream(FileDescriptor.out), true, "UTF-8");
+        Base64.Decoder decoder = Base64.getDecoder();
+        Base64.Encoder encoder = Base64.getEncoder();
+
+        String line;
+        while ((line = in.readLine()) != null)
+        {
+            line = line.trim();
+            if (line.isEmpty())
+                continue;
+
+            String[] parts = line.split(" ");
+            String[] javacArgs = new String[parts.length];
+            for (int i = 0; i < parts.length; ++i)
+                javacArgs[i] = new String(decoder.decode(parts[i]), StandardCharsets.UTF_8);
+
+            // the diagnostics are written in the same format and encoding as the javac command
+            ByteArrayOutputStream diagnostics = new ByteArrayOutputStream();
+            int exitCode;
+            if (compiler == null)
+            {
+                diagnostics.write("The system Java compiler is not available, is it a JRE instead of a JDK?"
+                                      .getBytes(StandardCharsets.UTF_8));
+                exitCode = 2;
+            }
+            else
+            {
+                exitCode = compiler.run(null, null, diagnostics, javacArgs);
+            }
+
+            out.println(exitCode + " " + encoder.encodeToString(diagnostics.toByteArray()));
+        }
+    }
+}
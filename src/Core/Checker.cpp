@@ -18,7 +18,10 @@
 #include "Core/Checker.hpp"
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
+#include "Core/ExecutionThread.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/OutputHasher.hpp"
+#include "Core/PipelineTracer.hpp"
 #include "Core/Runner.hpp"
 #include "Util/FileUtil.hpp"
 #include "generated/SettingsHelper.hpp"
@@ -112,10 +115,11 @@ void Checker::prepare()
     connect(compiler, &Compiler::compilationErrorOccurred, this, &Checker::onCompilationErrorOccurred);
     connect(compiler, &Compiler::compilationFailed, this, &Checker::onCompilationFailed);
     connect(compiler, &Compiler::compilationKilled, this, &Checker::onCompilationKilled);
+    compileTraceStart = PipelineTracer::now();
     compiler->start(checkerTmpPath, "", SettingsHelper::getCppCompileCommand(), "C++");
 }
 
-void Checker::reqeustCheck(int index, const QString &input, const QString &output, const QString &expected)
+void Checker::reqeustCheck(int index, const QString &input, const OutputBuffer &output, const QString &expected)
 {
     recompileIfChanged();
     LOG_INFO(BOOL_INFO_OF(compiled));
@@ -130,8 +134,14 @@ void Checker::onCompilationStarted()
     log->info(tr("Checker"), tr("Started compiling the checker"));
 }
 
+void Checker::setTracePipeline(int pipeline)
+{
+    tracePipeline = pipeline;
+}
+
 void Checker::clearTasks()
 {
+    ++taskGeneration; // drop the results of the tasks being checked in the execution thread
     pendingTasks.clear();
     for (auto &t : runners)
     {
@@ -142,6 +152,7 @@ void Checker::clearTasks()
 
 void Checker::onCompilationFinished()
 {
+    PipelineTracer::addSpan(tracePipeline, "checker", "Compile Checker", compileTraceStart);
     if (recompileIfChanged())
         return;
     compiled = true;
@@ -153,6 +164,8 @@ void Checker::onCompilationFinished()
 
 void Checker::onCompilationErrorOccurred(const QString &error)
 {
+    PipelineTracer::addSpan(tracePipeline, "checker", "Compile Checker", compileTraceStart,
+                            QJsonObject{{"error", true}});
     log->error(tr("Checker"), tr("Error occurred while compiling the checker:\n%1").arg(error));
 }
 
@@ -169,9 +182,11 @@ void Checker::onCompilationKilled()
     disconnect(compiler, &Compiler::compilationErrorOccurred, this, &Checker::onCompilationErrorOccurred);
 }
 
-void Checker::onRunFinished(int index, const QString & /*unused*/, const QString &err, int exitCode, int /*unused*/,
-                            bool tle)
+void Checker::onRunFinished(int index, const OutputBuffer & /*unused*/, const OutputBuffer &errBuffer, int exitCode,
+                            qint64 /*unused*/, bool tle)
 {
+    const auto err = errBuffer.text();
+
     if (tle)
         log->warn(head(index), tr("Time Limit Exceeded"));
 
@@ -280,41 +295,98 @@ bool Checker::checkStrict(const QString &output, const QString &expected)
     return a.replace("\r\n", "\n").replace("\r", "\n") == b.replace("\r\n", "\n").replace("\r", "\n");
 }
 
-void Checker::check(int index, const QString &input, const QString &output, const QString &expected)
+void Checker::check(int index, const QString &input, const OutputBuffer &output, const QString &expected)
 {
     LOG_INFO(INFO_OF(index));
+
+    const int generation = taskGeneration;
+    const int pipeline = tracePipeline;
+    const auto traceStart = PipelineTracer::now();
+    const auto finish = [this, index, generation, pipeline, traceStart](bool accepted) {
+        PipelineTracer::addSpan(pipeline, "checker", "Check", traceStart, {{"testCase", index + 1}});
+        if (generation == taskGeneration) // otherwise the task is cleared
+            emit checkFinished(index, accepted ? Widgets::TestCase::AC : Widgets::TestCase::WA);
+    };
+
     switch (checkerType)
     {
-    // check directly if it's a built-in checker
+    // check built-in checkers in the execution thread, the outputs could be very long
     case IgnoreTrailingSpaces:
-        emit checkFinished(index,
-                           checkIgnoreTrailingSpaces(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
-        break;
-    case Strict:
-        emit checkFinished(index, checkStrict(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
+    case Strict: {
+        const bool strict = checkerType == Strict;
+        ExecutionThread::post(
+            this,
+            [strict, output, expected] {
+                if (output.isTruncated())
+                {
+                    // the middle part of the output is discarded, compare the hashes of the whole outputs instead
+                    OutputHasher hasher;
+                    hasher.addData(expected.toUtf8());
+                    const auto summary = output.summary();
+                    return strict ? hasher.strictHash() == summary.strictHash
+                                  : hasher.lenientHash() == summary.lenientHash;
+                }
+                return strict ? checkStrict(output.text(), expected)
+                              : checkIgnoreTrailingSpaces(output.text(), expected);
+            },
+            finish);
         break;
-    default:
+    }
+    default: {
+        if (output.isTruncated())
+        {
+            // The testlib checker can't read the discarded middle part, so the output is compared by its hash as the
+            // built-in checker which ignores trailing spaces does. An output accepted only by the testlib checker is
+            // judged as WA, and the user is told so.
+            log->warn(head(index), tr("The output is too long and its middle part is discarded, so it can't be "
+                                      "checked by the testlib checker. It's compared with the expected output "
+                                      "ignoring trailing spaces instead."));
+            ExecutionThread::post(
+                this,
+                [output, expected] {
+                    OutputHasher hasher;
+                    hasher.addData(expected.toUtf8());
+                    return hasher.lenientHash() == output.summary().lenientHash;
+                },
+                finish);
+            break;
+        }
         // if it's a testlib checker, save the input, output and expected files first
         auto inputPath = tmpDir->filePath(QString::number(index) + ".in");
         auto outputPath = tmpDir->filePath(QString::number(index) + ".out");
         auto expectedPath = tmpDir->filePath(QString::number(index) + ".ans");
-        if (Util::saveFile(inputPath, input, tr("Checker"), false, log) &&
-            Util::saveFile(outputPath, output, tr("Checker"), false, log) &&
-            Util::saveFile(expectedPath, expected, tr("Checker"), false, log))
-        {
-            // if files are successfully saved, run the checker
-            auto *tmp = new Runner(index);
-            runners.push_back(tmp); // save the checkers in a list, so we can delete them when destructing the checker
-            connect(tmp, &Runner::runFinished, this, &Checker::onRunFinished);
-            connect(tmp, &Runner::failedToStartRun, this, &Checker::onFailedToStartRun);
-            connect(tmp, &Runner::runOutputLimitExceeded, this, &Checker::onRunOutputLimitExceeded);
-            connect(tmp, &Runner::runKilled, this, &Checker::onRunKilled);
-            tmp->run(checkerTmpPath, "", "C++", "",
-                     "\"" + inputPath + "\" \"" + outputPath + "\" \"" + expectedPath + "\"", "",
-                     SettingsHelper::getDefaultTimeLimit());
-        }
+        ExecutionThread::post(
+            this,
+            [inputPath, input, outputPath, output, expectedPath, expected] {
+                return Util::saveFile(inputPath, input, "Checker", false) &&
+                       Util::saveFile(outputPath, output.bytes(), "Checker", false) &&
+                       Util::saveFile(expectedPath, expected, "Checker", false);
+            },
+            [this, index, generation, pipeline, traceStart, inputPath, outputPath, expectedPath](bool saved) {
+                PipelineTracer::addSpan(pipeline, "checker", "Write Checker Files", traceStart,
+                                        {{"testCase", index + 1}});
+                if (generation != taskGeneration)
+                    return;
+                if (!saved)
+                {
+                    log->error(head(index), tr("Failed to save the files for the checker"));
+                    return;
+                }
+                // if files are successfully saved, run the checker
+                auto *tmp = new Runner(index);
+                runners.push_back(tmp); // save the checkers in a list, so we can delete them later
+                connect(tmp, &Runner::runFinished, this, &Checker::onRunFinished);
+                connect(tmp, &Runner::failedToStartRun, this, &Checker::onFailedToStartRun);
+                connect(tmp, &Runner::runOutputLimitExceeded, this, &Checker::onRunOutputLimitExceeded);
+                connect(tmp, &Runner::runKilled, this, &Checker::onRunKilled);
+                tmp->setTracePipeline(pipeline, "checker");
+                tmp->run(checkerTmpPath, "", "C++", "",
+                         "\"" + inputPath + "\" \"" + outputPath + "\" \"" + expectedPath + "\"", "",
+                         SettingsHelper::getDefaultTimeLimit());
+            });
         break;
     }
+    }
 }
 
 QString Checker::head(int index)
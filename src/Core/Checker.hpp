@@ -28,6 +28,7 @@
 #ifndef CHECKER_HPP
 #define CHECKER_HPP
 
+#include "Core/OutputBuffer.hpp"
 #include "Widgets/TestCase.hpp"
 
 class QTemporaryDir;
@@ -99,13 +100,20 @@ class Checker : public QObject
      * @note This function doesn't return anything, it request the checker to check,
      *       and the checker emits a signal when it's done
      */
-    void reqeustCheck(int index, const QString &input, const QString &output, const QString &expected);
+    void reqeustCheck(int index, const QString &input, const OutputBuffer &output, const QString &expected);
 
     /**
      * @brief clear the pending tasks and kill executing tasks
      */
     void clearTasks();
 
+    /**
+     * @brief record the compilation and the checks in a pipeline of the PipelineTracer
+     * @param pipeline the id of the pipeline, 0 to stop tracing
+     * @note the compilation is recorded in the pipeline when it finishes, even if it started before the pipeline
+     */
+    void setTracePipeline(int pipeline);
+
   signals:
     /**
      * @brief return the check result
@@ -125,7 +133,7 @@ class Checker : public QObject
 
     void onCompilationKilled();
 
-    void onRunFinished(int index, const QString &, const QString &err, int exitCode, int, bool tle);
+    void onRunFinished(int index, const OutputBuffer &, const OutputBuffer &err, int exitCode, qint64, bool tle);
 
     void onFailedToStartRun(int index, const QString &error);
 
@@ -155,9 +163,10 @@ class Checker : public QObject
      * @param input the input of the testcase
      * @param output the output to check
      * @param expected the expected output of the testcase
-     * @note this should only be called when the checker is compiled
+     * @note This should only be called when the checker is compiled.
+     *       The comparison and the I/O files are done in the execution thread.
      */
-    void check(int index, const QString &input, const QString &output, const QString &expected);
+    void check(int index, const QString &input, const OutputBuffer &output, const QString &expected);
 
     /**
      * @param index the index of the testcase
@@ -174,7 +183,9 @@ class Checker : public QObject
     struct Task
     {
         int index;
-        QString input, output, expected;
+        QString input;
+        OutputBuffer output;
+        QString expected;
     };
 
     // copied from testlib.h, see #746 for why not include testlib.h
@@ -202,6 +213,9 @@ class Checker : public QObject
     QVector<Task> pendingTasks;      // the unsolved check requests
     std::atomic<bool> compiled;      // whether the testlib checker is compiled or not
                                      // It should be true for built-in checkers.
+    int taskGeneration = 0;          // increased when the tasks are cleared, to drop outdated results
+    int tracePipeline = 0;           // the pipeline to record the compilation and the checks in, see PipelineTracer
+    qint64 compileTraceStart = 0;    // when the compilation of the checker started, see PipelineTracer::now
 };
 
 } // namespace Core
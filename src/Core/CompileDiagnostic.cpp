@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/CompileDiagnostic.hpp"
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextCodec>
+
+namespace Core
+{
+
+bool CompileDiagnostic::parse(const QString &text, CompileDiagnostic *diagnostic)
+{
+    // sol.cpp:7:12: error: expected ';' before 'return'
+    // Sol.java:5: error: cannot find symbol
+    static const QRegularExpression regex(
+        R"(^(.+?):(\d+):(?:(\d+):)?\s*(fatal error|error|warning|note):\s*(.*)$)");
+    static const QRegularExpression colorRegex("\x1b\\[[0-9;]*[mK]");
+
+    QString line = text;
+    line.remove(colorRegex);
+    if (line.endsWith('\r'))
+        line.chop(1);
+
+    const auto match = regex.match(line);
+    if (!match.hasMatch())
+        return false;
+
+    diagnostic->file = match.captured(1);
+    diagnostic->line = match.captured(2).toInt();
+    diagnostic->column = match.captured(3).toInt(); // 0 if it's not captured
+    const auto severity = match.captured(4);
+    if (severity == "warning")
+        diagnostic->severity = Warning;
+    else if (severity == "note")
+        diagnostic->severity = Note;
+    else
+        diagnostic->severity = Error;
+    diagnostic->message = match.captured(5).trimmed();
+    return true;
+}
+
+void CompileDiagnosticParser::setCodec(QTextCodec *codec)
+{
+    this->codec = codec;
+}
+
+QVector<CompileDiagnostic> CompileDiagnosticParser::feed(const QByteArray &bytes)
+{
+    pending += bytes;
+    const int end = pending.lastIndexOf('\n');
+    if (end == -1)
+        return {};
+    const auto lines = pending.left(end);
+    pending.remove(0, end + 1);
+    return parseLines(lines);
+}
+
+QVector<CompileDiagnostic> CompileDiagnosticParser::flush()
+{
+    const auto lines = pending;
+    pending.clear();
+    return parseLines(lines);
+}
+
+QVector<CompileDiagnostic> CompileDiagnosticParser::parseLines(const QByteArray &lines)
+{
+    QVector<CompileDiagnostic> diagnostics;
+    // the lines are complete, so they can be decoded separately without breaking a multi-byte character
+    const auto text = codec == nullptr ? QString::fromUtf8(lines) : codec->toUnicode(lines);
+    for (const auto &line : text.split('\n'))
+    {
+        CompileDiagnostic diagnostic;
+        if (CompileDiagnostic::parse(line, &diagnostic))
+            diagnostics.push_back(diagnostic);
+    }
+    return diagnostics;
+}
+
+} // namespace Core
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * A CompileDiagnostic is an error, warning or note reported by the compiler, parsed from the
+ * "file:line:column: severity: message" lines printed by GCC, Clang and javac.
+ * The CompileDiagnosticParser parses the stderr of the compiler incrementally, so the diagnostics can be
+ * shown while the compiler is still running. Lines in unknown formats are ignored.
+ */
+
+#ifndef COMPILEDIAGNOSTIC_HPP
+#define COMPILEDIAGNOSTIC_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QTextCodec;
+
+namespace Core
+{
+
+struct CompileDiagnostic
+{
+    enum Severity
+    {
+        Error,
+        Warning,
+        Note
+    };
+
+    QString file;              // the file in the diagnostic, as printed by the compiler
+    int line = 0;              // the line number, 1-based
+    int column = 0;            // the column number, 1-based, 0 if it's unknown
+    Severity severity = Error; // "fatal error" is treated as Error
+    QString message;           // the message without the location and the severity
+
+    /**
+     * @brief parse a line of the compiler output
+     * @param text the line, ANSI color codes are removed before parsing
+     * @param diagnostic the parsed diagnostic, only set if the line is a diagnostic
+     * @returns whether the line is a diagnostic
+     */
+    static bool parse(const QString &text, CompileDiagnostic *diagnostic);
+};
+
+class CompileDiagnosticParser
+{
+  public:
+    /**
+     * @brief set the codec of the compiler output, the default codec is UTF-8
+     */
+    void setCodec(QTextCodec *codec);
+
+    /**
+     * @brief parse the newly arrived output
+     * @param bytes the output, it may end with an incomplete line, which is parsed when the rest of it arrives
+     * @returns the diagnostics in the complete lines
+     */
+    QVector<CompileDiagnostic> feed(const QByteArray &bytes);
+
+    /**
+     * @brief parse the last incomplete line, call this when the output ends
+     */
+    QVector<CompileDiagnostic> flush();
+
+  private:
+    QVector<CompileDiagnostic> parseLines(const QByteArray &lines);
+
+    QTextCodec *codec = nullptr; // nullptr represents for UTF-8
+    QByteArray pending;          // the incomplete line at the end of the output
+};
+
+} // namespace Core
+
+#endif // COMPILEDIAGNOSTIC_HPP
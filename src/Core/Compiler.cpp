@@ -17,31 +17,84 @@
 
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
+#include "Core/JavaCompileDaemon.hpp"
 #include "Settings/SettingsManager.hpp"
 #include "Util/FileUtil.hpp"
 #include "generated/SettingsHelper.hpp"
+#include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
 #include <QTextCodec>
+#include <QTimer>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
 
 namespace Core
 {
 
+namespace
+{
+// the results of probeColumnUnit, the speculative compilations may read them in another thread
+QMutex columnUnitMutex;
+QHash<QString, bool> displayColumnCompilers; // whether each probed program reports display columns
+QSet<QString> probingCompilers;              // the programs being probed
+
+/**
+ * @brief split the arguments of a GCC-like compiler into the ones for both stages and the ones only for linking
+ * @param args the arguments of the compile command, without the program
+ * @param optionArgs set to the arguments used by both the compile stage and the link stage
+ * @param linkOnlyArgs set to the libraries and the linker options, in their original order
+ */
+void splitLinkArguments(const QStringList &args, QStringList *optionArgs, QStringList *linkOnlyArgs)
+{
+    // the options whose value may be the next argument, e.g. "-l m"
+    static const QStringList linkOptionsWithValue = {"-l", "-L", "-Xlinker"};
+    static const QStringList linkOptions = {"-s", "-rdynamic", "-shared", "-pie", "-no-pie"};
+    static const QStringList linkPrefixes = {"-l", "-L", "-Wl,", "-static", "-fuse-ld="};
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto &arg = args[i];
+        if (linkOptionsWithValue.contains(arg))
+        {
+            *linkOnlyArgs << arg;
+            if (i + 1 < args.size())
+                *linkOnlyArgs << args[++i];
+        }
+        else if (linkOptions.contains(arg) ||
+                 std::any_of(linkPrefixes.cbegin(), linkPrefixes.cend(),
+                             [&arg](const QString &prefix) { return arg.startsWith(prefix); }))
+            *linkOnlyArgs << arg;
+        else
+            *optionArgs << arg;
+    }
+}
+} // namespace
+
 Compiler::Compiler()
 {
     // create compiliation process and connect signals
     compileProcess = new QProcess();
-    connect(compileProcess, &QProcess::started, this, &Compiler::compilationStarted);
+    connect(compileProcess, &QProcess::started, this, &Compiler::onStarted);
     connect(compileProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
             &Compiler::onProcessFinished);
     connect(compileProcess, &QProcess::errorOccurred, this, &Compiler::onProcessErrorOccurred);
+    connect(compileProcess, &QProcess::readyReadStandardError, this, &Compiler::onReadyReadStandardError);
 }
 
 Compiler::~Compiler()
 {
     if (compileProcess != nullptr)
     {
-        if (compileProcess->state() != QProcess::NotRunning)
+        if (compileProcess->state() != QProcess::NotRunning || waitingForDaemon)
         {
             // kill the compilation process if it's still running when the Compiler is being destructed
             LOG_WARN("Compiler process was running and is being forcefully killed");
@@ -81,15 +134,58 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
 
     QString program = args.takeFirst();
 
+    QString output = customOutputPath;
+    if (output.isEmpty())
+        output = outputPath(tmpFilePath, sourceFilePath, lang);
+
+    const auto source = QFileInfo(tmpFilePath).canonicalFilePath();
+
     if (lang == "C++")
     {
-        args << QFileInfo(tmpFilePath).canonicalFilePath() << "-o" << outputPath(tmpFilePath, sourceFilePath, "C++");
+        QStringList includes;
         if (QFile::exists(sourceFilePath))
-            args << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+            includes << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+
+        const auto launcher = findTool(SettingsHelper::getCppCompilerLauncher(), {"ccache", "sccache"});
+        const auto linker = findTool(SettingsHelper::getCppFastLinker(), {"mold", "lld"});
+        QStringList linkerArgs;
+        if (!linker.isEmpty())
+            linkerArgs << "-fuse-ld=" + linker;
+
+        // The squiggles are placed by character, which matches the byte columns for a tab. A program used for the
+        // first time is probed now, and its diagnostics are placed by the default columns until the result is known.
+        probeColumnUnit(program);
+        if (reportsDisplayColumns(program))
+            args << "-fdiagnostics-column-unit=byte";
+
+        reportTime = SettingsHelper::isCppReportCompileTime();
+
+        if (!launcher.isEmpty() || reportTime)
+        {
+            // Compile and link in separate stages, because compiler caches don't cache a compilation which also
+            // links, and so that the time of each stage can be measured.
+            // The libraries and the linker options are only passed to the link stage, otherwise the compiler warns
+            // that the linker input is unused. They follow the object file, so the libraries resolve its symbols.
+            QStringList optionArgs, linkOnlyArgs;
+            splitLinkArguments(args, &optionArgs, &linkOnlyArgs);
+            intermediateFile = output + ".o";
+            const auto compileArgs = optionArgs + QStringList{"-c", source, "-o", intermediateFile} + includes;
+            if (launcher.isEmpty())
+                stages.push_back({tr("compile"), program, compileArgs});
+            else
+                stages.push_back({tr("compile"), launcher, QStringList{program} + compileArgs});
+            stages.push_back({tr("link"), program,
+                              optionArgs + QStringList{intermediateFile, "-o", output} + linkOnlyArgs + linkerArgs});
+        }
+        else
+        {
+            stages.push_back(
+                {tr("compile"), program, args + QStringList{source, "-o", output} + includes + linkerArgs});
+        }
     }
     else if (lang == "Java")
     {
-        args << QFileInfo(tmpFilePath).canonicalFilePath() << "-d" << outputPath(tmpFilePath, sourceFilePath, "Java");
+        stages.push_back({tr("compile"), program, args + QStringList{source, "-d", output}});
     }
     else
     {
@@ -97,14 +193,173 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
         return;
     }
 
-    LOG_INFO(INFO_OF(lang) << INFO_OF(program) << INFO_OF(args.join(" ")));
+    diagnosticParser.setCodec(outputCodec());
 
     compileProcess->setWorkingDirectory(
         QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
 
+#ifdef Q_OS_WIN
+    if (lowPriority)
+    {
+        compileProcess->setCreateProcessArgumentsModifier(
+            [](QProcess::CreateProcessArguments *args) { args->flags |= BELOW_NORMAL_PRIORITY_CLASS; });
+    }
+#endif
+
+    if (lang == "Java" && SettingsHelper::isJavaCompileDaemon())
+    {
+        startWithDaemon();
+        return;
+    }
+
+    startStage(0);
+}
+
+void Compiler::startWithDaemon()
+{
+    onStarted();
+    waitingForDaemon = true;
+    currentStage = 0;
+    stageTimer.start();
+    JavaCompileDaemon::instance()->compile(
+        stages[0].program, stages[0].args, this, [this](bool ok, int exitCode, const QByteArray &output) {
+            waitingForDaemon = false;
+            if (!ok)
+            {
+                LOG_WARN("The Java compile daemon is unavailable, falling back to " << stages[0].program);
+                startStage(0);
+                return;
+            }
+            stageTimes.push_back({stages[0].name, stageTimer.elapsed()});
+            appendErrorOutput(output);
+            finish(exitCode);
+        });
+}
+
+void Compiler::onStarted()
+{
+    if (!started) // there may be several stages
+    {
+        started = true;
+        emit compilationStarted();
+    }
+}
+
+void Compiler::startStage(int index)
+{
+    currentStage = index;
+
+    auto program = stages[index].program;
+    auto args = stages[index].args;
+
+    LOG_INFO(INFO_OF(lang) << INFO_OF(stages[index].name) << INFO_OF(program) << INFO_OF(args.join(" ")));
+
+#ifdef Q_OS_UNIX
+    if (lowPriority)
+    {
+        // QProcess in Qt 5 can't change the priority of the child process, so run the compiler through nice
+        const auto nice = QStandardPaths::findExecutable("nice");
+        if (!nice.isEmpty())
+        {
+            args = QStringList{"-n", "19", program} + args;
+            program = nice;
+        }
+    }
+#endif
+
+    stageTimer.start();
     compileProcess->start(program, args);
 }
 
+QString Compiler::findTool(const QString &setting, const QStringList &candidates)
+{
+    // the settings are "None", "Auto", or one of the candidates
+    if (setting == "None" || setting.isEmpty())
+        return QString();
+
+    for (const auto &candidate : setting == "Auto" ? candidates : QStringList{setting})
+    {
+        // lld is found by the compiler as ld.lld
+        if (!QStandardPaths::findExecutable(candidate == "lld" ? "ld.lld" : candidate).isEmpty())
+            return candidate;
+    }
+
+    LOG_INFO("No tool found for " << INFO_OF(setting) << INFO_OF(candidates.join(",")));
+    return QString();
+}
+
+void Compiler::probeColumnUnit(const QString &program)
+{
+    {
+        QMutexLocker locker(&columnUnitMutex);
+        if (displayColumnCompilers.contains(program) || probingCompilers.contains(program))
+            return;
+        probingCompilers.insert(program);
+    }
+
+    auto store = [program](bool result) {
+        LOG_INFO(INFO_OF(program) << BOOL_INFO_OF(result));
+        QMutexLocker locker(&columnUnitMutex);
+        probingCompilers.remove(program);
+        displayColumnCompilers[program] = result;
+    };
+
+    // the process is started in the GUI thread, and never waited for
+    QMetaObject::invokeMethod(qApp, [program, store] {
+        auto *process = new QProcess(qApp);
+        connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), process,
+                [process, store](int exitCode, QProcess::ExitStatus exitStatus) {
+                    // e.g. "g++ (Ubuntu 11.4.0-1ubuntu1~22.04) 11.4.0" or "clang version 14.0.0", only GCC 11+
+                    // reports display columns
+                    const auto firstLine =
+                        QString::fromLocal8Bit(process->readAllStandardOutput()).section('\n', 0, 0);
+                    auto versions = QRegularExpression(R"((\d+)\.\d+\.\d+)").globalMatch(firstLine);
+                    int major = 0;
+                    while (versions.hasNext())
+                        major = versions.next().captured(1).toInt(); // the last version in the line is of GCC
+                    store(exitStatus == QProcess::NormalExit && exitCode == 0 &&
+                          !firstLine.contains("clang", Qt::CaseInsensitive) && major >= 11);
+                    process->deleteLater();
+                });
+        connect(process, &QProcess::errorOccurred, process, [process, store](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) // finished is not emitted
+            {
+                store(false);
+                process->deleteLater();
+            }
+        });
+        QTimer::singleShot(5000, process, [process] { process->kill(); }); // then it's finished with a crash
+        process->start(program, {"--version"});
+    });
+}
+
+bool Compiler::reportsDisplayColumns(const QString &program)
+{
+    QMutexLocker locker(&columnUnitMutex);
+    return displayColumnCompilers.value(program, false);
+}
+
+QString Compiler::timeReport() const
+{
+    if (!reportTime)
+        return QString();
+
+    QStringList parts;
+    for (const auto &stage : stageTimes)
+        parts.push_back(tr("%1: %2ms").arg(stage.first).arg(stage.second));
+    return parts.join(", ");
+}
+
+void Compiler::setOutputPath(const QString &path)
+{
+    customOutputPath = path;
+}
+
+void Compiler::setLowPriority(bool lowPriority)
+{
+    this->lowPriority = lowPriority;
+}
+
 QString Compiler::outputPath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                              bool createDirectory)
 {
@@ -133,6 +388,32 @@ QString Compiler::outputPath(const QString &tmpFilePath, const QString &sourceFi
     return res;
 }
 
+QString Compiler::profileOutputPath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                    const QString &profile, bool createDirectory)
+{
+    if (profile.isEmpty() || lang == "Python")
+        return outputPath(tmpFilePath, sourceFilePath, lang, createDirectory);
+
+    QString res = outputPath(tmpFilePath, sourceFilePath, lang, false);
+    const auto name = QString(profile).replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+
+    if (lang == "C++")
+    {
+        res.chop(Util::exeSuffix.length());
+        res += "-" + name + Util::exeSuffix;
+        if (createDirectory)
+            QDir().mkpath(QFileInfo(res).absolutePath());
+    }
+    else if (lang == "Java")
+    {
+        res = QDir(res).filePath(name);
+        if (createDirectory)
+            QDir().mkpath(res);
+    }
+
+    return res;
+}
+
 QString Compiler::outputFilePath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                                  bool createDirectory)
 {
@@ -145,6 +426,48 @@ QString Compiler::outputFilePath(const QString &tmpFilePath, const QString &sour
 }
 
 void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus e)
+{
+    stageTimes.push_back({stages[currentStage].name, stageTimer.elapsed()});
+    appendErrorOutput(compileProcess->readAllStandardError());
+
+    if (exitCode == 0 && currentStage + 1 < stages.size())
+    {
+        startStage(currentStage + 1);
+        return;
+    }
+
+    finish(exitCode);
+}
+
+void Compiler::finish(int exitCode)
+{
+    if (!intermediateFile.isEmpty())
+        QFile::remove(intermediateFile);
+
+    for (const auto &diagnostic : diagnosticParser.flush())
+        emit diagnosticArrived(diagnostic);
+
+    QString output = outputCodec()->toUnicode(errorOutput);
+    // emit different signals due to different exit codes
+    if (exitCode == 0)
+        emit compilationFinished(output);
+    else
+        emit compilationErrorOccurred(output);
+}
+
+void Compiler::onReadyReadStandardError()
+{
+    appendErrorOutput(compileProcess->readAllStandardError());
+}
+
+void Compiler::appendErrorOutput(const QByteArray &bytes)
+{
+    errorOutput += bytes;
+    for (const auto &diagnostic : diagnosticParser.feed(bytes))
+        emit diagnosticArrived(diagnostic);
+}
+
+QTextCodec *Compiler::outputCodec() const
 {
     QString codecName = "UTF-8";
     if (lang == "C++")
@@ -154,12 +477,7 @@ void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus e)
     QTextCodec *codec = QTextCodec::codecForName(codecName.toUtf8());
     if (!codec)
         codec = QTextCodec::codecForName("UTF-8");
-    QString output = codec->toUnicode(compileProcess->readAllStandardError());
-    // emit different signals due to different exit codes
-    if (exitCode == 0)
-        emit compilationFinished(output);
-    else
-        emit compilationErrorOccurred(output);
+    return codec;
 }
 
 void Compiler::onProcessErrorOccurred(QProcess::ProcessError error)
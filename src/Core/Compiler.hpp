@@ -22,13 +22,18 @@
  * The compilation process will be automatically killed when the Compiler is destructed,
  * so it's convenient to use one Compiler for one compilation.
  * When using it to "compile" Python, it will emit compilationFinished("") immediately.
+ * C++ may be compiled and linked in two stages, one process for each, e.g. when a compiler cache is used.
+ * The diagnostics in the compiler output are emitted one by one as soon as they are printed.
  */
 
 #ifndef COMPILER_HPP
 #define COMPILER_HPP
 
+#include "Core/CompileDiagnostic.hpp"
+#include <QElapsedTimer>
 #include <QObject>
 #include <QProcess>
+#include <QVector>
 
 namespace Core
 {
@@ -60,6 +65,25 @@ class Compiler : public QObject
     void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
                const QString &lang);
 
+    /**
+     * @brief compile into the given path instead of Compiler::outputPath
+     * @param path the executable file path for C++, or the class path for Java
+     * @note this should be called before start()
+     */
+    void setOutputPath(const QString &path);
+
+    /**
+     * @brief run the compilation process at a low priority, so it doesn't slow down the other processes
+     * @note this should be called before start()
+     */
+    void setLowPriority(bool lowPriority);
+
+    /**
+     * @brief the time used by each stage of the compilation, e.g. "compile: 1500ms, link: 300ms"
+     * @returns the report, or an empty string if the time isn't reported, see the C++/Report Compile Time setting
+     */
+    QString timeReport() const;
+
     /**
      * @brief get the output path (executable file path for C++, class path for Java, tmp file path for Python)
      * This should be used as an argument in the compilation command
@@ -71,6 +95,17 @@ class Compiler : public QObject
     static QString outputPath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                               bool createDirectory = true);
 
+    /**
+     * @brief get the output path of a compile profile, so the builds of different profiles are kept apart
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param lang the language being compiled
+     * @param profile the name of the compile profile, the same as Compiler::outputPath if it's empty
+     * @param create the directory if it doesn't exist
+     */
+    static QString profileOutputPath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                     const QString &profile, bool createDirectory = true);
+
     /**
      * @brief Similar to Compiler::outputPath, but returns the path of the output file.
      * This should be used to find the executable file for C++ and class file for Java.
@@ -78,12 +113,25 @@ class Compiler : public QObject
     static QString outputFilePath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                                   bool createDirectory = true);
 
+    /**
+     * @brief check the version of a C++ compiler in the background, to know whether it reports display columns
+     * @param program the compiler program, it's checked only once
+     * @note this is thread-safe, the version is checked in the GUI thread without waiting for it
+     */
+    static void probeColumnUnit(const QString &program);
+
   signals:
     /**
      * @brief the compilation has just started
      */
     void compilationStarted();
 
+    /**
+     * @brief a diagnostic is printed by the compiler
+     * @param diagnostic the diagnostic, it's emitted before the compilation finishes if the compiler is still running
+     */
+    void diagnosticArrived(const Core::CompileDiagnostic &diagnostic);
+
     /**
      * @brief the compilation has just finished
      * @param warning the compile warnings (stderr of the compile process)
@@ -117,9 +165,83 @@ class Compiler : public QObject
 
     void onProcessErrorOccurred(QProcess::ProcessError error);
 
+    /**
+     * @brief parse the newly printed stderr of the compilation process
+     */
+    void onReadyReadStandardError();
+
+    /**
+     * @brief emit compilationStarted when the first stage starts
+     */
+    void onStarted();
+
   private:
+    // a stage of the compilation, which is one run of the compilation process
+    struct Stage
+    {
+        QString name; // the translated name of the stage, used in the time report
+        QString program;
+        QStringList args;
+    };
+
+    /**
+     * @brief start a stage of the compilation
+     * @param index the index of the stage in stages
+     */
+    void startStage(int index);
+
+    /**
+     * @brief compile Java with the JavaCompileDaemon, fall back to the compilation process if it fails
+     */
+    void startWithDaemon();
+
+    /**
+     * @brief emit the result of the compilation
+     * @param exitCode the exit code of the last stage
+     */
+    void finish(int exitCode);
+
+    /**
+     * @brief collect the compiler output and emit the diagnostics in it
+     * @param bytes the newly printed output
+     */
+    void appendErrorOutput(const QByteArray &bytes);
+
+    /**
+     * @brief the codec of the compiler output, see the Compiler Output Codec settings
+     */
+    QTextCodec *outputCodec() const;
+
+    /**
+     * @brief find an optional tool on PATH
+     * @param setting the setting of the tool, "None", "Auto" or the name of a tool
+     * @param candidates the tools to try in order when the setting is "Auto"
+     * @returns the name of the found tool, or an empty string if it's not used or not found
+     */
+    static QString findTool(const QString &setting, const QStringList &candidates);
+
+    /**
+     * @brief whether a C++ compiler is known to report the columns of the diagnostics in display columns, i.e. GCC 11
+     *        or later, such compilers are asked to report byte columns instead, so a tab counts as one column
+     * @param program the compiler program
+     * @returns the result of probeColumnUnit, false if the program is not probed yet
+     */
+    static bool reportsDisplayColumns(const QString &program);
+
     QProcess *compileProcess = nullptr; // the compilation process
     QString lang;
+    QString customOutputPath; // the output path set by setOutputPath, empty represents for Compiler::outputPath
+    bool lowPriority = false;
+    QVector<Stage> stages;
+    int currentStage = -1;                      // the index of the running stage
+    QElapsedTimer stageTimer;                   // measures the wall time of the running stage
+    QVector<QPair<QString, qint64>> stageTimes; // the names and the time used of the finished stages
+    QByteArray errorOutput;                     // the stderr of all stages
+    CompileDiagnosticParser diagnosticParser;   // parses errorOutput as it arrives
+    QString intermediateFile;                   // the object file between two stages, removed when finished
+    bool reportTime = false;                    // whether the time of the stages is reported
+    bool started = false;                       // whether compilationStarted is emitted
+    bool waitingForDaemon = false;              // whether it's waiting for the JavaCompileDaemon
 };
 
 } // namespace Core
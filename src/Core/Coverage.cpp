@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/Coverage.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <generated/SettingsHelper.hpp>
+
+namespace Core
+{
+
+// the slowdown of an instrumented program, the time limit is scaled by it
+static const int COVERAGE_TIME_LIMIT_FACTOR = 3;
+
+Coverage::Coverage(int index) : coverageIndex(index)
+{
+}
+
+Coverage::~Coverage()
+{
+    delete runner;
+    if (gcovProcess != nullptr)
+    {
+        gcovProcess->kill();
+        delete gcovProcess;
+    }
+}
+
+QString Coverage::compileFlags()
+{
+    return "--coverage";
+}
+
+void Coverage::setFileIO(const QString &inputFileName, const QString &outputFileName)
+{
+    fileIO = true;
+    inputFile = inputFileName;
+    outputFile = outputFileName;
+}
+
+void Coverage::run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &build,
+                   const QString &args, const QString &input, int timeLimit)
+{
+    LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(build) << INFO_OF(timeLimit));
+
+    if (!dir.isValid())
+    {
+        emit coverageFailed(coverageIndex, tr("Failed to create a temporary directory for gcov"));
+        return;
+    }
+
+    const QFileInfo executable(Compiler::profileOutputPath(tmpFilePath, sourceFilePath, "C++", build, false));
+    fileName = QFileInfo(tmpFilePath).fileName();
+    executableName = executable.fileName();
+    searchPaths = QStringList{executable.path(),
+                              QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath()};
+    searchPaths.removeDuplicates();
+
+    // the counters are added to the existing data files, so the counts of the previous runs are removed
+    for (const auto &file : dataFiles())
+        QFile::remove(file);
+
+    runner = new Runner(coverageIndex);
+    connect(runner, &Runner::runStarted, this, &Coverage::coverageStarted);
+    connect(runner, &Runner::runFinished, this, &Coverage::onRunFinished);
+    connect(runner, &Runner::failedToStartRun, this, &Coverage::coverageFailed);
+    if (fileIO)
+        runner->setFileIO(inputFile, outputFile);
+    runner->setProfile(build);
+    runner->run(tmpFilePath, sourceFilePath, "C++", QString(), args, input, timeLimit * COVERAGE_TIME_LIMIT_FACTOR);
+}
+
+void Coverage::onRunFinished(int index, const OutputBuffer &out, const OutputBuffer &err, int exitCode,
+                             qint64 timeUsed, bool tle)
+{
+    Q_UNUSED(index)
+    Q_UNUSED(out)
+    Q_UNUSED(err)
+
+    if (tle)
+    {
+        // the counters are written when the program exits, they are lost when it's killed
+        emit coverageFailed(coverageIndex, tr("The instrumented run didn't finish in %1ms").arg(timeUsed));
+        return;
+    }
+
+    if (exitCode != 0)
+        LOG_WARN("The instrumented program exited with code " << exitCode);
+
+    // there may be data files of older builds in the working directory of the compilation, take the newest one
+    QString dataFile;
+    for (const auto &file : dataFiles())
+    {
+        if (dataFile.isEmpty() || QFileInfo(file).lastModified() > QFileInfo(dataFile).lastModified())
+            dataFile = file;
+    }
+
+    if (dataFile.isEmpty())
+    {
+        emit coverageFailed(coverageIndex,
+                            tr("The program didn't write the coverage data. Has it exited normally (exit code %1)?")
+                                .arg(exitCode));
+        return;
+    }
+
+    auto args = QProcess::splitCommand(SettingsHelper::getCppGcovCommand());
+    if (args.isEmpty())
+    {
+        emit coverageFailed(coverageIndex,
+                            tr("The gcov command is empty, you can set it at %1.")
+                                .arg(SettingsHelper::pathOfCppGcovCommand()));
+        return;
+    }
+    const auto program = args.takeFirst();
+
+    gcovProcess = new QProcess(this);
+    gcovProcess->setWorkingDirectory(dir.path());
+    gcovProcess->setProgram(program);
+    gcovProcess->setArguments(args + QStringList{dataFile});
+    connect(gcovProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus) {
+                if (exitStatus != QProcess::NormalExit || exitCode != 0)
+                {
+                    const auto error = QString::fromUtf8(gcovProcess->readAllStandardError());
+                    emit coverageFailed(coverageIndex, tr("gcov exited with code %1:\n%2").arg(exitCode).arg(error));
+                    return;
+                }
+                readGcovFile();
+            });
+    connect(gcovProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            emit coverageFailed(coverageIndex, tr("Failed to start gcov, you can set the gcov command at %1.")
+                                                   .arg(SettingsHelper::pathOfCppGcovCommand()));
+    });
+    gcovProcess->start();
+}
+
+QStringList Coverage::dataFiles() const
+{
+    // e.g. sol.gcda, sol-coverage-run-sol.gcda when it's named after the executable file, or sol-coverage-run.gcda
+    // when it's named after the object file compiled separately
+    const QRegularExpression name("^((.+-)?" + QRegularExpression::escape(QFileInfo(fileName).completeBaseName()) +
+                                  "|" + QRegularExpression::escape(executableName) + R"()\.gcda$)");
+    QStringList res;
+    for (const auto &path : searchPaths)
+    {
+        for (const auto &info : QDir(path).entryInfoList({"*.gcda"}, QDir::Files))
+        {
+            if (name.match(info.fileName()).hasMatch())
+                res.push_back(info.absoluteFilePath());
+        }
+    }
+    return res;
+}
+
+void Coverage::readGcovFile()
+{
+    // gcov writes a .gcov file for each source file, including the headers, find the one of the source file
+    static const QRegularExpression source(R"(^\s*-:\s*0:Source:(.*)$)", QRegularExpression::MultilineOption);
+
+    for (const auto &info : QDir(dir.path()).entryInfoList({"*.gcov"}, QDir::Files))
+    {
+        QFile file(info.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            continue;
+        const auto text = QString::fromUtf8(file.readAll());
+        const auto match = source.match(text);
+        if (match.hasMatch() && QFileInfo(match.captured(1).trimmed()).fileName() == fileName)
+        {
+            emit coverageFinished(coverageIndex, parseGcov(text));
+            return;
+        }
+    }
+
+    emit coverageFailed(coverageIndex, tr("gcov didn't report the execution counts of %1").arg(fileName));
+}
+
+QMap<int, qint64> Coverage::parseGcov(const QString &text)
+{
+    // Each line is "count:line number:source", where the count is "-" for lines without code, and "#####" or
+    // "=====" for lines never executed. A "*" is appended to the count if some blocks in the line are never executed.
+    // The lines of template instantiations are listed again after the whole file, only the first count is used.
+    QMap<int, qint64> res;
+    for (const auto &line : text.split('\n'))
+    {
+        const int first = line.indexOf(':');
+        if (first == -1)
+            continue;
+        const int second = line.indexOf(':', first + 1);
+        if (second == -1)
+            continue;
+
+        bool ok = false;
+        const int lineNumber = line.mid(first + 1, second - first - 1).trimmed().toInt(&ok);
+        if (!ok || lineNumber <= 0 || res.contains(lineNumber))
+            continue;
+
+        auto count = line.left(first).trimmed();
+        if (count == "-")
+            continue;
+        if (count.startsWith("#####") || count.startsWith("====="))
+        {
+            res[lineNumber] = 0;
+            continue;
+        }
+        if (count.endsWith('*'))
+            count.chop(1);
+        const auto value = count.toLongLong(&ok);
+        if (ok)
+            res[lineNumber] = value;
+    }
+    return res;
+}
+
+} // namespace Core
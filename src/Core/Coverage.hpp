@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Coverage runs a C++ program built with --coverage on a test case, and reports how many times each line
+ * in the source file is executed, by the data files written by the program and the gcov tool.
+ * The program should be compiled with compileFlags() added. You have to create a new Coverage for each run.
+ * The results are returned by signals.
+ */
+
+#ifndef COVERAGE_HPP
+#define COVERAGE_HPP
+
+#include "Core/OutputBuffer.hpp"
+#include <QMap>
+#include <QTemporaryDir>
+
+class QProcess;
+
+namespace Core
+{
+
+class Runner;
+
+class Coverage : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief construct a coverage run
+     * @param index the index of the testcase
+     */
+    explicit Coverage(int index);
+
+    /**
+     * @brief destruct the coverage run
+     * @note the program and gcov will be killed if they're still running
+     */
+    ~Coverage() override;
+
+    /**
+     * @brief the flags added to the compile command to instrument the program
+     */
+    static QString compileFlags();
+
+    /**
+     * @brief let the program read the input from a file and write the output to a file
+     * @note This should be called before run().
+     */
+    void setFileIO(const QString &inputFileName, const QString &outputFileName);
+
+    /**
+     * @brief run an instrumented C++ program on a given input
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param build the compile profile of the instrumented build, see Compiler::profileOutputPath
+     * @param args the command line arguments added at the back to start the program
+     * @param input the input to the program
+     * @param timeLimit the time limit of a normal run, in milliseconds, it's scaled by the overhead of the counters
+     * @note This should be called only once.
+     */
+    void run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &build, const QString &args,
+             const QString &input, int timeLimit);
+
+    /**
+     * @brief get the execution counts from a .gcov file written by gcov
+     * @param text the content of the .gcov file
+     * @returns the execution counts of the executable lines, by the line numbers in 1-based indexing
+     */
+    static QMap<int, qint64> parseGcov(const QString &text);
+
+  signals:
+    /**
+     * @brief the instrumented program has started
+     * @param index the index of the testcase
+     */
+    void coverageStarted(int index);
+
+    /**
+     * @brief the program has finished and the execution counts are read
+     * @param index the index of the testcase
+     * @param lineCounts the execution counts of the executable lines, by the line numbers in 1-based indexing
+     */
+    void coverageFinished(int index, const QMap<int, qint64> &lineCounts);
+
+    /**
+     * @brief failed to get the execution counts
+     * @param index the index of the testcase
+     * @param error a string to describe the error
+     */
+    void coverageFailed(int index, const QString &error);
+
+  private slots:
+    void onRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                       qint64 timeUsed, bool tle);
+
+  private:
+    /**
+     * @brief the data files written by the instrumented build of the source file
+     * @note GCC 11+ writes them next to the executable file, older compilers write them in the working directory
+     *       of the compilation, which is the directory of the source file.
+     */
+    QStringList dataFiles() const;
+
+    /**
+     * @brief read the .gcov file of the source file written by gcov, and emit the results
+     */
+    void readGcovFile();
+
+    const int coverageIndex;         // the index of the testcase
+    QString fileName;                // the name of the source file
+    QString executableName;          // the name of the instrumented executable file
+    QStringList searchPaths;         // the directories where the data files may be written
+    QTemporaryDir dir;               // the working directory of gcov, where it writes the .gcov files
+    bool fileIO = false;             // whether the program reads from and writes to files
+    QString inputFile, outputFile;   // the names of the files in the file I/O mode
+    Runner *runner = nullptr;        // runs the instrumented program
+    QProcess *gcovProcess = nullptr; // converts the data files to .gcov files
+};
+
+} // namespace Core
+
+#endif // COVERAGE_HPP
@@ -23,11 +23,18 @@
 #include <QDesktopServices>
 #include <QDir>
 #include <QFile>
+#include <QHash>
 #include <QLibraryInfo>
 #include <QProcess>
 #include <QStandardPaths>
 #include <QSysInfo>
 #include <QUrl>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 
 namespace Core
 {
@@ -35,6 +42,242 @@ namespace Core
 QFile Log::logFile;
 QTextStream Log::logStream;
 
+namespace
+{
+// a line queued for the writer thread, its header is not formatted yet
+struct Entry
+{
+    qint64 time = 0;
+    const char *priority = nullptr;
+    const char *funcName = nullptr;
+    const char *fileName = nullptr;
+    int line = 0;
+    QString message;
+};
+
+// set when the writer is destructed at exit, the lines logged after that are discarded
+std::atomic<bool> writerDestructed{false};
+} // namespace
+
+/*
+ * The writer owns a bounded multi-producer single-consumer ring buffer, based on Dmitry Vyukov's bounded queue.
+ * Pushing a line claims a cell with a CAS on the enqueue position, and never blocks or allocates. If the buffer is
+ * full, the line is dropped and counted, instead of blocking the logging thread.
+ * The writer thread wakes up every FLUSH_INTERVAL, or earlier for errors or when the buffer is filling up, writes all
+ * queued lines and flushes the file once.
+ */
+class Log::Writer
+{
+  public:
+    /**
+     * @brief get the writer, it's created on the first call
+     * @returns the writer, or nullptr if it's already destructed at exit
+     */
+    static Writer *instance()
+    {
+        if (writerDestructed.load(std::memory_order_acquire))
+            return nullptr;
+        static Writer writer;
+        return &writer;
+    }
+
+    /**
+     * @brief start the writer thread, the lines are only queued before this
+     */
+    void start()
+    {
+        if (!thread.joinable())
+            thread = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief queue a line for the writer thread
+     * @returns false if the line is dropped because the buffer is full
+     * @note this is lock-free and can be called from any thread
+     */
+    bool push(Entry &&entry, bool urgent)
+    {
+        Cell *cell = nullptr;
+        auto position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &cells[position & (CAPACITY - 1)];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->entry = std::move(entry);
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        // The notification is sent without locking the mutex, so it may be missed if the writer thread is just about
+        // to wait. It's fine because the writer thread wakes up by itself after FLUSH_INTERVAL.
+        if (urgent || (position + 1) % (CAPACITY / 4) == 0)
+        {
+            wakeUp.store(true, std::memory_order_relaxed);
+            condition.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * @brief stop the writer thread after writing all queued lines
+     * @note if the thread is never started, the queued lines are written in the current thread
+     */
+    ~Writer()
+    {
+        writerDestructed.store(true, std::memory_order_release);
+        if (thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            condition.notify_one();
+            thread.join();
+        }
+        else
+        {
+            drain();
+        }
+    }
+
+  private:
+    static const std::size_t CAPACITY = 1 << 13; // the number of cells in the ring buffer, must be a power of 2
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence; // the position this cell is ready for, see push() and drain()
+        Entry entry;
+    };
+
+    Writer() : cells(new Cell[CAPACITY])
+    {
+        for (std::size_t i = 0; i < CAPACITY; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        logStream.setDevice(&logFile);
+    }
+
+    void run()
+    {
+        const std::chrono::milliseconds FLUSH_INTERVAL(100);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            condition.wait_for(lock, FLUSH_INTERVAL,
+                               [this] { return stopping || wakeUp.load(std::memory_order_relaxed); });
+            wakeUp.store(false, std::memory_order_relaxed);
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+        lock.unlock();
+        drain();
+    }
+
+    /**
+     * @brief write all queued lines, and flush the file if anything is written
+     * @note this is called only by the consumer, i.e. the writer thread, or the destructor if it's never started
+     */
+    void drain()
+    {
+        if (!logFile.isOpen() || !logFile.isWritable())
+            logFile.open(stderr, QIODevice::WriteOnly); // dump to stderr if failed to open log file
+
+        bool written = false;
+        Entry entry;
+        while (true)
+        {
+            auto &cell = cells[dequeuePosition & (CAPACITY - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+                break;
+            entry = std::move(cell.entry);
+            cell.entry.message.clear(); // don't keep the previous message alive in the cell
+            cell.sequence.store(dequeuePosition + CAPACITY, std::memory_order_release);
+            ++dequeuePosition;
+            write(entry);
+            written = true;
+        }
+
+        const int lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0)
+        {
+            logStream << "[" << lost << " lines are not logged because the log buffer is full]\n";
+            written = true;
+        }
+
+        if (written)
+            logStream.flush();
+    }
+
+    void write(const Entry &entry)
+    {
+        const qint64 second = entry.time / 1000;
+        if (second != cachedSecond)
+        {
+            cachedSecond = second;
+            cachedDateTime = QDateTime::fromSecsSinceEpoch(second).toString("yyyy-MM-ddThh:mm:ss");
+        }
+
+        auto &funcName = funcNames[entry.funcName];
+        if (funcName.isNull())
+            funcName = QString::fromUtf8(entry.funcName).right(MAXIMUM_FUNCTION_NAME_SIZE);
+
+        auto &fileName = fileNames[entry.fileName];
+        if (fileName.isNull())
+            fileName = QFileInfo(QString::fromUtf8(entry.fileName)).fileName().right(MAXIMUM_FILE_NAME_SIZE);
+
+        logStream << "[" << cachedDateTime << "." << QString("%1").arg(entry.time % 1000, 3, 10, QChar('0')) << "]"
+                  << Qt::center << "[" << entry.priority << "][" << qSetFieldWidth(MAXIMUM_FUNCTION_NAME_SIZE)
+                  << funcName << qSetFieldWidth(0) << "][" << qSetFieldWidth(MAXIMUM_FILE_NAME_SIZE) << fileName
+                  << qSetFieldWidth(0) << Qt::left << "]"
+                  << "(" << entry.line << ")::" << entry.message << "\n";
+    }
+
+    std::unique_ptr<Cell[]> cells;
+    std::atomic<std::size_t> enqueuePosition{0};
+    std::size_t dequeuePosition = 0; // used only by the consumer
+    std::atomic<int> dropped{0};     // the number of lines dropped since the last drain
+
+    std::mutex mutex; // guards stopping, used with condition
+    std::condition_variable condition;
+    bool stopping = false;
+    std::atomic<bool> wakeUp{false};
+    std::thread thread;
+
+    // used only by the consumer, the names are cached by the pointers to the string literals
+    QHash<const char *, QString> funcNames;
+    QHash<const char *, QString> fileNames;
+    qint64 cachedSecond = -1;
+    QString cachedDateTime; // the date and time of cachedSecond, the milliseconds are formatted for each line
+};
+
+// the formatter of the messages, each thread has one, and nested lines use their own ones
+struct Log::Line::Formatter
+{
+    QString text;
+    QTextStream stream;
+    bool inUse = false;
+
+    Formatter() : stream(&text)
+    {
+    }
+};
+
 const int Log::NUMBER_OF_LOGS_TO_KEEP = 50;
 const int Log::MAXIMUM_FUNCTION_NAME_SIZE = 30;
 const int Log::MAXIMUM_FILE_NAME_SIZE = 30;
@@ -43,7 +286,6 @@ const QString Log::LOG_FILE_NAME = "cpeditor";
 
 void Log::init(unsigned int instance, bool dumptoStderr)
 {
-    logStream.setDevice(&logFile);
     if (!dumptoStderr)
     {
         // get the path to the log file
@@ -76,15 +318,12 @@ void Log::init(unsigned int instance, bool dumptoStderr)
     {
         logFile.open(stderr, QIODevice::WriteOnly);
     }
+    if (auto *writer = Writer::instance())
+        writer->start();
     LOG_INFO("Event logger has been initialized successfully");
     platformInformation();
 }
 
-QString Log::dateTimeStamp()
-{
-    return "[" + QDateTime::currentDateTime().toString(Qt::ISODateWithMs) + "]";
-}
-
 void Log::platformInformation()
 {
     LOG_INFO("Gathering system information");
@@ -116,23 +355,60 @@ void Log::platformInformation()
     LOG_INFO(INFO_OF(__TIME__));
 }
 
-QTextStream &Log::log(const QString &priority, QString funcName, int line, QString fileName)
+Log::Line::Line(const char *priority, const char *funcName, int line, const char *fileName, bool urgent)
+    : time(QDateTime::currentMSecsSinceEpoch()), priority(priority), funcName(funcName), fileName(fileName),
+      line(line), urgent(urgent)
 {
-    if (!logFile.isOpen() || !logFile.isWritable())
-        logFile.open(stderr, QIODevice::WriteOnly); // dump to stderr if failed to open log file
-    if (funcName.size() > MAXIMUM_FUNCTION_NAME_SIZE)
-        funcName = funcName.right(MAXIMUM_FUNCTION_NAME_SIZE);
+    static thread_local Formatter sharedFormatter;
+    if (sharedFormatter.inUse)
+    {
+        // a LOG_* statement calls a function that logs
+        ownedFormatter.reset(new Formatter());
+        formatter = ownedFormatter.get();
+    }
+    else
+    {
+        formatter = &sharedFormatter;
+    }
+    formatter->inUse = true;
+}
+
+Log::Line::Line(Line &&other) noexcept
+    : time(other.time), priority(other.priority), funcName(other.funcName), fileName(other.fileName),
+      line(other.line), urgent(other.urgent), formatter(other.formatter),
+      ownedFormatter(std::move(other.ownedFormatter))
+{
+    other.formatter = nullptr;
+}
 
-    QFileInfo info(fileName);
-    fileName = info.fileName();
+Log::Line::~Line()
+{
+    if (formatter == nullptr)
+        return;
 
-    if (fileName.size() > MAXIMUM_FILE_NAME_SIZE)
-        fileName = fileName.right(MAXIMUM_FILE_NAME_SIZE);
+    Entry entry;
+    entry.time = time;
+    entry.priority = priority;
+    entry.funcName = funcName;
+    entry.fileName = fileName;
+    entry.line = line;
+    entry.message = std::move(formatter->text);
+    formatter->text.clear();
+    formatter->stream.reset(); // reset the manipulators like qSetFieldWidth for the next line
+    formatter->inUse = false;
 
-    return logStream << dateTimeStamp() << Qt::center << "[" << priority << "]["
-                     << qSetFieldWidth(MAXIMUM_FUNCTION_NAME_SIZE) << funcName << qSetFieldWidth(0) << "]["
-                     << qSetFieldWidth(MAXIMUM_FILE_NAME_SIZE) << fileName << qSetFieldWidth(0) << Qt::left << "]"
-                     << "(" << line << ")::";
+    if (auto *writer = Writer::instance())
+        writer->push(std::move(entry), urgent);
+}
+
+QTextStream &Log::Line::stream()
+{
+    return formatter->stream;
+}
+
+Log::Line Log::log(const char *priority, const char *funcName, int line, const char *fileName, bool urgent)
+{
+    return Line(priority, funcName, line, fileName, urgent);
 }
 
 void Log::revealInFileManager()
@@ -18,6 +18,11 @@
 /*
  * The event logger is used for logging events of the editor.
  * The logs can helps the maintainers find the bug.
+ *
+ * Logging doesn't block the calling thread: a LOG_* statement formats only its message, and pushes it into a
+ * lock-free ring buffer together with the time and the location. A background thread formats the headers, writes
+ * the lines to the log file and flushes the file once per batch. The logs queued in the last moments before a
+ * crash may be lost.
  */
 
 #ifndef EVENTLOGGER_HPP
@@ -27,6 +32,7 @@
 #include <QDebug>
 #endif
 #include <QTextStream>
+#include <memory>
 
 class QFile;
 
@@ -36,17 +42,36 @@ class QFile;
  * WARN: warning, used when something strange happened, but it is not necessarily an error
  * ERR: error, used when something bad happened
  * WTF: what a terrible failure, used when it's considered impossible to happen
+ *
+ * The levels lower than CPEDITOR_MIN_LOG_LEVEL (0: INFO, 1: WARN, 2: ERR, 3: WTF) are removed at compile time, the
+ * messages of them are not even evaluated. It's set by the MIN_LOG_LEVEL option of CMake.
  */
 
+#ifndef CPEDITOR_MIN_LOG_LEVEL
+#define CPEDITOR_MIN_LOG_LEVEL 0
+#endif
+
 /*
  * These NOLINT are placed because macro arguments should be brace enclosed to prevent strange issues. Since, we want a
  * pure string replacement, we cannot put braces, and hence the no lint.
  */
 
-#define LOG_INFO(stream) Core::Log::log("INFO ", __func__, __LINE__, __FILE__) << stream << Qt::endl; // NOLINT
-#define LOG_WARN(stream) Core::Log::log("WARN ", __func__, __LINE__, __FILE__) << stream << Qt::endl; // NOLINT
-#define LOG_ERR(stream) Core::Log::log("ERROR", __func__, __LINE__, __FILE__) << stream << Qt::endl;  // NOLINT
-#define LOG_WTF(stream) Core::Log::log(" WTF ", __func__, __LINE__, __FILE__) << stream << Qt::endl;  // NOLINT
+#if CPEDITOR_MIN_LOG_LEVEL <= 0
+#define LOG_INFO(stream) Core::Log::log("INFO ", __func__, __LINE__, __FILE__) << stream; // NOLINT
+#else
+#define LOG_INFO(stream) static_cast<void>(0);
+#endif
+#if CPEDITOR_MIN_LOG_LEVEL <= 1
+#define LOG_WARN(stream) Core::Log::log("WARN ", __func__, __LINE__, __FILE__) << stream; // NOLINT
+#else
+#define LOG_WARN(stream) static_cast<void>(0);
+#endif
+#if CPEDITOR_MIN_LOG_LEVEL <= 2
+#define LOG_ERR(stream) Core::Log::log("ERROR", __func__, __LINE__, __FILE__, true) << stream; // NOLINT
+#else
+#define LOG_ERR(stream) static_cast<void>(0);
+#endif
+#define LOG_WTF(stream) Core::Log::log(" WTF ", __func__, __LINE__, __FILE__, true) << stream; // NOLINT
 
 #define LOG_INFO_IF(cond, stream)                                                                                      \
     if (cond)                                                                                                          \
@@ -91,6 +116,46 @@ namespace Core
 class Log
 {
   public:
+    /**
+     * @brief a line in the log
+     * @note The message is formatted into a thread-local buffer, and the line is queued for the writer thread when
+     *       it's destructed, so a LOG_* statement is written as a whole even if other threads are logging at the
+     *       same time.
+     */
+    class Line
+    {
+      public:
+        Line(const char *priority, const char *funcName, int line, const char *fileName, bool urgent);
+        Line(Line &&other) noexcept;
+        ~Line();
+
+        template <typename T> Line &operator<<(const T &value)
+        {
+            stream() << value;
+            return *this;
+        }
+
+        Line &operator<<(QTextStream &(*manipulator)(QTextStream &))
+        {
+            stream() << manipulator;
+            return *this;
+        }
+
+      private:
+        struct Formatter;
+
+        QTextStream &stream();
+
+        qint64 time;                               // the milliseconds since epoch when the line is logged
+        const char *priority;                      // a string literal, kept as a pointer instead of copied
+        const char *funcName;                      // __func__, kept as a pointer instead of copied
+        const char *fileName;                      // __FILE__, kept as a pointer instead of copied
+        int line;                                  // the line number in the source file
+        bool urgent;                               // whether to wake up the writer thread immediately
+        Formatter *formatter;                      // formats the message, nullptr if it's moved to another Line
+        std::unique_ptr<Formatter> ownedFormatter; // used if the thread-local one is used by an outer Line
+    };
+
     /**
      * @brief initialize the event logger
      * @param instance the instance ID provided by SingleApplication, to distinct processes from each other
@@ -110,13 +175,18 @@ class Log
      */
     static void revealInFileManager();
 
-    static QTextStream &log(const QString &priority, QString funcName, int line, QString fileName);
+    /**
+     * @brief start a line in the log
+     * @param urgent whether to write the line as soon as possible instead of in the next batch, used for errors
+     */
+    static Line log(const char *priority, const char *funcName, int line, const char *fileName, bool urgent = false);
 
   private:
-    static QString dateTimeStamp();
+    class Writer;
+
     static void platformInformation();
 
-    static QTextStream logStream; // the text stream for logging, writes to logFile
+    static QTextStream logStream; // the text stream for logging, writes to logFile, used only by the writer thread
     static QFile logFile;         // the device for logging, a file or stderr
 
     const static int NUMBER_OF_LOGS_TO_KEEP; // Number of log files to keep in Temporary directory
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/ExecutionThread.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/HardwareCounters.hpp"
+#include "Core/OutputBuffer.hpp"
+
+namespace Core
+{
+
+ExecutionThread *ExecutionThread::instance()
+{
+    static ExecutionThread *thread = nullptr;
+    if (thread == nullptr)
+    {
+        qRegisterMetaType<Core::OutputBuffer>("Core::OutputBuffer");
+        qRegisterMetaType<Core::HardwareCounters::Counts>("Core::HardwareCounters::Counts");
+        // It's a child of the application, so it's stopped after all windows are destructed.
+        thread = new ExecutionThread(qApp);
+        thread->start();
+    }
+    return thread;
+}
+
+ExecutionThread::ExecutionThread(QObject *parent) : QThread(parent)
+{
+    setObjectName("Execution");
+    worker = new QObject();
+    worker->moveToThread(this);
+    LOG_INFO("Execution thread created");
+}
+
+ExecutionThread::~ExecutionThread()
+{
+    quit();
+    wait();
+    delete worker; // the thread is finished, so it's safe to delete it here
+}
+
+} // namespace Core
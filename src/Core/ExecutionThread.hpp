@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The execution thread is a thread with its own event loop, shared by all windows.
+ * The processes of the runners are driven by it, and the heavy work of the checkers is done in it,
+ * so that reading the outputs of many test cases doesn't block the GUI thread.
+ * Objects living in this thread talk to the GUI thread only by queued signals.
+ */
+
+#ifndef EXECUTIONTHREAD_HPP
+#define EXECUTIONTHREAD_HPP
+
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThread>
+
+namespace Core
+{
+
+class ExecutionThread : public QThread
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the execution thread
+     * @note The thread is created and started on the first call, and it's stopped when the application is destructed.
+     *       This should be called in the GUI thread.
+     */
+    static ExecutionThread *instance();
+
+    /**
+     * @brief do some work in the execution thread, and then handle the result in the GUI thread
+     * @param context the object which handles the result, it should live in the GUI thread
+     * @param work a functor called in the execution thread, its return value is passed to *done*
+     * @param done a functor called in the GUI thread with the result of *work*
+     * @note *done* is not called if *context* is destructed before the work is done.
+     *       *work* must not use *context* or anything else that lives in the GUI thread.
+     */
+    template <typename Work, typename Done> static void post(QObject *context, Work work, Done done)
+    {
+        QPointer<QObject> guard(context);
+        QMetaObject::invokeMethod(
+            instance()->worker,
+            [guard, work, done]() {
+                auto result = work();
+                QMetaObject::invokeMethod(
+                    qApp,
+                    [guard, result, done]() {
+                        if (guard)
+                            done(result);
+                    },
+                    Qt::QueuedConnection);
+            },
+            Qt::QueuedConnection);
+    }
+
+    /**
+     * @brief stop the thread
+     * @note Objects living in this thread which are scheduled for deletion are deleted before it finishes.
+     */
+    ~ExecutionThread() override;
+
+  private:
+    explicit ExecutionThread(QObject *parent);
+
+    QObject *worker = nullptr; // an object living in this thread, used to invoke functors in this thread
+};
+
+} // namespace Core
+
+#endif // EXECUTIONTHREAD_HPP
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/HardwareCounters.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/Util.hpp"
+#include <QCoreApplication>
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+
+bool HardwareCounters::Counts::isValid() const
+{
+    return instructions >= 0 || cycles >= 0 || cacheMisses >= 0 || branchMisses >= 0;
+}
+
+double HardwareCounters::Counts::ipc() const
+{
+    if (instructions < 0 || cycles <= 0)
+        return 0;
+    return static_cast<double>(instructions) / cycles;
+}
+
+QString HardwareCounters::Counts::toString() const
+{
+    QStringList res;
+    if (instructions >= 0)
+        res.push_back(QCoreApplication::translate("Core::HardwareCounters", "~%1 instructions")
+                          .arg(Util::shortNumber(instructions)));
+    if (ipc() > 0)
+        res.push_back(QCoreApplication::translate("Core::HardwareCounters", "IPC %1").arg(ipc(), 0, 'f', 2));
+    if (cacheMisses >= 0)
+        res.push_back(QCoreApplication::translate("Core::HardwareCounters", "~%1 cache misses")
+                          .arg(Util::shortNumber(cacheMisses)));
+    if (branchMisses >= 0)
+        res.push_back(QCoreApplication::translate("Core::HardwareCounters", "~%1 branch misses")
+                          .arg(Util::shortNumber(branchMisses)));
+    return res.join(", ");
+}
+
+HardwareCounters::~HardwareCounters()
+{
+    close();
+}
+
+#ifdef Q_OS_LINUX
+
+/**
+ * @brief open a counter of a hardware event of a process
+ * @returns the file descriptor of the counter, or -1 if it's not available
+ */
+static int openCounter(qint64 pid, quint64 config)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1; // counting the kernel needs a lower perf_event_paranoid
+    attr.exclude_hv = 1;
+    attr.inherit = 1; // count the threads created later as well
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, static_cast<pid_t>(pid), -1, -1, 0));
+}
+
+static qint64 readCounter(int fd)
+{
+    if (fd == -1)
+        return -1;
+    quint64 value = 0;
+    if (::read(fd, &value, sizeof(value)) != sizeof(value))
+        return -1;
+    return static_cast<qint64>(value);
+}
+
+bool HardwareCounters::attach(qint64 pid)
+{
+    close();
+    instructionsFd = openCounter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+    cyclesFd = openCounter(pid, PERF_COUNT_HW_CPU_CYCLES);
+    cacheMissesFd = openCounter(pid, PERF_COUNT_HW_CACHE_MISSES);
+    branchMissesFd = openCounter(pid, PERF_COUNT_HW_BRANCH_MISSES);
+
+    const bool attached = instructionsFd != -1 || cyclesFd != -1 || cacheMissesFd != -1 || branchMissesFd != -1;
+    if (!attached)
+        LOG_INFO("Hardware counters are not available: " << strerror(errno));
+    return attached;
+}
+
+HardwareCounters::Counts HardwareCounters::read() const
+{
+    Counts res;
+    res.instructions = readCounter(instructionsFd);
+    res.cycles = readCounter(cyclesFd);
+    res.cacheMisses = readCounter(cacheMissesFd);
+    res.branchMisses = readCounter(branchMissesFd);
+    return res;
+}
+
+void HardwareCounters::close()
+{
+    for (auto *fd : {&instructionsFd, &cyclesFd, &cacheMissesFd, &branchMissesFd})
+    {
+        if (*fd != -1)
+        {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+#else
+
+bool HardwareCounters::attach(qint64 pid)
+{
+    Q_UNUSED(pid)
+    return false;
+}
+
+HardwareCounters::Counts HardwareCounters::read() const
+{
+    return Counts();
+}
+
+void HardwareCounters::close()
+{
+}
+
+#endif
+
+} // namespace Core
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The HardwareCounters counts the hardware events of a running process by perf_event_open(2) on Linux:
+ * the instructions, the CPU cycles, the cache misses and the branch mispredictions, in the user space only.
+ * The counters are attached after the process is started, by the started slot of the runner, which is queued. The
+ * process may have run for an arbitrary time by then, e.g. a short process may have already finished, so the counts
+ * are approximate lower bounds and they are shown with a "~".
+ * When the perf events are not available, e.g. they are restricted by /proc/sys/kernel/perf_event_paranoid, the
+ * machine is virtualized without a PMU, or it's not Linux, nothing is counted and the counts are invalid.
+ */
+
+#ifndef HARDWARECOUNTERS_HPP
+#define HARDWARECOUNTERS_HPP
+
+#include <QMetaType>
+#include <QString>
+
+namespace Core
+{
+
+class HardwareCounters
+{
+  public:
+    struct Counts
+    {
+        qint64 instructions = -1; // the number of instructions retired, -1 if it's not counted
+        qint64 cycles = -1;       // the number of CPU cycles, -1 if it's not counted
+        qint64 cacheMisses = -1;  // the number of last level cache misses, -1 if it's not counted
+        qint64 branchMisses = -1; // the number of mispredicted branches, -1 if it's not counted
+
+        /**
+         * @brief whether any event is counted
+         */
+        bool isValid() const;
+
+        /**
+         * @brief the instructions per cycle, 0 if the instructions or the cycles are not counted
+         */
+        double ipc() const;
+
+        /**
+         * @brief a short description of the counted events, e.g. "~1.2G instructions, IPC 2.31, ~3.4M cache misses"
+         */
+        QString toString() const;
+    };
+
+    HardwareCounters() = default;
+
+    /**
+     * @brief stop counting and release the counters
+     */
+    ~HardwareCounters();
+
+    /**
+     * @brief start counting the events of a process and the threads it creates later
+     * @param pid the process ID
+     * @returns whether any event is being counted
+     */
+    bool attach(qint64 pid);
+
+    /**
+     * @brief read the counts
+     * @note The counts are kept after the process exits, so they can be read after it has finished.
+     */
+    Counts read() const;
+
+  private:
+    Q_DISABLE_COPY(HardwareCounters)
+
+    void close();
+
+    int instructionsFd = -1;
+    int cyclesFd = -1;
+    int cacheMissesFd = -1;
+    int branchMissesFd = -1;
+};
+
+} // namespace Core
+
+Q_DECLARE_METATYPE(Core::HardwareCounters::Counts)
+
+#endif // HARDWARECOUNTERS_HPP
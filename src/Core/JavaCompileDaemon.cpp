@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/JavaCompileDaemon.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+namespace Core
+{
+
+JavaCompileDaemon *JavaCompileDaemon::instance()
+{
+    static JavaCompileDaemon *daemon = nullptr;
+    if (daemon == nullptr)
+        daemon = new JavaCompileDaemon(qApp); // it's a child of the application, so it's stopped on exit
+    return daemon;
+}
+
+JavaCompileDaemon::JavaCompileDaemon(QObject *parent) : QObject(parent)
+{
+}
+
+JavaCompileDaemon::~JavaCompileDaemon()
+{
+    if (daemonProcess != nullptr)
+    {
+        daemonProcess->disconnect(this);
+        daemonProcess->closeWriteChannel(); // the daemon exits when its stdin is closed
+        if (!daemonProcess->waitForFinished(1000))
+            daemonProcess->kill();
+        delete daemonProcess;
+    }
+    if (buildProcess != nullptr)
+    {
+        buildProcess->disconnect(this);
+        buildProcess->kill();
+        delete buildProcess;
+    }
+    delete tmpDir;
+}
+
+void JavaCompileDaemon::compile(const QString &javac, const QStringList &args, QObject *context,
+                                const Callback &callback)
+{
+    requests.enqueue({args, context, callback});
+
+    if (state == Broken)
+        failAll(tr("The daemon can't be built"), Broken);
+    else if (state == Stopped)
+        build(javac);
+    else if (state == Running)
+        sendNext();
+}
+
+void JavaCompileDaemon::build(const QString &javac)
+{
+    state = Building;
+
+    if (tmpDir != nullptr && QFile::exists(tmpDir->filePath("CompileDaemon.class")))
+    {
+        launch(); // it's built before the last time the daemon died
+        return;
+    }
+
+    delete tmpDir;
+    tmpDir = new QTemporaryDir();
+    if (!tmpDir->isValid())
+    {
+        failAll(tr("Failed to create the temporary directory"), Broken);
+        return;
+    }
+
+    const auto source = tmpDir->filePath("CompileDaemon.java");
+    if (!Util::saveFile(source, Util::readFile(":/java/CompileDaemon.java"), tr("Java Compile Daemon"), false))
+    {
+        failAll(tr("Failed to save the source of the daemon"), Broken);
+        return;
+    }
+
+    LOG_INFO("Building the Java compile daemon with " << javac);
+
+    buildProcess = new QProcess();
+    connect(buildProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this](int exitCode) {
+        const auto error = QString::fromLocal8Bit(buildProcess->readAllStandardError());
+        buildProcess->deleteLater();
+        buildProcess = nullptr;
+        if (exitCode == 0)
+            launch();
+        else
+            failAll(tr("Failed to compile the daemon: %1").arg(error), Broken);
+    });
+    connect(buildProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        buildProcess->deleteLater();
+        buildProcess = nullptr;
+        failAll(tr("Failed to start javac"), Broken);
+    });
+    buildProcess->start(javac, {source, "-d", tmpDir->path()});
+}
+
+void JavaCompileDaemon::launch()
+{
+    auto command = QProcess::splitCommand(SettingsHelper::getJavaRunCommand());
+    if (command.isEmpty())
+    {
+        failAll(tr("The Java run command is empty"), Broken);
+        return;
+    }
+    const auto java = command.takeFirst();
+
+    LOG_INFO("Starting the Java compile daemon with " << java);
+
+    daemonProcess = new QProcess();
+    connect(daemonProcess, &QProcess::readyReadStandardOutput, this, &JavaCompileDaemon::onReadyRead);
+    connect(daemonProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this](int exitCode) {
+        LOG_WARN("The Java compile daemon exited with " << INFO_OF(exitCode));
+        daemonProcess->deleteLater();
+        daemonProcess = nullptr;
+        failAll(tr("The daemon exited with code %1").arg(exitCode), Stopped);
+    });
+    connect(daemonProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        daemonProcess->deleteLater();
+        daemonProcess = nullptr;
+        failAll(tr("Failed to start java"), Broken);
+    });
+
+    state = Running;
+    daemonProcess->start(java, {"-classpath", tmpDir->path(), "CompileDaemon"});
+    sendNext();
+}
+
+void JavaCompileDaemon::sendNext()
+{
+    // skip the requests whose Compilers are already destructed
+    while (!busy && !requests.isEmpty() && requests.head().context.isNull())
+        requests.dequeue();
+
+    if (busy || requests.isEmpty() || daemonProcess == nullptr)
+        return;
+
+    QByteArrayList parts;
+    for (const auto &arg : requests.head().args)
+        parts.push_back(arg.toUtf8().toBase64());
+    busy = true;
+    daemonProcess->write(parts.join(' ') + '\n');
+}
+
+void JavaCompileDaemon::onReadyRead()
+{
+    buffer += daemonProcess->readAllStandardOutput();
+
+    int end;
+    while ((end = buffer.indexOf('\n')) != -1)
+    {
+        const auto line = buffer.left(end).trimmed();
+        buffer.remove(0, end + 1);
+        if (line.isEmpty() || !busy || requests.isEmpty())
+            continue;
+
+        const int space = line.indexOf(' ');
+        bool ok = false;
+        const int exitCode = line.left(space).toInt(&ok);
+        const auto output = space == -1 ? QByteArray() : QByteArray::fromBase64(line.mid(space + 1));
+
+        busy = false;
+        auto request = requests.dequeue();
+        if (!request.context.isNull())
+            request.callback(ok, exitCode, output);
+    }
+
+    sendNext();
+}
+
+void JavaCompileDaemon::failAll(const QString &reason, State newState)
+{
+    LOG_WARN("The Java compile daemon failed: " << reason);
+
+    state = newState;
+    busy = false;
+    buffer.clear();
+
+    // the callbacks may send new requests, which start the daemon again
+    auto failed = requests;
+    requests.clear();
+    for (const auto &request : failed)
+    {
+        if (!request.context.isNull())
+            request.callback(false, 0, QByteArray());
+    }
+}
+
+} // namespace Core
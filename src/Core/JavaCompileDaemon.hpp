@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JavaCompileDaemon keeps a JVM running the Java compile daemon (resources/java/CompileDaemon.java),
+ * which compiles Java with javax.tools instead of starting javac for every compilation.
+ * The daemon is compiled and started on the first request, and it handles the requests one by one.
+ * When the daemon can't be built or dies, the pending requests fail, so that the Compilers can fall back to javac.
+ * It lives in the GUI thread and is shared by all Compilers.
+ */
+
+#ifndef JAVACOMPILEDAEMON_HPP
+#define JAVACOMPILEDAEMON_HPP
+
+#include <QPointer>
+#include <QProcess>
+#include <QQueue>
+#include <functional>
+
+class QTemporaryDir;
+
+namespace Core
+{
+
+class JavaCompileDaemon : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief the callback of a request
+     * @param ok whether the request is handled by the daemon, if not, the other arguments are meaningless
+     * @param exitCode the exit code of javac
+     * @param output the diagnostics of javac, the same as its stderr
+     */
+    using Callback = std::function<void(bool ok, int exitCode, const QByteArray &output)>;
+
+    /**
+     * @brief get the daemon
+     * @note The daemon is stopped when the application is destructed. This should be called in the GUI thread.
+     */
+    static JavaCompileDaemon *instance();
+
+    ~JavaCompileDaemon() override;
+
+    /**
+     * @brief compile Java with the daemon
+     * @param javac the program of the compile command, used to compile the daemon itself
+     * @param args the arguments of javac, the paths in them should be absolute
+     * @param context the object which handles the result, the callback is not called if it's destructed
+     * @param callback called in the GUI thread when the compilation is done or failed
+     */
+    void compile(const QString &javac, const QStringList &args, QObject *context, const Callback &callback);
+
+  private:
+    struct Request
+    {
+        QStringList args;
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    enum State
+    {
+        Stopped,  // the daemon is not running, it's started on the next request
+        Building, // the daemon is being compiled
+        Running,  // the daemon is running
+        Broken    // the daemon can't be built or started, all requests fail until the application restarts
+    };
+
+    explicit JavaCompileDaemon(QObject *parent);
+
+    void build(const QString &javac);
+    void launch();
+    void sendNext();
+    void onReadyRead();
+    /**
+     * @brief fail all pending requests, so that their Compilers fall back to javac
+     * @param reason the reason of the failure, which is logged
+     * @param newState Stopped if the daemon may be started again on the next request, Broken otherwise
+     */
+    void failAll(const QString &reason, State newState);
+
+    State state = Stopped;
+    QTemporaryDir *tmpDir = nullptr;   // holds the source and the class of the daemon
+    QProcess *buildProcess = nullptr;  // compiles the daemon
+    QProcess *daemonProcess = nullptr; // the running daemon
+    QQueue<Request> requests;          // the requests not responded yet, the head is being handled if busy is true
+    bool busy = false;                 // whether the head of requests is sent to the daemon
+    QByteArray buffer;                 // the incomplete response from the daemon
+};
+
+} // namespace Core
+
+#endif // JAVACOMPILEDAEMON_HPP
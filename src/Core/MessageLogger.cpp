@@ -91,4 +91,9 @@ void MessageLogger::onAnchorClicked(const QUrl &link)
     LOG_INFO(INFO_OF(url));
     if (url.startsWith("#Preferences/"))
         preferencesWindow->open(url.mid(13));
+    else if (url.startsWith("#Line/"))
+    {
+        const auto position = url.mid(6).split(':');
+        emit requestGoToPosition(position[0].toInt(), position.value(1).toInt());
+    }
 }
@@ -69,6 +69,14 @@ class MessageLogger : public QTextBrowser
      */
     void error(const QString &head, const QString &body, bool htmlEscaped = true);
 
+  signals:
+    /**
+     * @brief a link to a position in the code is clicked, the link is in the format of "#Line/<line>:<column>"
+     * @param line the line number, 1-based
+     * @param column the column number, 1-based
+     */
+    void requestGoToPosition(int line, int column);
+
   private slots:
     void onAnchorClicked(const QUrl &link);
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/OutputBuffer.hpp"
+#include <QFile>
+#include <QSharedData>
+#include <limits>
+#include <memory>
+
+namespace Core
+{
+
+struct OutputBuffer::Data : public QSharedData
+{
+    std::unique_ptr<QFile> file; // the mapped file, destructed after bytes which refers to it
+    QByteArray bytes;
+    bool truncated = false;
+    Summary summary;
+};
+
+OutputBuffer::OutputBuffer() : d(new Data)
+{
+}
+
+OutputBuffer::OutputBuffer(const QByteArray &bytes) : d(new Data)
+{
+    d->bytes = bytes;
+}
+
+OutputBuffer::OutputBuffer(const QByteArray &bytes, const Summary &summary) : d(new Data)
+{
+    d->bytes = bytes;
+    d->truncated = true;
+    d->summary = summary;
+}
+
+OutputBuffer OutputBuffer::fromFile(const QString &path)
+{
+    OutputBuffer buffer;
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly))
+        return buffer;
+
+#ifndef Q_OS_WIN
+    const qint64 size = file->size();
+    if (size > 0 && size < std::numeric_limits<int>::max())
+    {
+        auto *data = file->map(0, size);
+        if (data != nullptr)
+        {
+            buffer.d->bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(data), static_cast<int>(size));
+            buffer.d->file = std::move(file);
+            return buffer;
+        }
+    }
+#endif
+
+    buffer.d->bytes = file->readAll();
+    return buffer;
+}
+
+OutputBuffer::OutputBuffer(const OutputBuffer &other) = default;
+
+OutputBuffer &OutputBuffer::operator=(const OutputBuffer &other) = default;
+
+OutputBuffer::~OutputBuffer() = default;
+
+const QByteArray &OutputBuffer::bytes() const
+{
+    return d->bytes;
+}
+
+QString OutputBuffer::text() const
+{
+    return QString::fromUtf8(d->bytes);
+}
+
+QString OutputBuffer::left(int maxLength) const
+{
+    // A UTF-16 code unit takes at most 3 bytes in UTF-8 (a surrogate pair takes 4 bytes for 2 units), so the first
+    // maxLength characters are in the first 3 * maxLength bytes. Move back to the beginning of a character to avoid
+    // decoding an incomplete sequence.
+    int end = static_cast<int>(qMin<qint64>(3LL * qMax(maxLength, 0), d->bytes.size()));
+    if (end < d->bytes.size())
+    {
+        while (end > 0 && (static_cast<unsigned char>(d->bytes[end]) & 0xC0) == 0x80)
+            --end;
+    }
+    return QString::fromUtf8(d->bytes.constData(), end).left(maxLength);
+}
+
+int OutputBuffer::size() const
+{
+    return d->bytes.size();
+}
+
+bool OutputBuffer::isEmpty() const
+{
+    return d->bytes.isEmpty();
+}
+
+bool OutputBuffer::isTruncated() const
+{
+    return d->truncated;
+}
+
+OutputBuffer::Summary OutputBuffer::summary() const
+{
+    return d->summary;
+}
+
+} // namespace Core
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The OutputBuffer holds the output of a program as immutable UTF-8 bytes.
+ * It's reference-counted, so passing it from the Runner to the test cases, the checker
+ * and the diff viewer doesn't copy the output. The bytes are decoded on demand, and the decoded
+ * text isn't kept, so a large output only costs its UTF-8 bytes while it's held.
+ * If the middle part of a long output is discarded, the buffer holds the beginning and the end,
+ * together with a summary of the whole output.
+ */
+
+#ifndef OUTPUTBUFFER_HPP
+#define OUTPUTBUFFER_HPP
+
+#include <QExplicitlySharedDataPointer>
+#include <QMetaType>
+#include <QString>
+
+namespace Core
+{
+
+class OutputBuffer
+{
+  public:
+    // the summary of the whole output, used when the middle part of the output is discarded
+    struct Summary
+    {
+        qint64 size = 0;        // the number of bytes in the whole output
+        QByteArray strictHash;  // see OutputHasher::strictHash
+        QByteArray lenientHash; // see OutputHasher::lenientHash
+    };
+
+    /**
+     * @brief construct an empty output buffer
+     */
+    OutputBuffer();
+
+    /**
+     * @brief construct an output buffer
+     * @param bytes the UTF-8 encoded output, it's shared instead of copied
+     */
+    explicit OutputBuffer(const QByteArray &bytes);
+
+    /**
+     * @brief construct an output buffer whose middle part is discarded
+     * @param bytes the kept parts of the output
+     * @param summary the summary of the whole output
+     */
+    OutputBuffer(const QByteArray &bytes, const Summary &summary);
+
+    /**
+     * @brief construct an output buffer with the content of a file
+     * @param path the path to the file
+     * @returns the output buffer, or an empty buffer if the file can't be opened
+     * @note The file is mapped into memory instead of read when possible, so it's not copied.
+     *       The mapping is kept valid even if the file is removed later, except on Windows, where the file is read.
+     */
+    static OutputBuffer fromFile(const QString &path);
+
+    OutputBuffer(const OutputBuffer &other);
+    OutputBuffer &operator=(const OutputBuffer &other);
+    ~OutputBuffer();
+
+    /**
+     * @brief the raw UTF-8 bytes of the output
+     * @note The bytes may refer to a mapped file, don't keep a copy of them longer than this buffer.
+     */
+    const QByteArray &bytes() const;
+
+    /**
+     * @brief the decoded output
+     * @note the output is decoded on every call, keep the result instead of calling it repeatedly
+     */
+    QString text() const;
+
+    /**
+     * @brief the first *maxLength* characters of the output, the same as text().left(maxLength)
+     * @param maxLength the maximum number of characters
+     * @note this only decodes the needed prefix
+     */
+    QString left(int maxLength) const;
+
+    /**
+     * @brief the size of the output in bytes, which is an upper bound of the number of characters
+     */
+    int size() const;
+
+    bool isEmpty() const;
+
+    /**
+     * @brief whether the middle part of the output is discarded
+     */
+    bool isTruncated() const;
+
+    /**
+     * @brief the summary of the whole output, only valid if it's truncated
+     */
+    Summary summary() const;
+
+  private:
+    struct Data;
+    QExplicitlySharedDataPointer<Data> d;
+};
+
+} // namespace Core
+
+Q_DECLARE_METATYPE(Core::OutputBuffer)
+
+#endif // OUTPUTBUFFER_HPP
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/OutputCapture.hpp"
+#include "Core/OutputHasher.hpp"
+#include <QCoreApplication>
+#include <algorithm>
+
+namespace Core
+{
+
+namespace
+{
+bool isContinuationByte(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// the length of the UTF-8 sequence started by c, or 1 if it's not a valid leading byte
+int sequenceLength(char c)
+{
+    const auto b = static_cast<unsigned char>(c);
+    if ((b & 0xE0) == 0xC0)
+        return 2;
+    if ((b & 0xF0) == 0xE0)
+        return 3;
+    if ((b & 0xF8) == 0xF0)
+        return 4;
+    return 1;
+}
+
+// the number of bytes at the end of the head which are an incomplete UTF-8 character
+int incompleteSuffixLength(const QByteArray &bytes)
+{
+    int start = bytes.size() - 1;
+    while (start >= 0 && start > bytes.size() - 4 && isContinuationByte(bytes[start]))
+        --start;
+    if (start < 0)
+        return 0;
+    return start + sequenceLength(bytes[start]) > bytes.size() ? bytes.size() - start : 0;
+}
+
+// the number of bytes at the beginning of the tail which are the rest of a cut UTF-8 character
+int incompletePrefixLength(const QByteArray &bytes)
+{
+    int length = 0;
+    while (length < bytes.size() && length < 3 && isContinuationByte(bytes[length]))
+        ++length;
+    return length;
+}
+} // namespace
+
+OutputCapture::OutputCapture() = default;
+
+OutputCapture::OutputCapture(int headLength, int tailLength)
+    : bounded(true), headLength(qMax(headLength, 0)), tailLength(qMax(tailLength, 0)), hasher(new OutputHasher())
+{
+}
+
+OutputCapture::OutputCapture(OutputCapture &&other) noexcept = default;
+
+OutputCapture &OutputCapture::operator=(OutputCapture &&other) noexcept = default;
+
+OutputCapture::~OutputCapture() = default;
+
+void OutputCapture::append(const QByteArray &data)
+{
+    if (!bounded)
+    {
+        // remove '\0' in place, the whole output is kept anyway
+        const int oldSize = head.size();
+        head.resize(oldSize + data.size());
+        char *dest = head.data() + oldSize;
+        for (const char c : data)
+        {
+            if (c != '\0')
+                *dest++ = c;
+        }
+        head.resize(static_cast<int>(dest - head.constData()));
+        totalSize = head.size();
+        return;
+    }
+
+    QByteArray bytes = data;
+    if (bytes.contains('\0'))
+        bytes.replace('\0', "");
+
+    totalSize += bytes.size();
+    hasher->addData(bytes);
+
+    const char *p = bytes.constData();
+    int remaining = bytes.size();
+
+    if (head.size() < headLength)
+    {
+        const int length = qMin(headLength - head.size(), remaining);
+        head.append(p, length);
+        p += length;
+        remaining -= length;
+    }
+
+    if (remaining == 0 || tailLength == 0)
+        return;
+
+    if (remaining >= tailLength)
+    {
+        tail = QByteArray(p + remaining - tailLength, tailLength);
+        tailStart = 0;
+        return;
+    }
+
+    if (tail.size() < tailLength)
+    {
+        const int length = qMin(tailLength - tail.size(), remaining);
+        tail.append(p, length);
+        p += length;
+        remaining -= length;
+    }
+
+    // overwrite the oldest bytes in the ring buffer
+    while (remaining > 0)
+    {
+        const int length = qMin(tailLength - tailStart, remaining);
+        std::copy(p, p + length, tail.data() + tailStart);
+        tailStart = (tailStart + length) % tailLength;
+        p += length;
+        remaining -= length;
+    }
+}
+
+qint64 OutputCapture::size() const
+{
+    return totalSize;
+}
+
+OutputBuffer OutputCapture::buffer() const
+{
+    const QByteArray orderedTail = tail.mid(tailStart) + tail.left(tailStart);
+
+    if (!bounded || totalSize == head.size() + orderedTail.size())
+        return OutputBuffer(head + orderedTail);
+
+    // cut at the boundaries of UTF-8 characters, so the kept parts don't end with garbled characters
+    const QByteArray keptHead = head.left(head.size() - incompleteSuffixLength(head));
+    const QByteArray keptTail = orderedTail.mid(incompletePrefixLength(orderedTail));
+
+    const QByteArray separator =
+        QCoreApplication::translate("Core::OutputCapture", "\n[... %1 bytes are discarded ...]\n")
+            .arg(totalSize - keptHead.size() - keptTail.size())
+            .toUtf8();
+
+    OutputBuffer::Summary summary;
+    summary.size = totalSize;
+    summary.strictHash = hasher->strictHash();
+    summary.lenientHash = hasher->lenientHash();
+
+    return OutputBuffer(keptHead + separator + keptTail, summary);
+}
+
+} // namespace Core
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The OutputCapture collects the stdout or stderr of a running program.
+ * By default it keeps the whole output. In the bounded mode, it keeps only the beginning and the end
+ * of the output in constant memory, and hashes the whole output so that it can still be checked.
+ */
+
+#ifndef OUTPUTCAPTURE_HPP
+#define OUTPUTCAPTURE_HPP
+
+#include "Core/OutputBuffer.hpp"
+#include <memory>
+
+namespace Core
+{
+
+class OutputHasher;
+
+class OutputCapture
+{
+  public:
+    /**
+     * @brief construct an output capture which keeps the whole output
+     */
+    OutputCapture();
+
+    /**
+     * @brief construct a bounded output capture
+     * @param headLength the number of bytes to keep at the beginning of the output
+     * @param tailLength the number of bytes to keep at the end of the output
+     */
+    OutputCapture(int headLength, int tailLength);
+
+    OutputCapture(OutputCapture &&other) noexcept;
+    OutputCapture &operator=(OutputCapture &&other) noexcept;
+    ~OutputCapture();
+
+    /**
+     * @brief append the data read from the process, removing '\0' characters
+     */
+    void append(const QByteArray &data);
+
+    /**
+     * @brief the number of bytes appended, including the discarded ones
+     */
+    qint64 size() const;
+
+    /**
+     * @brief the captured output
+     * @note In the bounded mode, if some bytes are discarded, the beginning and the end are separated by a line
+     *       saying how many bytes are discarded, and the returned buffer is truncated. Nothing should be appended
+     *       after calling this.
+     */
+    OutputBuffer buffer() const;
+
+  private:
+    bool bounded = false;
+    int headLength = 0;
+    int tailLength = 0;
+    qint64 totalSize = 0;                 // the number of bytes appended
+    QByteArray head;                      // the beginning of the output, or the whole output if not bounded
+    QByteArray tail;                      // a ring buffer of the end of the output
+    int tailStart = 0;                    // the position of the oldest byte in tail when it's full
+    std::unique_ptr<OutputHasher> hasher; // hashes the whole output in the bounded mode
+};
+
+} // namespace Core
+
+#endif // OUTPUTCAPTURE_HPP
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/OutputHasher.hpp"
+
+namespace Core
+{
+
+OutputHasher::OutputHasher()
+    : strict(QCryptographicHash::Sha1), lenient(QCryptographicHash::Sha1), spilledSpaces(QCryptographicHash::Sha1)
+{
+}
+
+void OutputHasher::addData(const QByteArray &data)
+{
+    // normalize into local buffers and hash them at once, calling addData for each character is too slow
+    QByteArray strictData;
+    QByteArray lenientData;
+    strictData.reserve(data.size());
+    lenientData.reserve(data.size());
+
+    for (char c : data)
+    {
+        // replace "\r\n" and "\r" by "\n"
+        if (c == '\r')
+        {
+            lastIsCR = true;
+            c = '\n';
+        }
+        else if (c == '\n' && lastIsCR)
+        {
+            lastIsCR = false;
+            continue;
+        }
+        else
+        {
+            lastIsCR = false;
+        }
+
+        strictData.push_back(c);
+
+        if (c == '\n')
+        {
+            pendingSpaces.clear(); // trailing spaces of a line
+            if (spilled)
+            {
+                spilledSpaces.reset();
+                spilled = false;
+            }
+            ++pendingNewlines;
+        }
+        else if (c == ' ' || c == '\t' || c == '\v' || c == '\f')
+        {
+            pendingSpaces.push_back(c);
+            if (pendingSpaces.size() >= MAX_PENDING_SPACES)
+            {
+                spilledSpaces.addData(pendingSpaces);
+                pendingSpaces.clear();
+                spilled = true;
+            }
+        }
+        else
+        {
+            // the pending line breaks and spaces are followed by a non-blank character, so they matter
+            lenientData.append(QByteArray(pendingNewlines, '\n'));
+            if (spilled)
+            {
+                // A long run is replaced by a marker and its hash. It only depends on the content of the run, so the
+                // output and the expected output are hashed in the same way.
+                spilledSpaces.addData(pendingSpaces);
+                lenientData.push_back('\0');
+                lenientData.append(spilledSpaces.result());
+                spilledSpaces.reset();
+                spilled = false;
+            }
+            else
+            {
+                lenientData.append(pendingSpaces);
+            }
+            lenientData.push_back(c);
+            pendingNewlines = 0;
+            pendingSpaces.clear();
+        }
+    }
+
+    strict.addData(strictData);
+    lenient.addData(lenientData);
+}
+
+QByteArray OutputHasher::strictHash() const
+{
+    return strict.result();
+}
+
+QByteArray OutputHasher::lenientHash() const
+{
+    // the pending line breaks and spaces are at the end of the output, so they are ignored
+    return lenient.result();
+}
+
+} // namespace Core
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The OutputHasher hashes an output incrementally, so that the built-in checkers can check an output
+ * without keeping all of it in memory.
+ * The strict hash ignores the differences between "\r\n", "\r" and "\n", the same as the Strict checker.
+ * The lenient hash also ignores the trailing spaces of each line and the trailing empty lines,
+ * the same as the IgnoreTrailingSpaces checker, except that only ASCII blank characters are considered spaces.
+ * A run of at least MAX_PENDING_SPACES spaces in the middle of a line is hashed as the hash of the run, so the
+ * memory used doesn't depend on the length of the run.
+ */
+
+#ifndef OUTPUTHASHER_HPP
+#define OUTPUTHASHER_HPP
+
+#include <QCryptographicHash>
+
+namespace Core
+{
+
+class OutputHasher
+{
+  public:
+    OutputHasher();
+
+    /**
+     * @brief hash the next part of the output
+     * @param data the next part of the output, it can end anywhere, even in the middle of a line ending
+     */
+    void addData(const QByteArray &data);
+
+    /**
+     * @brief the hash used by the Strict checker
+     * @note no more data should be added after calling this
+     */
+    QByteArray strictHash() const;
+
+    /**
+     * @brief the hash used by the IgnoreTrailingSpaces checker
+     * @note no more data should be added after calling this
+     */
+    QByteArray lenientHash() const;
+
+  private:
+    static const int MAX_PENDING_SPACES = 64; // longer runs of spaces are moved into spilledSpaces
+
+    QCryptographicHash strict;
+    QCryptographicHash lenient;
+    bool lastIsCR = false;            // whether the last character is '\r', so a following '\n' is a part of "\r\n"
+    int pendingNewlines = 0;          // the line breaks not hashed yet, they are ignored if only spaces follow
+    QByteArray pendingSpaces;         // the spaces not hashed yet, they are ignored if a line break follows them
+    QCryptographicHash spilledSpaces; // the earlier part of a long run of pending spaces
+    bool spilled = false;             // whether spilledSpaces has data, i.e. the run is long
+};
+
+} // namespace Core
+
+#endif // OUTPUTHASHER_HPP
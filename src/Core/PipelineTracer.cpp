@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/PipelineTracer.hpp"
+#include "Core/ExecutionThread.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+
+namespace Core
+{
+
+struct PipelineTracer::Event
+{
+    enum Type
+    {
+        Complete, // a synchronous span, "X" in the trace
+        Async,    // an asynchronous span, a pair of "b" and "e" in the trace
+        Instant   // an instant event, "i" in the trace
+    };
+
+    Type type;
+    QString category;
+    QString name;
+    qint64 start; // in microseconds, see now()
+    qint64 end;   // the same as start for instant events
+    int thread;   // see currentThreadId()
+    QJsonObject args;
+};
+
+struct PipelineTracer::Pipeline
+{
+    int id;
+    QString name;
+    QVector<Event> events;
+    int droppedEvents = 0; // the number of events dropped because of MAX_EVENTS_PER_PIPELINE
+};
+
+QMutex PipelineTracer::mutex;
+QList<PipelineTracer::Pipeline> PipelineTracer::pipelines;
+int PipelineTracer::lastPipelineId = 0;
+QHash<Qt::HANDLE, int> PipelineTracer::threadIds;
+QStringList PipelineTracer::threadNames;
+
+PipelineTracer::Scope::Scope(int pipeline, const QString &category, const QString &name, const QJsonObject &args)
+    : pipeline(pipeline), category(category), name(name), args(args), start(pipeline == 0 ? 0 : now())
+{
+}
+
+PipelineTracer::Scope::~Scope()
+{
+    if (pipeline != 0)
+        record(pipeline, {Event::Complete, category, name, start, now(), 0, args});
+}
+
+int PipelineTracer::startPipeline(const QString &name)
+{
+    QMutexLocker locker(&mutex);
+    Pipeline pipeline;
+    pipeline.id = ++lastPipelineId;
+    pipeline.name = name;
+    pipelines.push_back(pipeline);
+    while (pipelines.size() > MAX_PIPELINES)
+        pipelines.pop_front();
+    return lastPipelineId;
+}
+
+qint64 PipelineTracer::now()
+{
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+void PipelineTracer::addSpan(int pipeline, const QString &category, const QString &name, qint64 start,
+                             const QJsonObject &args)
+{
+    if (pipeline != 0)
+        record(pipeline, {Event::Async, category, name, start, now(), 0, args});
+}
+
+void PipelineTracer::addInstant(int pipeline, const QString &category, const QString &name, const QJsonObject &args)
+{
+    if (pipeline != 0)
+    {
+        const auto time = now();
+        record(pipeline, {Event::Instant, category, name, time, time, 0, args});
+    }
+}
+
+void PipelineTracer::record(int pipeline, Event &&event)
+{
+    QMutexLocker locker(&mutex);
+
+    // the pipelines are in the order of their ids, and the latest pipelines are the most likely to be recorded
+    for (auto it = pipelines.rbegin(); it != pipelines.rend(); ++it)
+    {
+        if (it->id < pipeline)
+            return; // the pipeline is already dropped
+        if (it->id != pipeline)
+            continue;
+        if (it->events.size() >= MAX_EVENTS_PER_PIPELINE)
+        {
+            ++it->droppedEvents;
+            return;
+        }
+        event.thread = currentThreadId();
+        it->events.push_back(std::move(event));
+        return;
+    }
+}
+
+int PipelineTracer::currentThreadId()
+{
+    const auto handle = QThread::currentThreadId();
+    auto it = threadIds.constFind(handle);
+    if (it != threadIds.constEnd())
+        return *it;
+
+    auto *thread = QThread::currentThread();
+    auto name = thread->objectName();
+    if (name.isEmpty())
+    {
+        if (qApp != nullptr && thread == qApp->thread())
+            name = "GUI Thread";
+        else if (qobject_cast<ExecutionThread *>(thread) != nullptr)
+            name = "Execution Thread";
+        else
+            name = QString("Thread %1").arg(threadNames.size() + 1);
+    }
+
+    // the ids start from 1, 0 is not shown well in some trace viewers
+    threadNames.push_back(name);
+    threadIds.insert(handle, threadNames.size());
+    return threadNames.size();
+}
+
+QByteArray PipelineTracer::toTraceJson()
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonArray events;
+    int asyncId = 0;
+
+    for (const auto &pipeline : qAsConst(pipelines))
+    {
+        const int pid = pipeline.id;
+
+        QJsonObject processArgs{{"name", pipeline.name}};
+        if (pipeline.droppedEvents > 0)
+            processArgs["droppedEvents"] = pipeline.droppedEvents;
+        events.push_back(QJsonObject{{"ph", "M"}, {"name", "process_name"}, {"pid", pid}, {"args", processArgs}});
+        events.push_back(QJsonObject{
+            {"ph", "M"}, {"name", "process_sort_index"}, {"pid", pid}, {"args", QJsonObject{{"sort_index", pid}}}});
+
+        QSet<int> threads;
+        for (const auto &event : pipeline.events)
+        {
+            if (!threads.contains(event.thread))
+            {
+                threads.insert(event.thread);
+                events.push_back(QJsonObject{{"ph", "M"},
+                                             {"name", "thread_name"},
+                                             {"pid", pid},
+                                             {"tid", event.thread},
+                                             {"args", QJsonObject{{"name", threadNames[event.thread - 1]}}}});
+            }
+
+            QJsonObject object{{"cat", event.category}, {"name", event.name}, {"pid", pid},
+                               {"tid", event.thread},   {"ts", event.start},  {"args", event.args}};
+            switch (event.type)
+            {
+            case Event::Complete:
+                object["ph"] = "X";
+                object["dur"] = event.end - event.start;
+                events.push_back(object);
+                break;
+            case Event::Async:
+                // the begin and the end of an async span are matched by the category, the name and the id
+                object["ph"] = "b";
+                object["id"] = ++asyncId;
+                events.push_back(object);
+                object["ph"] = "e";
+                object["ts"] = event.end;
+                object.remove("args");
+                events.push_back(object);
+                break;
+            case Event::Instant:
+                object["ph"] = "i";
+                object["s"] = "t";
+                events.push_back(object);
+                break;
+            }
+        }
+    }
+
+    return QJsonDocument(QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}}).toJson();
+}
+
+} // namespace Core
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The PipelineTracer records what happens between pressing Compile and Run and seeing the verdicts: saving the file,
+ * writing the temporary file, compiling, starting the runners, the first byte of the outputs, the exits, compiling
+ * and running the checker, and the verdicts. Each Compile and Run (or Compile Only, Run Only) is a pipeline, and the
+ * last MAX_PIPELINES pipelines are kept in memory.
+ * The events are recorded with monotonic timestamps and the threads they happen in, from any thread, and they can be
+ * exported in the Chrome trace_event format, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * In the trace, each pipeline is shown as a process, the processes like the compiler and the runners are async spans,
+ * and the work done synchronously in a thread is a complete span.
+ */
+
+#ifndef PIPELINETRACER_HPP
+#define PIPELINETRACER_HPP
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+
+namespace Core
+{
+
+class PipelineTracer
+{
+  public:
+    static const int MAX_PIPELINES = 20;              // the number of the latest pipelines kept in memory
+    static const int MAX_EVENTS_PER_PIPELINE = 10000; // the later events of a pipeline are dropped
+
+    // a synchronous span, recorded when it's destructed
+    class Scope
+    {
+      public:
+        Scope(int pipeline, const QString &category, const QString &name, const QJsonObject &args = QJsonObject());
+        ~Scope();
+
+      private:
+        const int pipeline;
+        const QString category;
+        const QString name;
+        const QJsonObject args;
+        const qint64 start;
+    };
+
+    /**
+     * @brief start a new pipeline, the oldest one is dropped if there are more than MAX_PIPELINES
+     * @param name the name of the pipeline shown in the trace, e.g. "Compile and Run: a.cpp"
+     * @returns the id of the pipeline, which is always positive
+     */
+    static int startPipeline(const QString &name);
+
+    /**
+     * @brief the current monotonic timestamp in microseconds, used as the start of a span
+     */
+    static qint64 now();
+
+    /**
+     * @brief record an asynchronous span which ends now, e.g. the lifetime of a process
+     * @param pipeline the id of the pipeline, the span is ignored if it's 0 or the pipeline is dropped
+     * @param category the category of the span, e.g. "compiler", "runner", "checker"
+     * @param name the name of the span
+     * @param start the start of the span, returned by now()
+     * @param args the arguments shown with the span
+     */
+    static void addSpan(int pipeline, const QString &category, const QString &name, qint64 start,
+                        const QJsonObject &args = QJsonObject());
+
+    /**
+     * @brief record an instant event which happens now, e.g. the first byte of an output
+     * @note the arguments are the same as addSpan
+     */
+    static void addInstant(int pipeline, const QString &category, const QString &name,
+                           const QJsonObject &args = QJsonObject());
+
+    /**
+     * @brief the kept pipelines in the Chrome trace_event JSON format
+     */
+    static QByteArray toTraceJson();
+
+  private:
+    struct Event;
+    struct Pipeline;
+
+    /**
+     * @brief add an event to a pipeline, the thread of the event is the current thread
+     */
+    static void record(int pipeline, Event &&event);
+
+    /**
+     * @brief the id of the current thread in the trace, the name of the thread is recorded on its first event
+     * @note this should be called with mutex locked
+     */
+    static int currentThreadId();
+
+    static QMutex mutex;                     // guards the members below, the events may be recorded in any thread
+    static QList<Pipeline> pipelines;        // the latest pipelines, the oldest first
+    static int lastPipelineId;               // the id of the latest pipeline
+    static QHash<Qt::HANDLE, int> threadIds; // the ids of the threads in the trace, they are small integers
+    static QStringList threadNames;          // the names of the threads, indexed by the ids
+};
+
+} // namespace Core
+
+#endif // PIPELINETRACER_HPP
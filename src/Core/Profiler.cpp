@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/Profiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/ExecutionThread.hpp"
+#include "Core/Runner.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <generated/SettingsHelper.hpp>
+
+namespace Core
+{
+
+// the slowdown of a program under the profilers, the time limit is scaled by it
+static const int PERF_TIME_LIMIT_FACTOR = 3;
+static const int CALLGRIND_TIME_LIMIT_FACTOR = 50;
+
+// the sampling frequency of perf, in Hz
+static const int PERF_FREQUENCY = 4000;
+
+Profiler::Profiler(int index) : profilerIndex(index)
+{
+}
+
+Profiler::~Profiler()
+{
+    delete runner;
+    if (scriptProcess != nullptr)
+    {
+        scriptProcess->kill();
+        delete scriptProcess;
+    }
+}
+
+QString Profiler::compileFlags()
+{
+    return "-g -fno-omit-frame-pointer";
+}
+
+void Profiler::setFileIO(const QString &inputFileName, const QString &outputFileName)
+{
+    fileIO = true;
+    inputFile = inputFileName;
+    outputFile = outputFileName;
+}
+
+void Profiler::profile(const QString &tmpFilePath, const QString &sourceFilePath, const QString &build,
+                       const QString &args, const QString &input, int timeLimit)
+{
+    LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(build) << INFO_OF(timeLimit));
+
+    const auto error = findTool(&tool, &program);
+    if (!error.isEmpty())
+    {
+        emit profileFailed(profilerIndex, error);
+        return;
+    }
+
+    if (!dir.isValid())
+    {
+        emit profileFailed(profilerIndex, tr("Failed to create a temporary directory for the profile data"));
+        return;
+    }
+
+    fileName = QFileInfo(tmpFilePath).fileName();
+
+    QStringList launcher{program};
+    if (tool == Perf)
+    {
+        launcher << "record"
+                 << "-q"
+                 << "-F" << QString::number(PERF_FREQUENCY) << "--call-graph=fp"
+                 << "-o" << dir.filePath("perf.data") << "--";
+    }
+    else
+    {
+        launcher << "--tool=callgrind"
+                 << "--callgrind-out-file=" + dir.filePath("callgrind.out");
+    }
+
+    runner = new Runner(profilerIndex);
+    connect(runner, &Runner::runStarted, this,
+            [this](int i) { emit profileStarted(i, tool == Perf ? "perf" : "callgrind"); });
+    connect(runner, &Runner::runFinished, this, &Profiler::onRunFinished);
+    connect(runner, &Runner::failedToStartRun, this, &Profiler::profileFailed);
+    if (fileIO)
+        runner->setFileIO(inputFile, outputFile);
+    runner->setProfile(build);
+    runner->setLauncher(launcher);
+    runner->run(tmpFilePath, sourceFilePath, "C++", QString(), args, input,
+                timeLimit * (tool == Perf ? PERF_TIME_LIMIT_FACTOR : CALLGRIND_TIME_LIMIT_FACTOR));
+}
+
+void Profiler::onRunFinished(int index, const OutputBuffer &out, const OutputBuffer &err, int exitCode,
+                             qint64 timeUsed, bool tle)
+{
+    Q_UNUSED(index)
+    Q_UNUSED(out)
+
+    if (tle)
+    {
+        // the killed profiler doesn't write a complete profile
+        emit profileFailed(profilerIndex, tr("The profiled run didn't finish in %1ms").arg(timeUsed));
+        return;
+    }
+
+    if (!QFile::exists(dir.filePath(tool == Perf ? "perf.data" : "callgrind.out")))
+    {
+        emit profileFailed(profilerIndex, tr("The profiler exited with code %1 and recorded nothing:\n%2")
+                                      .arg(exitCode)
+                                      .arg(err.left(2000)));
+        return;
+    }
+
+    if (exitCode != 0)
+        LOG_WARN("The profiled program exited with code " << exitCode);
+
+    analyze();
+}
+
+void Profiler::analyze()
+{
+    if (tool == Callgrind)
+    {
+        QFile file(dir.filePath("callgrind.out"));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            emit profileFailed(profilerIndex, tr("Failed to open the callgrind output: %1").arg(file.errorString()));
+            return;
+        }
+        emitCosts(file.readAll());
+        return;
+    }
+
+    // perf resolves the source lines of the samples by the debug information, which may take a while
+    scriptProcess = new QProcess(this);
+    scriptProcess->setProgram(program);
+    scriptProcess->setArguments({"script", "-i", dir.filePath("perf.data"), "-F", "ip,sym,srcline"});
+    connect(scriptProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus) {
+                if (exitStatus != QProcess::NormalExit || exitCode != 0)
+                {
+                    emit profileFailed(profilerIndex, tr("perf script exited with code %1:\n%2")
+                                                  .arg(exitCode)
+                                                  .arg(QString::fromUtf8(scriptProcess->readAllStandardError())));
+                    return;
+                }
+                emitCosts(scriptProcess->readAllStandardOutput());
+            });
+    connect(scriptProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            emit profileFailed(profilerIndex, tr("Failed to start perf script"));
+    });
+    scriptProcess->start();
+}
+
+void Profiler::emitCosts(const QByteArray &data)
+{
+    const auto name = fileName;
+    const bool perf = tool == Perf;
+    ExecutionThread::post(
+        this, [data, name, perf] { return perf ? parsePerfScript(data, name) : parseCallgrind(data, name); },
+        [this](const QMap<int, double> &lineCosts) { emit profileFinished(profilerIndex, lineCosts); });
+}
+
+QString Profiler::findTool(Tool *tool, QString *program)
+{
+    const auto setting = SettingsHelper::getCppProfiler();
+    const auto perf = QStandardPaths::findExecutable("perf");
+    const auto valgrind = QStandardPaths::findExecutable("valgrind");
+
+    if (setting == "perf" || (setting != "callgrind" && !perf.isEmpty()))
+    {
+        // perf can't profile the programs of normal users if perf_event_paranoid is greater than 2,
+        // which is the default on some distributions, try callgrind instead when choosing automatically
+        bool restricted = false;
+        QFile paranoid("/proc/sys/kernel/perf_event_paranoid");
+        if (paranoid.open(QIODevice::ReadOnly))
+            restricted = paranoid.readAll().trimmed().toInt() > 2;
+
+        if (setting == "perf" || !restricted || valgrind.isEmpty())
+        {
+            if (perf.isEmpty())
+                return tr("perf is not found. Please install it, or choose another profiler at %1.")
+                    .arg(SettingsHelper::pathOfCppProfiler());
+            *tool = Perf;
+            *program = perf;
+            return QString();
+        }
+    }
+
+    if (valgrind.isEmpty())
+        return tr("Neither perf nor valgrind is found. Please install one of them to profile the program.");
+    *tool = Callgrind;
+    *program = valgrind;
+    return QString();
+}
+
+/**
+ * @brief whether a file in the profile is the profiled source file
+ */
+static bool isProfiledFile(const QByteArray &file, const QString &fileName)
+{
+    return !file.isEmpty() && QFileInfo(QString::fromUtf8(file)).fileName() == fileName;
+}
+
+QMap<int, double> Profiler::parseCallgrind(const QByteArray &data, const QString &fileName)
+{
+    // See https://valgrind.org/docs/manual/cl-format.html for the format.
+
+    QHash<QByteArray, QByteArray> compressedFiles;
+
+    // "(id) name" defines a compressed name, "(id)" refers to a defined one
+    const auto fileOf = [&compressedFiles](const QByteArray &spec) {
+        const auto trimmed = spec.trimmed();
+        const int close = trimmed.indexOf(')');
+        if (!trimmed.startsWith('(') || close == -1)
+            return trimmed;
+        const auto id = trimmed.left(close + 1);
+        const auto name = trimmed.mid(close + 1).trimmed();
+        if (name.isEmpty())
+            return compressedFiles.value(id);
+        compressedFiles[id] = name;
+        return name;
+    };
+
+    int positionCount = 1;        // the number of positions at the beginning of a cost line
+    int linePosition = 0;         // the index of the line number in the positions
+    QVector<qint64> positions{0}; // the positions of the last cost line, for the relative positions
+    bool functionInFile = false;  // whether the current function is in the profiled file
+    bool inFile = false;          // whether the current cost lines are in the profiled file
+    bool calleeFileSet = false;   // whether the file of the callee is given for the next call
+    bool calleeInFile = false;    // whether the callee of the next call is in the profiled file
+    bool callCost = false;        // whether the next cost line is the inclusive cost of a call
+    qint64 summary = 0, total = 0;
+    QMap<int, qint64> costs;
+
+    for (const auto &line : data.split('\n'))
+    {
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const char first = line.at(0);
+        if ((first >= '0' && first <= '9') || first == '+' || first == '-' || first == '*')
+        {
+            const auto tokens = line.simplified().split(' ');
+            if (tokens.size() < positionCount)
+                continue;
+            for (int i = 0; i < positionCount; ++i)
+            {
+                const auto &token = tokens[i];
+                if (token.startsWith('+') || token.startsWith('-'))
+                    positions[i] += token.toLongLong(nullptr, 0);
+                else if (token != "*")
+                    positions[i] = token.toLongLong(nullptr, 0);
+            }
+            const qint64 cost = tokens.size() > positionCount ? tokens[positionCount].toLongLong() : 0;
+            const int lineNumber = static_cast<int>(positions[linePosition]);
+
+            if (callCost)
+            {
+                // the costs of the functions in the profiled file are counted on their own lines
+                callCost = false;
+                if (inFile && !calleeInFile)
+                    costs[lineNumber] += cost;
+            }
+            else
+            {
+                total += cost;
+                if (inFile)
+                    costs[lineNumber] += cost;
+            }
+        }
+        else if (line.startsWith("positions:"))
+        {
+            const auto names = line.mid(10).simplified().split(' ');
+            positionCount = qMax(1, names.size());
+            linePosition = qMax(0, names.indexOf("line"));
+            positions = QVector<qint64>(positionCount, 0);
+        }
+        else if (line.startsWith("fl="))
+        {
+            functionInFile = inFile = isProfiledFile(fileOf(line.mid(3)), fileName);
+        }
+        else if (line.startsWith("fi=") || line.startsWith("fe="))
+        {
+            inFile = isProfiledFile(fileOf(line.mid(3)), fileName);
+        }
+        else if (line.startsWith("fn="))
+        {
+            inFile = functionInFile;
+        }
+        else if (line.startsWith("cfi=") || line.startsWith("cfl="))
+        {
+            calleeFileSet = true;
+            calleeInFile = isProfiledFile(fileOf(line.mid(4)), fileName);
+        }
+        else if (line.startsWith("calls="))
+        {
+            callCost = true;
+            if (!calleeFileSet)
+                calleeInFile = inFile; // the callee is in the same file as the caller if its file is not given
+            calleeFileSet = false;
+        }
+        else if (line.startsWith("summary:") || line.startsWith("totals:"))
+        {
+            summary = line.mid(line.indexOf(':') + 1).simplified().split(' ').value(0).toLongLong();
+        }
+    }
+
+    if (summary <= 0)
+        summary = total;
+
+    QMap<int, double> res;
+    if (summary <= 0)
+        return res;
+    for (auto it = costs.constBegin(); it != costs.constEnd(); ++it)
+    {
+        if (it.key() > 0 && it.value() > 0)
+            res[it.key()] = 100.0 * it.value() / summary;
+    }
+    return res;
+}
+
+QMap<int, double> Profiler::parsePerfScript(const QByteArray &data, const QString &fileName)
+{
+    // Each sample is a call chain from the innermost frame, each frame takes a line for the address and the symbol,
+    // followed by a line for the source line, e.g. "  main.cpp:12", which is "??:0" if it's unknown.
+    static const QRegularExpression sourceLine(R"(^\s*(\S.*):(\d+)(\s+\(discriminator \d+\))?\s*$)");
+
+    qint64 total = 0;
+    QMap<int, qint64> samples;
+    bool inSample = false;
+    bool counted = false; // whether the current sample is counted on a line
+
+    for (const auto &line : data.split('\n'))
+    {
+        if (line.trimmed().isEmpty())
+        {
+            inSample = false;
+            continue;
+        }
+        if (!inSample)
+        {
+            inSample = true;
+            counted = false;
+            ++total;
+        }
+        if (counted)
+            continue;
+        const auto match = sourceLine.match(QString::fromUtf8(line));
+        if (match.hasMatch() && QFileInfo(match.captured(1)).fileName() == fileName)
+        {
+            const int lineNumber = match.captured(2).toInt();
+            if (lineNumber > 0)
+            {
+                ++samples[lineNumber];
+                counted = true;
+            }
+        }
+    }
+
+    QMap<int, double> res;
+    if (total == 0)
+        return res;
+    for (auto it = samples.constBegin(); it != samples.constEnd(); ++it)
+        res[it.key()] = 100.0 * it.value() / total;
+    return res;
+}
+
+} // namespace Core
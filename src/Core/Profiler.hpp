@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Profiler runs a C++ program on a test case under a profiler, either perf (sampling) or valgrind's
+ * callgrind (instrumentation), and reports the share of the cost of each line in the source file.
+ * The cost of a line includes the cost of the library functions it calls, e.g. the STL, but not the cost of
+ * other functions in the source file, so the shares of all lines add up to at most 100%.
+ * The program should be compiled with compileFlags() added. You have to create a new Profiler for each run.
+ * The results are returned by signals.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "Core/OutputBuffer.hpp"
+#include <QMap>
+#include <QTemporaryDir>
+
+class QProcess;
+
+namespace Core
+{
+
+class Runner;
+
+class Profiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief construct a profiler
+     * @param index the index of the testcase
+     */
+    explicit Profiler(int index);
+
+    /**
+     * @brief destruct the profiler
+     * @note the program and the profiler will be killed if they're still running
+     */
+    ~Profiler() override;
+
+    /**
+     * @brief the flags added to the compile command, they keep the debug information and the frame pointers
+     */
+    static QString compileFlags();
+
+    /**
+     * @brief let the program read the input from a file and write the output to a file
+     * @note This should be called before profile().
+     */
+    void setFileIO(const QString &inputFileName, const QString &outputFileName);
+
+    /**
+     * @brief profile a C++ program on a given input
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param build the compile profile of the build to profile, see Compiler::profileOutputPath
+     * @param args the command line arguments added at the back to start the program
+     * @param input the input to the program
+     * @param timeLimit the time limit of a normal run, in milliseconds, it's scaled by the overhead of the profiler
+     * @note This should be called only once.
+     */
+    void profile(const QString &tmpFilePath, const QString &sourceFilePath, const QString &build,
+                 const QString &args, const QString &input, int timeLimit);
+
+    /**
+     * @brief get the costs of the lines from a callgrind output file
+     * @param data the content of the callgrind output file
+     * @param fileName the name of the source file, the costs in other files are not reported
+     * @returns the percentages of the total cost by the line numbers in 1-based indexing
+     */
+    static QMap<int, double> parseCallgrind(const QByteArray &data, const QString &fileName);
+
+    /**
+     * @brief get the costs of the lines from the output of "perf script -F ip,sym,srcline"
+     * @param data the output of perf script, where the samples are separated by empty lines
+     * @param fileName the name of the source file, the samples in other files are not reported
+     * @returns the percentages of the samples by the line numbers in 1-based indexing
+     * @note A sample is counted for the innermost frame of its call chain that is in the source file.
+     */
+    static QMap<int, double> parsePerfScript(const QByteArray &data, const QString &fileName);
+
+  signals:
+    /**
+     * @brief the profiled run has started
+     * @param index the index of the testcase
+     * @param tool the name of the profiler, either perf or callgrind
+     */
+    void profileStarted(int index, const QString &tool);
+
+    /**
+     * @brief the program has finished and the profile is analyzed
+     * @param index the index of the testcase
+     * @param lineCosts the percentages of the total cost by the line numbers in 1-based indexing
+     */
+    void profileFinished(int index, const QMap<int, double> &lineCosts);
+
+    /**
+     * @brief failed to profile the program
+     * @param index the index of the testcase
+     * @param error a string to describe the error
+     */
+    void profileFailed(int index, const QString &error);
+
+  private slots:
+    void onRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                       qint64 timeUsed, bool tle);
+
+  private:
+    enum Tool
+    {
+        Perf,
+        Callgrind
+    };
+
+    /**
+     * @brief choose the profiler by the settings and the installed tools
+     * @param tool the chosen profiler
+     * @param program the path to the program of the profiler
+     * @returns an error message, or an empty string on success
+     */
+    static QString findTool(Tool *tool, QString *program);
+
+    /**
+     * @brief get the costs from the recorded data, and emit the results
+     */
+    void analyze();
+
+    /**
+     * @brief parse the data in the execution thread, and emit the results in the GUI thread
+     */
+    void emitCosts(const QByteArray &data);
+
+    const int profilerIndex;           // the index of the testcase
+    Tool tool = Perf;                  // the profiler used
+    QString program;                   // the path to the program of the profiler
+    QString fileName;                  // the name of the profiled source file
+    QTemporaryDir dir;                 // holds the recorded data
+    bool fileIO = false;               // whether the program reads from and writes to files
+    QString inputFile, outputFile;     // the names of the files in the file I/O mode
+    Runner *runner = nullptr;          // runs the program under the profiler
+    QProcess *scriptProcess = nullptr; // converts the data recorded by perf to text
+};
+
+} // namespace Core
+
+#endif // PROFILER_HPP
@@ -18,11 +18,11 @@
 #include "Core/Runner.hpp"
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
-#include "Util/FileUtil.hpp"
-#include <QElapsedTimer>
+#include "Core/ExecutionThread.hpp"
+#include "Core/RunnerWorker.hpp"
+#include <QDir>
 #include <QFileInfo>
-#include <QTemporaryFile>
-#include <QTimer>
+#include <QJsonObject>
 #include <generated/SettingsHelper.hpp>
 
 namespace Core
@@ -30,30 +30,33 @@ namespace Core
 
 Runner::Runner(int index) : runnerIndex(index)
 {
-    runProcess = new QProcess();
-    connect(runProcess, &QProcess::started, this, &Runner::onStarted);
-    connect(runProcess, &QProcess::errorOccurred, this, &Runner::onErrorOccurred);
 }
 
 Runner::~Runner()
 {
-    // The order of destructions is important, runTimer is used when emitting signals
-
-    delete killTimer;
+    if (worker != nullptr)
+    {
+        if (isRunning)
+        {
+            // Kill the process if it's still running when the Runner is destructed
+            LOG_WARN("Runner at index:" << runnerIndex << " was running and forcefully killed");
+            emit runKilled(runnerIndex);
+        }
+        // The worker lives in the execution thread, the process is killed there when the worker is deleted.
+        // The queued signals from the worker are dropped because this receiver no longer exists.
+        worker->deleteLater();
+    }
 
     if (runProcess != nullptr)
     {
         if (runProcess->state() == QProcess::Running)
         {
-            // Kill the process if it's still running when the Runner is destructed
-            LOG_WARN("Runner at index:" << runnerIndex << " was running and forcefully killed");
+            LOG_WARN("Detached runner was running and forcefully killed");
             runProcess->kill();
             emit runKilled(runnerIndex);
         }
         delete runProcess;
     }
-
-    delete runTimer;
 }
 
 void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
@@ -62,8 +65,6 @@ void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, cons
     LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(sourceFilePath) << INFO_OF(lang) << INFO_OF(runCommand) << INFO_OF(args)
                                   << INFO_OF(timeLimit));
 
-    isDetachedRun = false;
-
     if (!QFile::exists(tmpFilePath)) // make sure the source file exists, this usually means the executable file exists
     {
         emit failedToStartRun(runnerIndex, tr("The source file %1 doesn't exist.").arg(tmpFilePath));
@@ -71,77 +72,140 @@ void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, cons
     }
 
     // get the command for execution
-    QStringList command = QProcess::splitCommand(getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args));
+    QStringList command =
+        QProcess::splitCommand(getCommand(tmpFilePath, sourceFilePath, lang, profile, runCommand, args));
     if (command.isEmpty())
     {
         emit failedToStartRun(runnerIndex, tr("Failed to get run command. It's probably a bug."));
         return;
     }
+    command = launcher + command;
 
-    // connect signals and set timers
+    const QString program = command.takeFirst();
 
-    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &Runner::onFinished);
-    connect(runProcess, &QProcess::readyReadStandardOutput, this, &Runner::onReadyReadStandardOutput);
-    connect(runProcess, &QProcess::readyReadStandardError, this, &Runner::onReadyReadStandardError);
-
-    QString program = command.takeFirst();
-
-    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
-
-    inputFile = new QTemporaryFile(this);
-    if (!inputFile->open())
+    if (fileIO)
     {
-        emit failedToStartRun(runnerIndex, tr("Failed to create temporary file."));
-        return;
+        for (const auto &name : {fileIOInput, fileIOOutput})
+        {
+            const auto error = fileIONameError(name);
+            if (!error.isEmpty())
+            {
+                emit failedToStartRun(runnerIndex, error);
+                return;
+            }
+        }
     }
-    Util::saveFile(inputFile->fileName(), input, "Runner Input", false);
-    runProcess->setStandardInputFile(inputFile->fileName());
 
-    killTimer = new QTimer(runProcess);
-    killTimer->setSingleShot(true);
-    killTimer->setInterval(timeLimit);
-    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
+    // The settings are read here in the GUI thread, the worker only gets plain values.
+    worker = new RunnerWorker(SettingsHelper::getOutputLengthLimit());
+    if (SettingsHelper::isBoundedOutputCapture())
+        worker->setBoundedCapture(SettingsHelper::getBoundedOutputHeadLength(),
+                                  SettingsHelper::getBoundedOutputTailLength());
+    if (fileIO)
+        worker->setFileIO(fileIOInput, fileIOOutput);
+    // the counts of a launcher, e.g. a profiler, are not the counts of the program
+    if (launcher.isEmpty() && SettingsHelper::isCountHardwareEvents())
+        worker->setHardwareCounters(true);
+    worker->setTracePipeline(tracePipeline, traceCategory, QJsonObject{{"testCase", runnerIndex + 1}});
+    worker->moveToThread(ExecutionThread::instance());
+
+    // These are queued connections, the slots are called in the GUI thread
+    connect(worker, &RunnerWorker::runStarted, this, [this] {
+        isRunning = true;
+        emit runStarted(runnerIndex);
+    });
+    connect(worker, &RunnerWorker::runFinished, this,
+            [this](const OutputBuffer &out, const OutputBuffer &err, int exitCode, qint64 timeUsed, bool tle) {
+                isRunning = false;
+                emit runFinished(runnerIndex, out, err, exitCode, timeUsed, tle);
+            });
+    connect(worker, &RunnerWorker::runCountersRead, this,
+            [this](const HardwareCounters::Counts &counts) { emit runCountersRead(runnerIndex, counts); });
+    connect(worker, &RunnerWorker::failedToStartRun, this, [this](const QString &error) {
+        isRunning = false;
+        emit failedToStartRun(runnerIndex, error);
+    });
+    connect(worker, &RunnerWorker::runOutputLimitExceeded, this,
+            [this](const QString &type) { emit runOutputLimitExceeded(runnerIndex, type); });
+
+    auto *w = worker;
+    const auto workingDir = workingDirectory(tmpFilePath, sourceFilePath, lang, profile);
+    QMetaObject::invokeMethod(
+        w,
+        [w, program, command, workingDir, input, timeLimit] {
+            w->run(program, command, workingDir, input, timeLimit); // called in the execution thread
+        },
+        Qt::QueuedConnection);
+}
 
-    runTimer = new QElapsedTimer();
+void Runner::setFileIO(const QString &inputFileName, const QString &outputFileName)
+{
+    fileIO = true;
+    fileIOInput = inputFileName;
+    fileIOOutput = outputFileName;
+}
+
+QString Runner::fileIONameError(const QString &name)
+{
+    if (name.isEmpty())
+        return tr("The file name of File I/O is empty. You can set it at %1.")
+            .arg(SettingsHelper::pathOfFileIOInputFile(true));
+    if (name.contains('/') || name.contains('\\') || name == "." || name == ".." || QDir::isAbsolutePath(name))
+        return tr("The file name of File I/O [%1] is not a plain file name. You can set it at %2.")
+            .arg(name)
+            .arg(SettingsHelper::pathOfFileIOInputFile(true));
+    return QString();
+}
+
+void Runner::setProfile(const QString &profile)
+{
+    this->profile = profile;
+}
 
-    killTimer->start();
+void Runner::setLauncher(const QStringList &launcher)
+{
+    this->launcher = launcher;
+}
 
-    runProcess->start(program, command);
+void Runner::setTracePipeline(int pipeline, const QString &category)
+{
+    tracePipeline = pipeline;
+    traceCategory = category;
 }
 
 void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                          const QString &runCommand, const QString &args)
 {
-    isDetachedRun = true;
+    runProcess = new QProcess();
+    connect(runProcess, &QProcess::started, this, &Runner::onStarted);
+    connect(runProcess, &QProcess::errorOccurred, this, &Runner::onErrorOccurred);
 
-    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
+    runProcess->setWorkingDirectory(workingDirectory(tmpFilePath, sourceFilePath, lang, profile));
+
+    auto command = getCommand(tmpFilePath, sourceFilePath, lang, profile, runCommand, args);
 
     // different steps on different OSs
 #if defined(Q_OS_MACOS)
     // use apple script on Mac OS
     runProcess->setProgram("osascript");
     runProcess->setArguments({"-l", "AppleScript"});
-    QString script = R"(tell app "Terminal" to do script ")" +
-                     getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "'") + "\"";
+    QString script = R"(tell app "Terminal" to do script ")" + command.replace("\"", "'") + "\"";
     runProcess->start();
     LOG_INFO("Running apple script\n" << script);
     runProcess->write(script.toUtf8());
     runProcess->closeWriteChannel();
 #elif defined(Q_OS_WIN)
     // use cmd on Windows
-    runProcess->start("cmd", QProcess::splitCommand(
-                                 "/C \"start cmd /C " +
-                                 getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "^\"") +
-                                 " ^& pause\""));
+    runProcess->start("cmd",
+                      QProcess::splitCommand("/C \"start cmd /C " + command.replace("\"", "^\"") + " ^& pause\""));
     LOG_INFO("CMD Arguemnts " << runProcess->arguments().join(" "));
 #elif defined(Q_OS_UNIX)
     auto terminal = SettingsHelper::getDetachedRunTerminalProgram();
     LOG_INFO("Using: " << terminal << " on UNIX");
-    auto quotedCommand = getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args);
     auto execArgs = QProcess::splitCommand(SettingsHelper::getDetachedRunTerminalArguments()) +
                     QStringList{"/bin/bash", "-c",
                                 QStringLiteral("%1 ; echo \"\n%2\" ; read -n 1")
-                                    .arg(quotedCommand)
+                                    .arg(command)
                                     .arg(tr("Program finished with exit code %1\nPress any key to exit").arg("$?"))};
     runProcess->start(terminal, execArgs);
 #else
@@ -149,74 +213,23 @@ void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePa
 #endif
 }
 
-void Runner::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
-{
-    const auto timeUsed = runTimer->isValid() ? runTimer->elapsed() : 0;
-    emit runFinished(runnerIndex, processStdout + runProcess->readAllStandardOutput(),
-                     processStderr + runProcess->readAllStandardError(), exitCode, timeUsed, timeLimitExceeded);
-}
-
 void Runner::onStarted()
 {
-    if (!isDetachedRun)
-        runTimer->start();
     emit runStarted(runnerIndex);
 }
 
-void Runner::onTimeout()
-{
-    if (runProcess->state() == QProcess::Running)
-    {
-        LOG_INFO("Process was running, and forcefully killed it because time limit was reached");
-        timeLimitExceeded = true;
-        runProcess->kill();
-    }
-}
-
-void Runner::onReadyReadStandardOutput()
-{
-    processStdout.append(runProcess->readAllStandardOutput().replace('\0', ""));
-    if (!outputLimitExceededEmitted && processStdout.length() > SettingsHelper::getOutputLengthLimit())
-    {
-        outputLimitExceededEmitted = true;
-        runProcess->kill();
-        LOG_INFO("Process was running, and forcefully killed it because stdout limit was reached");
-        emit runOutputLimitExceeded(runnerIndex, "stdout");
-    }
-}
-
-void Runner::onReadyReadStandardError()
-{
-    processStderr.append(runProcess->readAllStandardError().replace('\0', ""));
-    if (!outputLimitExceededEmitted && processStderr.length() > SettingsHelper::getOutputLengthLimit())
-    {
-        outputLimitExceededEmitted = true;
-        runProcess->kill();
-        LOG_INFO("Process was running, and forcefully killed it because stderr limit was reached");
-        emit runOutputLimitExceeded(runnerIndex, "stderr");
-    }
-}
-
 void Runner::onErrorOccurred(QProcess::ProcessError error)
 {
     if (error == QProcess::FailedToStart)
     {
-        if (isDetachedRun)
-        {
-            emit failedToStartRun(
-                runnerIndex,
-                tr("Failed to start detached execution. Please check your terminal emulator settings in %1.")
-                    .arg(SettingsHelper::pathOfDetachedRunTerminalProgram(true)));
-        }
-        else
-        {
-            emit failedToStartRun(runnerIndex, tr("Failed to start running. Please compile first."));
-        }
+        emit failedToStartRun(
+            runnerIndex, tr("Failed to start detached execution. Please check your terminal emulator settings in %1.")
+                             .arg(SettingsHelper::pathOfDetachedRunTerminalProgram(true)));
     }
 }
 
 QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
-                           const QString &runCommand, const QString &args)
+                           const QString &profile, const QString &runCommand, const QString &args)
 {
     // get the execution command by the file path and the language
     // please remember to add quotes for the paths
@@ -225,13 +238,15 @@ QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFile
 
     if (lang == "C++")
     {
-        res = QString("\"%1\" %2").arg(Compiler::outputPath(tmpFilePath, sourceFilePath, "C++")).arg(args);
+        res = QString("\"%1\" %2")
+                  .arg(Compiler::profileOutputPath(tmpFilePath, sourceFilePath, "C++", profile))
+                  .arg(args);
     }
     else if (lang == "Java")
     {
         res = QString("%1 -classpath \"%2\" %3 %4")
                   .arg(runCommand)
-                  .arg(Compiler::outputPath(tmpFilePath, sourceFilePath, "Java"))
+                  .arg(Compiler::profileOutputPath(tmpFilePath, sourceFilePath, "Java", profile))
                   .arg(SettingsHelper::getJavaClassName())
                   .arg(args);
     }
@@ -245,10 +260,13 @@ QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFile
     return res;
 }
 
-void Runner::setWorkingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang)
+QString Runner::workingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                const QString &profile)
 {
-    runProcess->setWorkingDirectory(
-        QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)).path());
+    if (profile.isEmpty())
+        return QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)).path();
+    const auto path = Compiler::profileOutputPath(tmpFilePath, sourceFilePath, lang, profile, false);
+    return lang == "Java" ? path : QFileInfo(path).path(); // the class path itself for Java
 }
 
 } // namespace Core
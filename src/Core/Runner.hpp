@@ -25,15 +25,15 @@
 #ifndef RUNNER_HPP
 #define RUNNER_HPP
 
+#include "Core/HardwareCounters.hpp"
+#include "Core/OutputBuffer.hpp"
 #include <QProcess>
 
-class QElapsedTimer;
-class QTemporaryFile;
-class QTimer;
-
 namespace Core
 {
 
+class RunnerWorker;
+
 class Runner : public QObject
 {
     Q_OBJECT
@@ -61,10 +61,50 @@ class Runner : public QObject
      * @param input the input to the program
      * @param timeLimit the maximum time for the program to run, in milliseconds
      * @note This should be called only once. Please create multiple Runners for multiple runs.
+     *       The process is driven by a RunnerWorker in the execution thread, the signals are emitted in the GUI thread.
      */
     void run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang, const QString &runCommand,
              const QString &args, const QString &input, int timeLimit);
 
+    /**
+     * @brief let the program read the input from a file and write the output to a file
+     * @param inputFileName the name of the input file, e.g. input.txt
+     * @param outputFileName the name of the output file, e.g. output.txt
+     * @note This should be called before run(), it's not used by runDetached().
+     *       run() fails if a name isn't a plain file name, see fileIONameError.
+     */
+    void setFileIO(const QString &inputFileName, const QString &outputFileName);
+
+    /**
+     * @brief check a file name used in the file I/O mode
+     * @returns the error message, or an empty string if it's a plain file name in the working directory
+     * @note empty names, path separators, absolute paths and "." or ".." are rejected, so the files are always
+     *       in the directory of the runner
+     */
+    static QString fileIONameError(const QString &name);
+
+    /**
+     * @brief run the build of a compile profile instead of the default build
+     * @param profile the name of the compile profile, see Compiler::profileOutputPath
+     * @note This should be called before run() or runDetached().
+     */
+    void setProfile(const QString &profile);
+
+    /**
+     * @brief start the program by another program, e.g. a profiler
+     * @param launcher the launcher program and its arguments, the command to run the program is appended to it
+     * @note This should be called before run(), it's not used by runDetached().
+     */
+    void setLauncher(const QStringList &launcher);
+
+    /**
+     * @brief record the stages of the run in a pipeline of the PipelineTracer
+     * @param pipeline the id of the pipeline, see PipelineTracer::startPipeline
+     * @param category the category of the spans, e.g. "runner" or "checker"
+     * @note This should be called before run(), it's not used by runDetached().
+     */
+    void setTracePipeline(int pipeline, const QString &category);
+
     /**
      * @brief run a program in a pop-up terminal
      * @param tmpFilePath the path to the temporary file which is compiled
@@ -87,13 +127,22 @@ class Runner : public QObject
     /**
      * @brief the execution has just finished
      * @param index the idnex of the testcase
-     * @param out the stdout of the program
-     * @param err the stderr of the program
+     * @param out the stdout of the program, shared instead of copied
+     * @param err the stderr of the program, shared instead of copied
      * @param exitCode the exit code of the program
      * @param timeUsed the time between the execution started and finished
      * @param tle whether the time limit is exceeded
      */
-    void runFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+    void runFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                     qint64 timeUsed, bool tle);
+
+    /**
+     * @brief the hardware events of the program are counted, it's emitted right before runFinished
+     * @param index the index of the testcase
+     * @param counts the counts of the events, see HardwareCounters
+     * @note It's not emitted if the hardware counters are not available, or the program is started by a launcher.
+     */
+    void runCountersRead(int index, const Core::HardwareCounters::Counts &counts);
 
     /**
      * @brief failed to start the execution
@@ -119,35 +168,10 @@ class Runner : public QObject
 
   private slots:
     /**
-     * @brief the process is finished
-     * @param exitCode the exit code of the process
-     * @param exitStatus the exit status of the process
-     */
-    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
-
-    /**
-     * @brief the process has just started
+     * @brief the detached process has just started
      */
     void onStarted();
 
-    /**
-     * @brief the time limit is reached
-     * @note this will kill the process if it's still running and emit runTimeout
-     */
-    void onTimeout();
-
-    /**
-     * @brief the stdout of the process updated
-     * @note kill the process if stdout is too long
-     */
-    void onReadyReadStandardOutput();
-
-    /**
-     * @brief the stderr of the process updated
-     * @note kill the process if stderr is too long
-     */
-    void onReadyReadStandardError();
-
     /**
      * @brief if the error is FailedToStart, emit failedToStartRun
      */
@@ -159,29 +183,32 @@ class Runner : public QObject
      * @param tmpFilePath the path to the temporary file which is compiled
      * @param sourceFilePath the path to the original source file
      * @param lang the language to run, one of "C++", "Java" and "Python"
+     * @param profile the compile profile of the build to run, empty for the default build
      * @param runCommand the command for running a program
      * @param args the command line arguments added at the back to start the program
      * @note this returns QString instead of QStringList because detached run needs the QString form
      */
     static QString getCommand(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
-                              const QString &runCommand, const QString &args);
+                              const QString &profile, const QString &runCommand, const QString &args);
 
     /**
-     * @brief set the working directory of runProcess
+     * @brief get the working directory of the process
      * @note the path of the executable file for C++, class path for Java, temp file path for Python
      */
-    void setWorkingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang);
-
-    const int runnerIndex;                   // the index of the testcase
-    QProcess *runProcess = nullptr;          // the process to run the program
-    QTemporaryFile *inputFile = nullptr;     // redirect stdin to this file
-    QTimer *killTimer = nullptr;             // the timer used to kill the process when the time limit is reached
-    QElapsedTimer *runTimer = nullptr;       // the timer used to measure how much time did the execution use
-    QByteArray processStdout;                // the stdout of the process
-    QByteArray processStderr;                // the stderr of the process
-    bool outputLimitExceededEmitted = false; // whether runOutputLimitExceeded is emitted or not
-    bool timeLimitExceeded = false;
-    bool isDetachedRun = false;
+    static QString workingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                    const QString &profile);
+
+    const int runnerIndex;          // the index of the testcase
+    RunnerWorker *worker = nullptr; // the worker which runs the program in the execution thread
+    bool isRunning = false;         // whether the worker has started the process and it's not finished yet
+    bool fileIO = false;            // whether the program reads from and writes to files
+    QString fileIOInput;            // the name of the input file in the file I/O mode
+    QString fileIOOutput;           // the name of the output file in the file I/O mode
+    QString profile;                // the compile profile of the build to run, empty for the default build
+    QStringList launcher;           // the program and arguments to start the program with, usually empty
+    int tracePipeline = 0;          // the pipeline to record the stages in, 0 if it's not traced
+    QString traceCategory;          // the category of the recorded spans
+    QProcess *runProcess = nullptr; // the process to run the program in a pop-up terminal
 };
 
 } // namespace Core
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RunnerWorker.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/PipelineTracer.hpp"
+#include "Util/FileUtil.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QTimer>
+
+namespace Core
+{
+
+RunnerWorker::RunnerWorker(int outputLengthLimit) : outputLengthLimit(outputLengthLimit)
+{
+    // runProcess is a child so that it's moved to the execution thread together with the worker
+    runProcess = new QProcess(this);
+    connect(runProcess, &QProcess::started, this, &RunnerWorker::onStarted);
+    connect(runProcess, &QProcess::errorOccurred, this, &RunnerWorker::onErrorOccurred);
+}
+
+RunnerWorker::~RunnerWorker()
+{
+    // The order of destructions is important, runTimer is used when emitting signals
+
+    delete killTimer;
+
+    if (runProcess->state() == QProcess::Running)
+    {
+        LOG_INFO("The process is still running, kill it");
+        disconnect(runProcess, nullptr, this, nullptr);
+        runProcess->kill();
+    }
+    delete runProcess;
+
+    delete runTimer;
+
+    delete counters;
+
+    delete sandboxDir; // remove the directory after the process is killed
+}
+
+void RunnerWorker::setBoundedCapture(int headLength, int tailLength)
+{
+    boundedCapture = true;
+    boundedHeadLength = headLength;
+    boundedTailLength = tailLength;
+    processStdout = OutputCapture(headLength, tailLength);
+    processStderr = OutputCapture(headLength, tailLength);
+}
+
+void RunnerWorker::setFileIO(const QString &inputFileName, const QString &outputFileName)
+{
+    fileIOInput = inputFileName;
+    fileIOOutput = outputFileName;
+}
+
+void RunnerWorker::setHardwareCounters(bool enabled)
+{
+    delete counters;
+    counters = enabled ? new HardwareCounters() : nullptr;
+}
+
+void RunnerWorker::setTracePipeline(int pipeline, const QString &category, const QJsonObject &args)
+{
+    tracePipeline = pipeline;
+    traceCategory = category;
+    traceArgs = args;
+}
+
+void RunnerWorker::run(const QString &program, const QStringList &arguments, const QString &workingDirectory,
+                       const QString &input, int timeLimit)
+{
+    const auto writeInputStart = PipelineTracer::now();
+
+    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &RunnerWorker::onFinished);
+    connect(runProcess, &QProcess::readyReadStandardOutput, this, &RunnerWorker::onReadyReadStandardOutput);
+    connect(runProcess, &QProcess::readyReadStandardError, this, &RunnerWorker::onReadyReadStandardError);
+
+    if (fileIOInput.isEmpty())
+    {
+        runProcess->setWorkingDirectory(workingDirectory);
+
+        inputFile = new QTemporaryFile(this);
+        if (!inputFile->open())
+        {
+            emit failedToStartRun(QCoreApplication::translate("Core::Runner", "Failed to create temporary file."));
+            return;
+        }
+        Util::saveFile(inputFile->fileName(), input, "Runner Input", false);
+        runProcess->setStandardInputFile(inputFile->fileName());
+    }
+    else
+    {
+        // Each runner has its own directory, so the runners don't overwrite each other's files.
+        // The input is written only once, directly as the input file, and it's also used as stdin.
+        sandboxDir = new QTemporaryDir();
+        if (!sandboxDir->isValid())
+        {
+            emit failedToStartRun(
+                QCoreApplication::translate("Core::Runner", "Failed to create temporary directory."));
+            return;
+        }
+        runProcess->setWorkingDirectory(sandboxDir->path());
+        const auto inputPath = sandboxDir->filePath(fileIOInput);
+        Util::saveFile(inputPath, input, "Runner Input", false);
+        runProcess->setStandardInputFile(inputPath);
+    }
+
+    killTimer = new QTimer(runProcess);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit);
+    connect(killTimer, &QTimer::timeout, this, &RunnerWorker::onTimeout);
+
+    runTimer = new QElapsedTimer();
+
+    PipelineTracer::addSpan(tracePipeline, traceCategory, "Write Input", writeInputStart, traceArgs);
+
+    killTimer->start();
+
+    spawnTraceStart = PipelineTracer::now();
+    runProcess->start(program, arguments);
+}
+
+void RunnerWorker::onFinished(int exitCode, QProcess::ExitStatus /*unused*/)
+{
+    const auto timeUsed = runTimer->isValid() ? runTimer->elapsed() : 0;
+    processStdout.append(runProcess->readAllStandardOutput());
+    processStderr.append(runProcess->readAllStandardError());
+
+    auto out = processStdout.buffer();
+    auto err = processStderr.buffer();
+
+    if (sandboxDir != nullptr && QFile::exists(sandboxDir->filePath(fileIOOutput)))
+    {
+        // In the file I/O mode, stdout is usually used for debugging, so show it together with stderr.
+        // If the output file is not created, stdout is used as the output instead.
+        if (!out.isEmpty())
+            err = OutputBuffer(out.bytes() + err.bytes());
+        out = readOutputFile();
+    }
+
+    if (counters != nullptr)
+    {
+        const auto counts = counters->read();
+        if (counts.isValid())
+            emit runCountersRead(counts);
+    }
+
+    if (tracePipeline != 0)
+    {
+        auto args = traceArgs;
+        args["exitCode"] = exitCode;
+        args["timeUsed"] = timeUsed;
+        args["tle"] = timeLimitExceeded;
+        args["stdoutBytes"] = processStdout.size();
+        args["stderrBytes"] = processStderr.size();
+        PipelineTracer::addSpan(tracePipeline, traceCategory, "Process", runTraceStart, args);
+    }
+
+    emit runFinished(out, err, exitCode, timeUsed, timeLimitExceeded);
+}
+
+OutputBuffer RunnerWorker::readOutputFile()
+{
+    const auto path = sandboxDir->filePath(fileIOOutput);
+    auto output = OutputBuffer::fromFile(path);
+
+    if (boundedCapture && output.size() > boundedHeadLength + boundedTailLength)
+    {
+        // the file is mapped, so feeding it in chunks keeps the memory usage constant
+        OutputCapture capture(boundedHeadLength, boundedTailLength);
+        const int chunkSize = 1 << 20;
+        for (int pos = 0; pos < output.size(); pos += chunkSize)
+        {
+            const int length = qMin(chunkSize, output.size() - pos);
+            capture.append(QByteArray::fromRawData(output.bytes().constData() + pos, length));
+        }
+        return capture.buffer();
+    }
+
+    if (!boundedCapture && output.size() > outputLengthLimit)
+    {
+        LOG_INFO("The output file is longer than the output length limit");
+        emit runOutputLimitExceeded(fileIOOutput);
+        return OutputBuffer(output.bytes().left(outputLengthLimit).replace('\0', ""));
+    }
+
+    if (output.bytes().contains('\0'))
+        return OutputBuffer(QByteArray(output.bytes()).replace('\0', ""));
+
+    return output;
+}
+
+void RunnerWorker::onStarted()
+{
+    runTimer->start();
+    PipelineTracer::addSpan(tracePipeline, traceCategory, "Spawn", spawnTraceStart, traceArgs);
+    runTraceStart = PipelineTracer::now();
+    if (counters != nullptr)
+        counters->attach(runProcess->processId());
+    emit runStarted();
+}
+
+void RunnerWorker::onTimeout()
+{
+    if (runProcess->state() == QProcess::Running)
+    {
+        LOG_INFO("Process was running, and forcefully killed it because time limit was reached");
+        timeLimitExceeded = true;
+        runProcess->kill();
+    }
+}
+
+void RunnerWorker::onReadyReadStandardOutput()
+{
+    traceFirstByte("stdout");
+    processStdout.append(runProcess->readAllStandardOutput());
+    if (!boundedCapture && !outputLimitExceededEmitted && processStdout.size() > outputLengthLimit)
+    {
+        outputLimitExceededEmitted = true;
+        runProcess->kill();
+        LOG_INFO("Process was running, and forcefully killed it because stdout limit was reached");
+        emit runOutputLimitExceeded("stdout");
+    }
+}
+
+void RunnerWorker::onReadyReadStandardError()
+{
+    traceFirstByte("stderr");
+    processStderr.append(runProcess->readAllStandardError());
+    if (!boundedCapture && !outputLimitExceededEmitted && processStderr.size() > outputLengthLimit)
+    {
+        outputLimitExceededEmitted = true;
+        runProcess->kill();
+        LOG_INFO("Process was running, and forcefully killed it because stderr limit was reached");
+        emit runOutputLimitExceeded("stderr");
+    }
+}
+
+void RunnerWorker::onErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+    {
+        auto args = traceArgs;
+        args["failed"] = true;
+        PipelineTracer::addSpan(tracePipeline, traceCategory, "Spawn", spawnTraceStart, args);
+        emit failedToStartRun(
+            QCoreApplication::translate("Core::Runner", "Failed to start running. Please compile first."));
+    }
+}
+
+void RunnerWorker::traceFirstByte(const QString &channel)
+{
+    if (firstByteTraced)
+        return;
+    firstByteTraced = true;
+    auto args = traceArgs;
+    args["channel"] = channel;
+    PipelineTracer::addInstant(tracePipeline, traceCategory, "First Output Byte", args);
+}
+
+} // namespace Core
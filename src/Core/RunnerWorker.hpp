@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RunnerWorker runs a program on a given input in the execution thread.
+ * It's created and owned by a Runner, which forwards its signals to the GUI thread.
+ * It doesn't read the settings, everything it needs is passed in by the Runner.
+ */
+
+#ifndef RUNNERWORKER_HPP
+#define RUNNERWORKER_HPP
+
+#include "Core/HardwareCounters.hpp"
+#include "Core/OutputCapture.hpp"
+#include <QJsonObject>
+#include <QProcess>
+
+class QElapsedTimer;
+class QTemporaryDir;
+class QTemporaryFile;
+class QTimer;
+
+namespace Core
+{
+
+class RunnerWorker : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief construct a runner worker
+     * @param outputLengthLimit the process is killed when its stdout or stderr is longer than this
+     */
+    explicit RunnerWorker(int outputLengthLimit);
+
+    /**
+     * @brief destruct the runner worker
+     * @note the process will be killed if it's still running
+     */
+    ~RunnerWorker() override;
+
+    /**
+     * @brief keep only the beginning and the end of a long output, instead of killing the process
+     * @param headLength the number of bytes to keep at the beginning of stdout and stderr
+     * @param tailLength the number of bytes to keep at the end of stdout and stderr
+     * @note This should be called before run().
+     */
+    void setBoundedCapture(int headLength, int tailLength);
+
+    /**
+     * @brief let the program read the input from a file and write the output to a file
+     * @param inputFileName the name of the input file, e.g. input.txt
+     * @param outputFileName the name of the output file, e.g. output.txt
+     * @note The program runs in its own temporary directory, so multiple runners can run at the same time.
+     *       This should be called before run().
+     */
+    void setFileIO(const QString &inputFileName, const QString &outputFileName);
+
+    /**
+     * @brief count the hardware events of the process, see HardwareCounters
+     * @note This should be called before run().
+     */
+    void setHardwareCounters(bool enabled);
+
+    /**
+     * @brief record the stages of the run in a pipeline of the PipelineTracer
+     * @param pipeline the id of the pipeline, 0 if it's not traced
+     * @param category the category of the spans
+     * @param args the arguments added to the spans, e.g. the index of the test case
+     * @note This should be called before run().
+     */
+    void setTracePipeline(int pipeline, const QString &category, const QJsonObject &args);
+
+    /**
+     * @brief run a program on a given input
+     * @param program the program to start
+     * @param arguments the arguments passed to the program
+     * @param workingDirectory the working directory of the process
+     * @param input the input to the program
+     * @param timeLimit the maximum time for the program to run, in milliseconds
+     * @note This should be called in the execution thread, and only once.
+     */
+    void run(const QString &program, const QStringList &arguments, const QString &workingDirectory,
+             const QString &input, int timeLimit);
+
+  signals:
+    void runStarted();
+
+    void runFinished(const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode, qint64 timeUsed,
+                     bool tle);
+
+    void failedToStartRun(const QString &error);
+
+    /**
+     * @brief the hardware events of the process are counted, it's emitted right before runFinished
+     */
+    void runCountersRead(const Core::HardwareCounters::Counts &counts);
+
+    void runOutputLimitExceeded(const QString &type);
+
+  private slots:
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onStarted();
+
+    /**
+     * @brief the time limit is reached
+     * @note this will kill the process if it's still running
+     */
+    void onTimeout();
+
+    /**
+     * @brief the stdout of the process updated
+     * @note kill the process if stdout is too long
+     */
+    void onReadyReadStandardOutput();
+
+    /**
+     * @brief the stderr of the process updated
+     * @note kill the process if stderr is too long
+     */
+    void onReadyReadStandardError();
+
+    /**
+     * @brief if the error is FailedToStart, emit failedToStartRun
+     */
+    void onErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    /**
+     * @brief read the output file written by the program in the file I/O mode
+     * @note the output length limit and the bounded capture are applied to it as well
+     */
+    OutputBuffer readOutputFile();
+
+    /**
+     * @brief record the first byte of the output in the pipeline, if it's not recorded yet
+     * @param channel either stdout or stderr
+     */
+    void traceFirstByte(const QString &channel);
+
+    const int outputLengthLimit;             // the maximum length of stdout and stderr if not bounded
+    QProcess *runProcess = nullptr;          // the process to run the program
+    QTemporaryFile *inputFile = nullptr;     // redirect stdin to this file
+    QTimer *killTimer = nullptr;             // the timer used to kill the process when the time limit is reached
+    QElapsedTimer *runTimer = nullptr;       // the timer used to measure how much time did the execution use
+    OutputCapture processStdout;             // the stdout of the process
+    OutputCapture processStderr;             // the stderr of the process
+    bool boundedCapture = false;             // whether the output is bounded instead of limited
+    int boundedHeadLength = 0;               // see setBoundedCapture
+    int boundedTailLength = 0;               // see setBoundedCapture
+    QString fileIOInput;                     // the name of the input file, empty if not in the file I/O mode
+    QString fileIOOutput;                    // the name of the output file, empty if not in the file I/O mode
+    QTemporaryDir *sandboxDir = nullptr;     // the working directory in the file I/O mode
+    bool outputLimitExceededEmitted = false; // whether runOutputLimitExceeded is emitted or not
+    bool timeLimitExceeded = false;
+    HardwareCounters *counters = nullptr;    // counts the hardware events of the process, null if it's disabled
+    int tracePipeline = 0;                   // see setTracePipeline
+    QString traceCategory;                   // see setTracePipeline
+    QJsonObject traceArgs;                   // see setTracePipeline
+    qint64 spawnTraceStart = 0;              // when the process is requested to start, see PipelineTracer::now
+    qint64 runTraceStart = 0;                // when the process has started, see PipelineTracer::now
+    bool firstByteTraced = false;            // whether the first byte of the output is recorded
+};
+
+} // namespace Core
+
+#endif // RUNNERWORKER_HPP
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/SanitizerReport.hpp"
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace Core
+{
+
+/**
+ * @brief whether a file in a stack trace belongs to the sanitizer runtime or the system, instead of the user's code
+ */
+static bool isSystemFile(const QString &file)
+{
+    return file.contains("libsanitizer") || file.contains("compiler-rt") || file.startsWith("/usr/") ||
+           file.startsWith("/lib");
+}
+
+QString SanitizerReport::toString() const
+{
+    QString location;
+    if (!file.isEmpty())
+    {
+        location = file;
+        if (line > 0)
+            location += QString(":%1").arg(line);
+        if (column > 0)
+            location += QString(":%1").arg(column);
+        location += ": ";
+    }
+    return QString("%1%2: %3").arg(location, sanitizer, message);
+}
+
+QVector<SanitizerReport> SanitizerReport::parse(const QString &err)
+{
+    // ==4242==ERROR: AddressSanitizer: heap-buffer-overflow on address 0x602000000014 at pc ...
+    static const QRegularExpression errorRegex(R"(^==\d+==\s*ERROR: (\w+Sanitizer): (.+)$)");
+    // sol.cpp:7:12: runtime error: signed integer overflow: 2147483647 + 1 cannot be represented in type 'int'
+    static const QRegularExpression runtimeErrorRegex(R"(^(.+?):(\d+):(\d+): runtime error: (.+)$)");
+    //     #1 0x55d1c0a0b1c2 in main /tmp/cpeditor/sol.cpp:6:10
+    static const QRegularExpression frameRegex(R"(^\s*#\d+ 0x[0-9a-fA-F]+ in .+ (\S+?):(\d+)(?::(\d+))?$)");
+
+    QVector<SanitizerReport> reports;
+    bool locating = false; // whether the location of the last report is being searched in its stack trace
+
+    for (auto line : err.split('\n'))
+    {
+        if (line.endsWith('\r'))
+            line.chop(1);
+
+        auto match = errorRegex.match(line);
+        if (match.hasMatch())
+        {
+            SanitizerReport report;
+            report.sanitizer = match.captured(1);
+            report.message = match.captured(2).trimmed();
+            reports.push_back(report);
+            locating = true;
+            continue;
+        }
+
+        match = runtimeErrorRegex.match(line);
+        if (match.hasMatch())
+        {
+            SanitizerReport report;
+            report.sanitizer = "UndefinedBehaviorSanitizer";
+            report.file = match.captured(1);
+            report.line = match.captured(2).toInt();
+            report.column = match.captured(3).toInt();
+            report.message = match.captured(4).trimmed();
+            reports.push_back(report);
+            locating = false;
+            continue;
+        }
+
+        if (!locating)
+            continue;
+
+        if (line.startsWith("SUMMARY:")) // the end of the stack traces of the report
+        {
+            locating = false;
+            continue;
+        }
+
+        match = frameRegex.match(line);
+        if (match.hasMatch() && !isSystemFile(match.captured(1)))
+        {
+            auto &report = reports.back();
+            report.file = match.captured(1);
+            report.line = match.captured(2).toInt();
+            report.column = match.captured(3).toInt(); // 0 if it's not captured
+            locating = false;
+        }
+    }
+
+    return reports;
+}
+
+} // namespace Core
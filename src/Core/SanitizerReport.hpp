@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * A SanitizerReport is an error reported by AddressSanitizer, UndefinedBehaviorSanitizer or LeakSanitizer
+ * in the stderr of a program compiled with -fsanitize. The reports are parsed from the text printed by the
+ * sanitizers, so they are best effort: unknown formats are ignored instead of treated as errors.
+ */
+
+#ifndef SANITIZERREPORT_HPP
+#define SANITIZERREPORT_HPP
+
+#include <QString>
+#include <QVector>
+
+namespace Core
+{
+
+struct SanitizerReport
+{
+    QString sanitizer; // the name of the sanitizer, e.g. AddressSanitizer
+    QString message;   // the description of the error, e.g. heap-buffer-overflow on address 0x602000000014
+    QString file;      // the source file where the error occurred, empty if it's unknown
+    int line = 0;      // the line number in the file, 0 if it's unknown
+    int column = 0;    // the column number in the file, 0 if it's unknown
+
+    /**
+     * @brief a one-line description of the report, in the format of compiler diagnostics
+     */
+    QString toString() const;
+
+    /**
+     * @brief parse the reports in the stderr of a program
+     * @param err the stderr of the program
+     * @returns the reports in the order they are printed
+     */
+    static QVector<SanitizerReport> parse(const QString &err);
+};
+
+} // namespace Core
+
+#endif // SANITIZERREPORT_HPP
@@ -18,16 +18,24 @@
 #include "Core/SessionManager.hpp"
 #include "../../ui/ui_appwindow.h"
 #include "Core/EventLogger.hpp"
+#include "Core/StallDetector.hpp"
+#include "Editor/CodeEditor.hpp"
 #include "Util/FileUtil.hpp"
 #include "appwindow.hpp"
 #include "generated/portable.hpp"
 #include "mainwindow.hpp"
+#include <QCborArray>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QProgressDialog>
+#include <QSignalBlocker>
+#include <QTextDocument>
+#include <QThreadPool>
 #include <QTimer>
+#include <QUuid>
 
 namespace Core
 {
@@ -37,33 +45,76 @@ const static QStringList sessionFileLocations = {
 #endif
     "$APPCONFIG/cp_editor_session.json"};
 
-SessionManager::SessionManager(AppWindow *appwindow) : QObject(appwindow), app(appwindow)
+// the directories of the session stores, the single file above is the format before the store
+const static QStringList sessionStoreLocations = {
+#ifdef PORTABLE_VERSION
+    "$BINARY/cp_editor_session",
+#endif
+    "$APPCONFIG/cp_editor_session"};
+
+SessionManager::SessionManager(AppWindow *appwindow)
+    : QObject(appwindow), app(appwindow),
+      store(std::make_shared<SessionStore>(Util::configFilePath(sessionStoreLocations[0])))
 {
     timer = new QTimer(this);
 
+    // The session is written in its own thread, because compressing and writing large test cases in the execution
+    // thread would delay the runners and inflate the measured time. A single thread keeps the flushes in order.
+    ioPool = new QThreadPool(this);
+    ioPool->setMaxThreadCount(1);
+    ioPool->setExpiryTimeout(-1);
+
     timer->setInterval(10000);
     connect(timer, &QTimer::timeout, this, &SessionManager::updateSession, Qt::DirectConnection);
+
+    connect(app->ui->tabWidget, &QTabWidget::currentChanged, this, [this] {
+        // the tab which was current may be changed since the last update, e.g. by moving the cursor
+        markDirty(currentWindow);
+        currentWindow = app->currentWindow();
+        markDirty(currentWindow);
+    });
 }
 
 void SessionManager::restoreSession(const QString &path)
 {
     LOG_INFO(INFO_OF(path));
+    StallDetector::Operation operation("Restore Session");
 
-    auto text = Util::readFile(path);
-
-    if (text.isNull())
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
     {
         LOG_ERR(QString("Failed to load session from [%1]").arg(path));
         return;
     }
 
-    auto document = QJsonDocument::fromJson(text.toUtf8());
-
-    if (document.isNull())
+    // The session is either in CBOR (the store and the binary export) or in JSON (the older versions and the JSON
+    // export). CBOR is decoded from the file as a stream, JSON is parsed from the bytes without decoding them first.
+    QCborMap session;
+    const bool isCbor = SessionStore::isCbor(&file);
+    if (isCbor)
     {
-        LOG_ERR("Invalid session JSON: " << text);
-        return;
+        bool ok = false;
+        const auto value = SessionStore::readCbor(&file, &ok);
+        if (!ok || !value.isMap())
+        {
+            LOG_ERR("Invalid session CBOR " << INFO_OF(path));
+            return;
+        }
+        session = value.toMap();
+    }
+    else
+    {
+        const auto document = QJsonDocument::fromJson(file.readAll());
+        if (!document.isObject())
+        {
+            LOG_ERR("Invalid session JSON " << INFO_OF(path));
+            return;
+        }
+        session = QCborMap::fromJsonObject(document.object());
     }
+    file.close();
+
+    LOG_INFO("Session read " << INFO_OF(session.value(QLatin1String("version")).toInteger()) << BOOL_INFO_OF(isCbor));
 
     app->setInitialized(false);
 
@@ -74,10 +125,15 @@ void SessionManager::restoreSession(const QString &path)
         delete tmp;
     }
 
-    QJsonObject object = document.object();
+    const int currentIndex = static_cast<int>(session.value(QLatin1String("currentIndex")).toInteger());
+    const auto tabs = session.value(QLatin1String("tabs")).toArray();
 
-    const int currentIndex = object["currentIndex"].toInt();
-    auto tabs = object["tabs"].toArray();
+    // A tab is either a status (the single file format) or the id of a record in the store of the file. The records
+    // of our own store are reused, so the restored tabs are not written again until they are changed, unless the
+    // store is in the JSON format of version 2, whose records are rewritten in CBOR.
+    const auto directory = QFileInfo(path).absolutePath();
+    const bool isOwnStore = QFileInfo(directory) == QFileInfo(store->directory());
+    QList<MainWindow *> reusedRecords;
 
     QProgressDialog progressDialog(app);
     progressDialog.setWindowModality(Qt::WindowModal);
@@ -89,26 +145,77 @@ void SessionManager::restoreSession(const QString &path)
     auto oldSize = app->size();
     app->setUpdatesEnabled(false);
 
-    for (auto &&tab : tabs)
     {
-        if (progressDialog.wasCanceled())
-            break;
-        auto status = MainWindow::EditorStatus(tab.toObject().toVariantMap());
-        app->openTab(status);
-        progressDialog.setLabelText(QString(tr("Restoring: [%1]")).arg(app->currentWindow()->getTabTitle(true, false)));
-        progressDialog.setValue(progressDialog.value() + 1);
+        // The tabs are opened with deferred statuses and without activating them, so only their properties are
+        // loaded here. The code and the test cases of a tab are loaded when it's activated, in onTabChanged.
+        const QSignalBlocker blocker(app->ui->tabWidget);
+
+        for (const auto &tab : tabs)
+        {
+            if (progressDialog.wasCanceled())
+                break;
+            if (tab.isString())
+            {
+                bool ok = false;
+                const auto record = SessionStore::readRecord(directory, tab.toString(), &ok);
+                if (!ok)
+                    continue;
+                app->openTab(MainWindow::EditorStatus(record), false, nullptr, true);
+                if (isOwnStore)
+                {
+                    recordIds[app->currentWindow()] = tab.toString();
+                    if (isCbor)
+                        reusedRecords.push_back(app->currentWindow());
+                }
+            }
+            else
+            {
+                auto status = MainWindow::EditorStatus(tab.toMap().toVariantMap());
+                app->openTab(status, false, nullptr, true);
+            }
+            progressDialog.setLabelText(
+                QString(tr("Restoring: [%1]")).arg(app->currentWindow()->getTabTitle(true, false)));
+            progressDialog.setValue(progressDialog.value() + 1);
+        }
+
+        if (currentIndex >= 0 && currentIndex < app->ui->tabWidget->count())
+            app->ui->tabWidget->setCurrentIndex(currentIndex);
     }
 
     app->setUpdatesEnabled(true);
     app->repaint();
     app->resize(oldSize);
 
-    if (currentIndex >= 0 && currentIndex < app->ui->tabWidget->count())
-        app->ui->tabWidget->setCurrentIndex(currentIndex);
+    // the unchanged records are not written again
+    for (auto *window : reusedRecords)
+        dirtyWindows.remove(window);
+
+    // load the current tab, the signal is blocked when it becomes the current tab
+    currentWindow = app->currentWindow();
+    app->onTabChanged(app->ui->tabWidget->currentIndex());
 
     app->setInitialized();
 }
 
+void SessionManager::trackWindow(MainWindow *window)
+{
+    if (recordIds.contains(window))
+        return;
+
+    recordIds[window] = QString::fromLatin1(QUuid::createUuid().toRfc4122().toHex());
+    dirtyWindows.insert(window);
+
+    auto mark = [this, window] { markDirty(window); };
+    connect(window->getEditor()->document(), &QTextDocument::contentsChanged, this, mark);
+    connect(window, &MainWindow::editorFileChanged, this, mark);
+    connect(window, &MainWindow::editorLanguageChanged, this, mark);
+    connect(window, &MainWindow::fileSaved, this, mark);
+    connect(window, &QObject::destroyed, this, [this, window] {
+        recordIds.remove(window);
+        dirtyWindows.remove(window);
+    });
+}
+
 void SessionManager::setAutoUpdateSession(bool shouldAutoUpdate)
 {
     if (shouldAutoUpdate)
@@ -138,8 +245,31 @@ QString SessionManager::currentSessionText()
     return QJsonDocument(json).toJson();
 }
 
+QByteArray SessionManager::currentSessionData()
+{
+    QCborMap session;
+    session[QLatin1String("version")] = SessionStore::VERSION;
+    session[QLatin1String("currentIndex")] = app->ui->tabWidget->currentIndex();
+
+    QCborArray tabs;
+    for (int t = 0; t < app->ui->tabWidget->count(); t++)
+        tabs.append(QCborMap::fromVariantMap(app->windowAt(t)->toStatus().toMap()));
+    session[QLatin1String("tabs")] = tabs;
+
+    return SessionStore::toCbor(session);
+}
+
 QString SessionManager::lastSessionPath()
 {
+    for (const auto &location : sessionStoreLocations)
+    {
+        const auto directory = Util::configFilePath(location);
+        for (const auto &path : {SessionStore::indexPath(directory), SessionStore::legacyIndexPath(directory)})
+        {
+            if (QFile::exists(path))
+                return path;
+        }
+    }
     return Util::firstExistingConfigPath(sessionFileLocations);
 }
 
@@ -150,6 +280,80 @@ void SessionManager::saveSession(const QString &sessionText)
 
 void SessionManager::updateSession()
 {
-    saveSession(currentSessionText());
+    StallDetector::Operation operation("Take Session Snapshot");
+    store->submit(takeSnapshot());
+    auto store = this->store;
+    ioPool->start([store] {
+        LOG_WARN_IF(!store->flush(), "Failed to save the session, it will be retried in the next update");
+    });
+}
+
+void SessionManager::hibernate(MainWindow *window)
+{
+    if (!window->canHibernate())
+        return;
+
+    trackWindow(window);
+    const auto id = recordIds[window];
+    const auto status = window->toStatus().toMap();
+    // the status is written now, a change after this marks the tab dirty again and cancels the hibernation
+    dirtyWindows.remove(window);
+
+    auto store = this->store;
+    QPointer<MainWindow> guard(window);
+    ioPool->start([this, store, id, status, guard] {
+        const bool written = store->writeTab(id, status);
+        QMetaObject::invokeMethod(
+            this,
+            [this, store, id, written, guard] {
+                if (!guard)
+                    return;
+                if (!written)
+                {
+                    LOG_WARN("Failed to write the hibernated tab " << INFO_OF(id));
+                    markDirty(guard);
+                    return;
+                }
+                if (dirtyWindows.contains(guard) || guard == app->currentWindow() || !guard->canHibernate())
+                    return;
+                const auto usage = guard->memoryUsage();
+                guard->hibernate(store->directory(), id);
+                dirtyWindows.remove(guard); // clearing the editor is not a change of the tab
+                emit tabHibernated(guard, usage - guard->memoryUsage());
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void SessionManager::updateSessionAndWait()
+{
+    StallDetector::Operation operation("Save Session");
+    store->submit(takeSnapshot());
+    LOG_ERR_IF(!store->flush(), "Failed to save the session");
+}
+
+SessionStore::Snapshot SessionManager::takeSnapshot()
+{
+    markDirty(app->currentWindow());
+
+    SessionStore::Snapshot snapshot;
+    snapshot.currentIndex = app->ui->tabWidget->currentIndex();
+    for (int t = 0; t < app->ui->tabWidget->count(); t++)
+    {
+        auto *window = app->windowAt(t);
+        trackWindow(window); // in case it's not tracked when it's opened
+        const auto id = recordIds[window];
+        snapshot.tabs.push_back(id);
+        if (dirtyWindows.contains(window))
+            snapshot.changedTabs[id] = window->toStatus().toMap();
+    }
+    dirtyWindows.clear();
+    return snapshot;
+}
+
+void SessionManager::markDirty(MainWindow *window)
+{
+    if (window != nullptr)
+        dirtyWindows.insert(window);
 }
 } // namespace Core
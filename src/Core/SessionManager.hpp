@@ -18,9 +18,16 @@
 #ifndef SESSION_MANAGER_HPP
 #define SESSION_MANAGER_HPP
 
+#include "Core/SessionStore.hpp"
+#include <QHash>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <memory>
 
 class AppWindow;
+class MainWindow;
+class QThreadPool;
 class QTimer;
 
 namespace Core
@@ -38,18 +45,65 @@ class SessionManager : public QObject
 
     void setAutoUpdateDuration(int duration);
 
+    /**
+     * @brief track the changes of a tab, only the changed tabs are saved by updateSession
+     * @note this should be called when a tab is opened, the tab is forgotten when it's destroyed
+     */
+    void trackWindow(MainWindow *window);
+
+    /**
+     * @brief the whole session in a single JSON document, used for exporting the session
+     */
     QString currentSessionText();
 
+    /**
+     * @brief the whole session in a single CBOR document, which is smaller and faster to load than JSON
+     */
+    QByteArray currentSessionData();
+
+    /**
+     * @brief write the status of a tab to the store in the session I/O thread, and then hibernate it
+     * @note the tab is not hibernated if it's changed or activated before the status is written
+     */
+    void hibernate(MainWindow *window);
+
     static QString lastSessionPath();
 
     static void saveSession(const QString &sessionText);
 
+  signals:
+    /**
+     * @brief a tab is hibernated by hibernate()
+     * @param freed the estimated memory freed in bytes
+     */
+    void tabHibernated(MainWindow *window, qint64 freed);
+
   public slots:
+    /**
+     * @brief save the tabs changed since the last update, the files are written in the session I/O thread
+     */
     void updateSession();
 
+    /**
+     * @brief save the tabs changed since the last update, and wait until the files are written, e.g. before quitting
+     */
+    void updateSessionAndWait();
+
   private:
+    /**
+     * @brief the order of the tabs and the statuses of the changed tabs, the tabs are marked unchanged after this
+     */
+    SessionStore::Snapshot takeSnapshot();
+
+    void markDirty(MainWindow *window);
+
     QTimer *timer = nullptr;
     AppWindow *app = nullptr;
+    QThreadPool *ioPool = nullptr;         // a single thread writing the session, apart from the execution thread
+    std::shared_ptr<SessionStore> store;   // shared with the flushes in the session I/O thread
+    QHash<MainWindow *, QString> recordIds; // the record ids of the tabs in the store
+    QSet<MainWindow *> dirtyWindows;        // the tabs changed since the last snapshot
+    QPointer<MainWindow> currentWindow;     // the current tab, which is changed by the user without any signal
 };
 } // namespace Core
 
@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/SessionStore.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCborArray>
+#include <QCborStreamReader>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+namespace Core
+{
+
+// test cases with at least this number of characters are stored as blobs
+static const int BLOB_THRESHOLD = 16 * 1024;
+
+// test cases are mostly digits and spaces, the fastest level already shrinks them several times
+static const int BLOB_COMPRESSION_LEVEL = 1;
+
+// the encoding of the self-describe tag (55799), which starts every CBOR file of the store
+static const QByteArray CBOR_SIGNATURE("\xd9\xd9\xf7");
+
+// the keys of the test case lists in EditorStatus, their large items are stored as blobs
+static const QStringList BLOB_KEYS = {"input", "expected"};
+
+SessionStore::SessionStore(const QString &directory) : storeDirectory(directory)
+{
+}
+
+QString SessionStore::directory() const
+{
+    return storeDirectory;
+}
+
+QString SessionStore::indexPath(const QString &directory)
+{
+    return QDir(directory).filePath("session.cbor");
+}
+
+QString SessionStore::legacyIndexPath(const QString &directory)
+{
+    return QDir(directory).filePath("session.json");
+}
+
+QByteArray SessionStore::toCbor(const QCborValue &value)
+{
+    return QCborValue(QCborKnownTags::Signature, value).toCbor();
+}
+
+bool SessionStore::isCbor(QIODevice *device)
+{
+    return device->peek(CBOR_SIGNATURE.size()) == CBOR_SIGNATURE;
+}
+
+QCborValue SessionStore::readCbor(QIODevice *device, bool *ok)
+{
+    QCborStreamReader reader(device);
+    auto value = QCborValue::fromCbor(reader);
+    *ok = reader.lastError() == QCborError::NoError;
+    LOG_ERR_IF(!*ok, "Invalid CBOR " << INFO_OF(reader.lastError().toString()));
+    if (value.isTag() && value.tag() == QCborTag(QCborKnownTags::Signature))
+        return value.taggedValue();
+    return value;
+}
+
+void SessionStore::submit(const Snapshot &snapshot)
+{
+    QMutexLocker locker(&pendingMutex);
+    for (auto it = snapshot.changedTabs.cbegin(); it != snapshot.changedTabs.cend(); ++it)
+        pending.changedTabs[it.key()] = it.value();
+    pending.tabs = snapshot.tabs;
+    pending.currentIndex = snapshot.currentIndex;
+    hasPending = true;
+}
+
+bool SessionStore::flush()
+{
+    QMutexLocker writeLocker(&writeMutex);
+
+    Snapshot snapshot;
+    {
+        QMutexLocker locker(&pendingMutex);
+        if (!hasPending)
+            return true;
+        snapshot = pending;
+        pending = Snapshot();
+        hasPending = false;
+    }
+
+    if (snapshot.changedTabs.isEmpty() && snapshot.tabs == writtenTabs &&
+        snapshot.currentIndex == writtenCurrentIndex)
+        return true;
+
+    QMap<QString, QVariantMap> failed;
+    bool indexWritten = false;
+
+    const QDir dir(storeDirectory);
+    if (!QDir().mkpath(dir.filePath("tabs")) || !QDir().mkpath(dir.filePath("blobs")))
+    {
+        LOG_ERR("Failed to create the session directory " << INFO_OF(storeDirectory));
+        failed = snapshot.changedTabs;
+    }
+    else
+    {
+        for (auto it = snapshot.changedTabs.cbegin(); it != snapshot.changedTabs.cend(); ++it)
+        {
+            // the tab may be closed after the snapshot is submitted
+            if (snapshot.tabs.contains(it.key()) && !writeRecord(it.key(), it.value()))
+                failed.insert(it.key(), it.value());
+        }
+
+        QCborMap index;
+        index[QLatin1String("version")] = VERSION;
+        index[QLatin1String("currentIndex")] = snapshot.currentIndex;
+        index[QLatin1String("tabs")] = QCborArray::fromStringList(snapshot.tabs);
+        indexWritten = writeFile(indexPath(storeDirectory), toCbor(index));
+        if (indexWritten && QFile::exists(legacyIndexPath(storeDirectory)))
+            QFile::remove(legacyIndexPath(storeDirectory));
+    }
+
+    if (indexWritten)
+    {
+        writtenTabs = snapshot.tabs;
+        writtenCurrentIndex = snapshot.currentIndex;
+        if (failed.isEmpty())
+            collectGarbage(snapshot.tabs);
+    }
+
+    LOG_INFO("Session saved " << INFO_OF(snapshot.tabs.size()) << INFO_OF(snapshot.changedTabs.size())
+                              << INFO_OF(failed.size()) << BOOL_INFO_OF(indexWritten));
+
+    if (failed.isEmpty() && indexWritten)
+        return true;
+
+    // keep the failed changes for the next flush, unless they are replaced by newer ones
+    QMutexLocker locker(&pendingMutex);
+    for (auto it = failed.cbegin(); it != failed.cend(); ++it)
+    {
+        if (!pending.changedTabs.contains(it.key()))
+            pending.changedTabs.insert(it.key(), it.value());
+    }
+    if (!hasPending)
+    {
+        pending.tabs = snapshot.tabs;
+        pending.currentIndex = snapshot.currentIndex;
+        hasPending = true;
+    }
+    return false;
+}
+
+bool SessionStore::writeTab(const QString &id, const QVariantMap &status)
+{
+    QMutexLocker writeLocker(&writeMutex);
+
+    {
+        // an unwritten status of the tab is older, it must not replace this one in the next flush
+        QMutexLocker locker(&pendingMutex);
+        pending.changedTabs.remove(id);
+    }
+
+    const QDir dir(storeDirectory);
+    if (!QDir().mkpath(dir.filePath("tabs")) || !QDir().mkpath(dir.filePath("blobs")))
+    {
+        LOG_ERR("Failed to create the session directory " << INFO_OF(storeDirectory));
+        return false;
+    }
+    return writeRecord(id, status);
+}
+
+QCborMap SessionStore::readRecordFile(const QString &directory, const QString &id, bool *ok)
+{
+    *ok = false;
+
+    static const QRegularExpression idRegex("^[0-9a-zA-Z-]+$");
+    if (!idRegex.match(id).hasMatch())
+    {
+        LOG_ERR("Invalid session record id " << INFO_OF(id));
+        return QCborMap();
+    }
+
+    const QDir dir(directory);
+    QFile file(dir.filePath("tabs/" + id + ".cbor"));
+    if (!file.exists())
+    {
+        // written by version 2 of the store
+        file.setFileName(dir.filePath("tabs/" + id + ".json"));
+    }
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LOG_ERR("Failed to open the session record " << INFO_OF(file.fileName()));
+        return QCborMap();
+    }
+
+    QCborValue record;
+    if (isCbor(&file))
+    {
+        record = readCbor(&file, ok);
+    }
+    else
+    {
+        const auto document = QJsonDocument::fromJson(file.readAll());
+        *ok = document.isObject();
+        record = QCborMap::fromJsonObject(document.object());
+    }
+
+    if (!*ok || !record.isMap())
+    {
+        *ok = false;
+        LOG_ERR("Invalid session record " << INFO_OF(file.fileName()));
+        return QCborMap();
+    }
+    return record.toMap();
+}
+
+// the file name of a blob referred by a record, the blobs of version 2 of the store are not compressed
+static QString blobName(const QCborMap &reference)
+{
+    const auto hash = reference.value(QLatin1String("blob")).toString();
+    if (reference.value(QLatin1String("compression")).toString() == "zlib")
+        return hash + ".z";
+    return hash;
+}
+
+QVariantMap SessionStore::readRecord(const QString &directory, const QString &id, bool *ok)
+{
+    auto record = readRecordFile(directory, id, ok);
+    if (!*ok)
+        return QVariantMap();
+
+    const QDir dir(directory);
+    QMap<QString, QStringList> lists;
+    for (const auto &key : BLOB_KEYS)
+    {
+        for (const auto &value : record.value(key).toArray())
+        {
+            if (!value.isMap())
+            {
+                lists[key].push_back(value.toString());
+                continue;
+            }
+            const auto reference = value.toMap();
+            QFile blob(dir.filePath("blobs/" + blobName(reference)));
+            if (!blob.open(QIODevice::ReadOnly))
+            {
+                LOG_ERR("Failed to open the session blob " << INFO_OF(blob.fileName()));
+                lists[key].push_back(QString());
+                continue;
+            }
+            auto bytes = blob.readAll();
+            if (reference.contains(QLatin1String("compression")))
+            {
+                bytes = qUncompress(bytes);
+                LOG_ERR_IF(bytes.isEmpty(), "Failed to uncompress the session blob " << INFO_OF(blob.fileName()));
+            }
+            lists[key].push_back(QString::fromUtf8(bytes));
+        }
+        record.remove(key);
+    }
+
+    auto status = record.toVariantMap();
+    for (auto it = lists.cbegin(); it != lists.cend(); ++it)
+        status[it.key()] = it.value();
+    return status;
+}
+
+QString SessionStore::recordPath(const QString &id) const
+{
+    return QDir(storeDirectory).filePath("tabs/" + id + ".cbor");
+}
+
+QString SessionStore::blobPath(const QString &name) const
+{
+    return QDir(storeDirectory).filePath("blobs/" + name);
+}
+
+bool SessionStore::writeRecord(const QString &id, const QVariantMap &status)
+{
+    auto rest = status;
+    for (const auto &key : BLOB_KEYS)
+        rest.remove(key);
+    auto record = QCborMap::fromVariantMap(rest);
+
+    QSet<QString> blobs;
+    for (const auto &key : BLOB_KEYS)
+    {
+        QCborArray list;
+        for (const auto &text : status.value(key).toStringList())
+        {
+            if (text.length() < BLOB_THRESHOLD)
+            {
+                list.append(text);
+                continue;
+            }
+            const auto bytes = text.toUtf8();
+            const QCborMap reference{
+                {QLatin1String("blob"),
+                 QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex())},
+                {QLatin1String("compression"), QLatin1String("zlib")}};
+            const auto name = blobName(reference);
+            // a blob is never changed after it's written, because its name is the hash of its content
+            if (!QFile::exists(blobPath(name)) && !writeFile(blobPath(name), qCompress(bytes, BLOB_COMPRESSION_LEVEL)))
+                return false;
+            blobs.insert(name);
+            list.append(reference);
+        }
+        record[key] = list;
+    }
+
+    auto withoutTimestamp = record;
+    withoutTimestamp.remove(QLatin1String("timestamp"));
+    const auto hash = QCryptographicHash::hash(withoutTimestamp.toCborValue().toCbor(), QCryptographicHash::Sha1);
+    if (recordHashes.value(id) == hash)
+        return true;
+
+    if (!writeFile(recordPath(id), toCbor(record)))
+        return false;
+    // the record may be written by version 2 of the store
+    QFile::remove(QDir(storeDirectory).filePath("tabs/" + id + ".json"));
+    recordBlobs[id] = blobs;
+    recordHashes[id] = hash;
+    return true;
+}
+
+QSet<QString> SessionStore::blobsOf(const QString &id)
+{
+    auto it = recordBlobs.constFind(id);
+    if (it != recordBlobs.constEnd())
+        return *it;
+
+    QSet<QString> blobs;
+    bool ok = false;
+    const auto record = readRecordFile(storeDirectory, id, &ok);
+    for (const auto &key : BLOB_KEYS)
+    {
+        for (const auto &value : record.value(key).toArray())
+        {
+            if (value.isMap())
+                blobs.insert(blobName(value.toMap()));
+        }
+    }
+    recordBlobs[id] = blobs;
+    return blobs;
+}
+
+void SessionStore::collectGarbage(const QStringList &tabs)
+{
+    QSet<QString> liveBlobs;
+    for (const auto &id : tabs)
+        liveBlobs.unite(blobsOf(id));
+
+    QDir records(QDir(storeDirectory).filePath("tabs"));
+    for (const auto &name : records.entryList({"*.cbor", "*.json"}, QDir::Files))
+    {
+        const auto id = QFileInfo(name).completeBaseName();
+        if (!tabs.contains(id))
+        {
+            LOG_INFO("Removing the session record of a closed tab " << INFO_OF(id));
+            records.remove(name);
+            recordBlobs.remove(id);
+            recordHashes.remove(id);
+        }
+    }
+
+    QDir blobs(QDir(storeDirectory).filePath("blobs"));
+    for (const auto &name : blobs.entryList(QDir::Files))
+    {
+        if (!liveBlobs.contains(name))
+            blobs.remove(name);
+    }
+}
+
+bool SessionStore::writeFile(const QString &path, const QByteArray &content)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        LOG_ERR("Failed to open [" << path << "]");
+        return false;
+    }
+    file.write(content);
+    if (!file.commit())
+    {
+        LOG_ERR("Failed to save to [" << path << "]");
+        return false;
+    }
+    return true;
+}
+
+} // namespace Core
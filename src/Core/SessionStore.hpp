@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The SessionStore keeps the session in a directory, with one record file per tab, so saving the session only
+ * rewrites the tabs changed since the last save. The index file lists the records of the tabs in order.
+ * Large test cases are stored as blobs named by the SHA-1 of their content, so an unchanged test case is never
+ * written again, and the same test case in several tabs is stored only once.
+ * The snapshots are submitted in the GUI thread and written by flush(), which is usually called in another thread.
+ *
+ * The files are in CBOR, prefixed with the self-describe tag, so they can be told apart from JSON and read from the
+ * file as a stream. The layout of the directory:
+ *     session.cbor    {"version": 3, "currentIndex": <int>, "tabs": [<record id>, ...]}
+ *     tabs/<id>.cbor  the EditorStatus of a tab, a large test case is replaced by a reference to its blob:
+ *                     {"blob": <hash>, "compression": "zlib"}
+ *     blobs/<hash>.z  the UTF-8 content of a large test case, compressed by qCompress
+ *
+ * Version 2 of the store used JSON files (session.json, tabs/<id>.json) and uncompressed blobs (blobs/<hash>). They
+ * are still read, and they are removed when the tabs are written in the current format.
+ */
+
+#ifndef SESSIONSTORE_HPP
+#define SESSIONSTORE_HPP
+
+#include <QCborMap>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+
+class QIODevice;
+
+namespace Core
+{
+
+class SessionStore
+{
+  public:
+    // the version of the format of the session files, written in the index files and the exported sessions
+    static const int VERSION = 3;
+
+    // the changes of the session since the last snapshot
+    struct Snapshot
+    {
+        int currentIndex = -1;
+        QStringList tabs;                       // the record ids of the tabs in order
+        QMap<QString, QVariantMap> changedTabs; // the statuses of the changed tabs, keyed by the record ids
+    };
+
+    /**
+     * @brief construct a session store
+     * @param directory the directory of the store, it's created on the first flush
+     */
+    explicit SessionStore(const QString &directory);
+
+    QString directory() const;
+
+    /**
+     * @brief the path of the index file in a store directory
+     */
+    static QString indexPath(const QString &directory);
+
+    /**
+     * @brief the path of the index file of version 2 of the store, which is in JSON
+     */
+    static QString legacyIndexPath(const QString &directory);
+
+    /**
+     * @brief encode a value in CBOR, prefixed with the self-describe tag
+     */
+    static QByteArray toCbor(const QCborValue &value);
+
+    /**
+     * @brief whether the content of a device starts with the CBOR self-describe tag
+     * @note the content is peeked, so the position of the device is not changed
+     */
+    static bool isCbor(QIODevice *device);
+
+    /**
+     * @brief decode a CBOR value from a device, without reading the whole content into memory first
+     * @param device the device opened for reading
+     * @param ok set to whether the value is decoded successfully
+     * @returns the value, with the self-describe tag removed
+     */
+    static QCborValue readCbor(QIODevice *device, bool *ok);
+
+    /**
+     * @brief add a snapshot to be written by the next flush
+     * @note the snapshot is merged with the unwritten snapshots, so no change is lost if a flush is skipped
+     * @note this is thread-safe
+     */
+    void submit(const Snapshot &snapshot);
+
+    /**
+     * @brief write the submitted snapshots to the directory
+     * @returns true on success or if there's nothing to write
+     * @note this is thread-safe, the changes which failed to be written are kept for the next flush
+     */
+    bool flush();
+
+    /**
+     * @brief write the status of a single tab now, without changing the index file
+     * @returns whether it's written successfully
+     * @note this is thread-safe, the record is removed by a later flush whose snapshot doesn't have the tab
+     */
+    bool writeTab(const QString &id, const QVariantMap &status);
+
+    /**
+     * @brief read the status of a tab from a store directory
+     * @param directory the store directory
+     * @param id the record id of the tab
+     * @param ok set to whether the record is read successfully
+     * @returns the status map which can be passed to MainWindow::EditorStatus
+     */
+    static QVariantMap readRecord(const QString &directory, const QString &id, bool *ok);
+
+  private:
+    QString recordPath(const QString &id) const;
+    QString blobPath(const QString &name) const;
+
+    /**
+     * @brief read a record file in either format, the blobs are not resolved
+     * @returns the record, or an empty map if it's not read successfully
+     */
+    static QCborMap readRecordFile(const QString &directory, const QString &id, bool *ok);
+
+    /**
+     * @brief write the record of a tab, and the blobs it refers to
+     * @returns whether it's written successfully
+     * @note the record is not written if only its timestamp is changed, e.g. the current tab is not edited
+     */
+    bool writeRecord(const QString &id, const QVariantMap &status);
+
+    /**
+     * @brief the file names of the blobs referred by a record, read from the record file if it's not cached
+     */
+    QSet<QString> blobsOf(const QString &id);
+
+    /**
+     * @brief remove the records not in *tabs* and the blobs not referred by any record in *tabs*
+     */
+    void collectGarbage(const QStringList &tabs);
+
+    /**
+     * @brief write a file atomically
+     * @note Util::saveFile is not used because it reads the settings, which is not safe in other threads
+     */
+    static bool writeFile(const QString &path, const QByteArray &content);
+
+    const QString storeDirectory;
+
+    QMutex pendingMutex; // guards pending and hasPending
+    Snapshot pending;    // the merged unwritten snapshots
+    bool hasPending = false;
+
+    QMutex writeMutex;                          // guards the files and the members below, held by flush
+    QHash<QString, QSet<QString>> recordBlobs;  // the cached blob file names of the records
+    QHash<QString, QByteArray> recordHashes;    // the hashes of the written records, without the timestamps
+    QStringList writtenTabs;                    // the tabs in the index file
+    int writtenCurrentIndex = -1;               // the current index in the index file
+};
+
+} // namespace Core
+
+#endif // SESSIONSTORE_HPP
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/SpeculativeCompiler.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace Core
+{
+
+SpeculativeCompiler::SpeculativeCompiler(QObject *parent) : QObject(parent)
+{
+}
+
+SpeculativeCompiler::~SpeculativeCompiler()
+{
+    delete compiler;
+    delete tmpDir;
+}
+
+QByteArray SpeculativeCompiler::hash(const QString &code, const QString &fileName, const QString &sourceFilePath,
+                                     const QString &compileCommand, const QString &lang)
+{
+    QStringList parts = {lang, compileCommand, fileName, sourceFilePath};
+    if (lang == "C++")
+    {
+        parts << SettingsHelper::getCppCompilerLauncher() << SettingsHelper::getCppFastLinker()
+              << QString::number(SettingsHelper::isCppReportCompileTime());
+    }
+    else if (lang == "Java")
+        parts << QString::number(SettingsHelper::isJavaCompileDaemon());
+    parts << code;
+
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    for (const auto &part : parts)
+    {
+        hasher.addData(part.toUtf8());
+        hasher.addData("\0", 1); // separate the parts, so that moving characters between them changes the hash
+    }
+    return hasher.result();
+}
+
+void SpeculativeCompiler::compile(const QString &code, const QString &fileName, const QString &sourceFilePath,
+                                  const QString &compileCommand, const QString &lang)
+{
+    if (lang != "C++" && lang != "Java")
+        return;
+
+    const auto key = hash(code, fileName, sourceFilePath, compileCommand, lang);
+    if (key == currentHash) // it's being compiled, or it's compiled (whether succeeded, failed or taken)
+        return;
+
+    cancel();
+
+    if (tmpDir == nullptr || !tmpDir->isValid() || !QDir(tmpDir->path()).exists())
+    {
+        delete tmpDir;
+        tmpDir = new QTemporaryDir();
+        if (!tmpDir->isValid())
+        {
+            LOG_WARN("Failed to create the temporary directory for speculative compilation");
+            return;
+        }
+    }
+
+    const auto path = tmpDir->filePath(fileName);
+    if (!Util::saveFile(path, code, tr("Speculative Compilation"), false))
+        return;
+
+    if (lang == "C++")
+    {
+        sideOutputPath = tmpDir->filePath("output" + Util::exeSuffix);
+    }
+    else
+    {
+        sideOutputPath = tmpDir->filePath("classes");
+        QDir(sideOutputPath).removeRecursively(); // don't take the classes of an old build
+        QDir().mkpath(sideOutputPath);
+    }
+
+    LOG_INFO(INFO_OF(lang) << INFO_OF(path));
+
+    currentHash = key;
+    this->lang = lang;
+
+    compiler = new Compiler();
+    connect(compiler, &Compiler::compilationFinished, this,
+            [this](const QString &warning) { onFinished(true, warning); });
+    connect(compiler, &Compiler::compilationErrorOccurred, this, [this] { onFinished(false, QString()); });
+    connect(compiler, &Compiler::compilationFailed, this, [this] { onFinished(false, QString()); });
+    compiler->setOutputPath(sideOutputPath);
+    compiler->setLowPriority(true);
+    compiler->start(path, sourceFilePath, compileCommand, lang);
+}
+
+bool SpeculativeCompiler::isCompiling(const QByteArray &hash) const
+{
+    return compiler != nullptr && hash == currentHash;
+}
+
+bool SpeculativeCompiler::take(const QByteArray &hash, const QString &outputPath, QString *warning)
+{
+    if (!succeeded || hash != currentHash)
+        return false;
+
+    succeeded = false;
+
+    bool moved = true;
+    if (lang == "C++")
+    {
+        QFile::remove(outputPath);
+        moved = QFile::rename(sideOutputPath, outputPath);
+    }
+    else
+    {
+        // the class path may contain other files, e.g. the temporary source file, so move the class files only
+        QDir side(sideOutputPath);
+        for (const auto &name : side.entryList({"*.class"}, QDir::Files))
+        {
+            const auto target = QDir(outputPath).filePath(name);
+            QFile::remove(target);
+            moved = QFile::rename(side.filePath(name), target) && moved;
+        }
+    }
+
+    if (!moved)
+    {
+        LOG_WARN("Failed to move the speculative build to " << outputPath);
+        return false;
+    }
+
+    LOG_INFO("Speculative build taken " << INFO_OF(outputPath));
+    *warning = this->warning;
+    return true;
+}
+
+void SpeculativeCompiler::cancel()
+{
+    if (compiler != nullptr)
+    {
+        LOG_INFO("Cancelling speculative compilation");
+        delete compiler;
+        compiler = nullptr;
+    }
+    currentHash.clear();
+    warning.clear();
+    succeeded = false;
+}
+
+void SpeculativeCompiler::onFinished(bool success, const QString &warning)
+{
+    LOG_INFO(BOOL_INFO_OF(success));
+    // this may be called in Compiler::start, so the compiler can't be deleted immediately
+    compiler->deleteLater();
+    compiler = nullptr;
+    succeeded = success;
+    this->warning = warning;
+    emit finished();
+}
+
+} // namespace Core
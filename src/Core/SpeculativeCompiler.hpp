@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The SpeculativeCompiler compiles the code of a tab in the background before it's asked to,
+ * e.g. when the editor is idle or the file is saved. The code is copied into a directory of its own
+ * and compiled at a low priority into a side output path, so it never touches the files of a real compilation.
+ * When the code is compiled for real, the speculative build of the same code, compiled with the same command,
+ * can be taken instead of compiling it again. A speculative build of any other code should be cancelled.
+ */
+
+#ifndef SPECULATIVECOMPILER_HPP
+#define SPECULATIVECOMPILER_HPP
+
+#include <QObject>
+
+class QTemporaryDir;
+
+namespace Core
+{
+class Compiler;
+
+class SpeculativeCompiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit SpeculativeCompiler(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the speculative compiler
+     * @note the compilation is killed if it's running, and the side output is removed
+     */
+    ~SpeculativeCompiler() override;
+
+    /**
+     * @brief the key of a build, builds with the same key have the same output
+     * @param code the code to compile
+     * @param fileName the name of the compiled file, it's the class name in Java
+     * @param sourceFilePath the path to the original source file, it matters because of the include path
+     * @param compileCommand the command for compiling
+     * @param lang the language to compile
+     * @note the settings which change how the code is compiled are a part of the key too
+     */
+    static QByteArray hash(const QString &code, const QString &fileName, const QString &sourceFilePath,
+                           const QString &compileCommand, const QString &lang);
+
+    /**
+     * @brief start compiling the code in the background
+     * @param code the code to compile
+     * @param fileName the name of the temporary file, it matters for Java
+     * @param sourceFilePath the path to the original source file
+     * @param compileCommand the command for compiling
+     * @param lang the language to compile, Python is ignored
+     * @note Nothing happens if the same code is already being compiled or compiled successfully.
+     *       Otherwise, the current build is cancelled.
+     */
+    void compile(const QString &code, const QString &fileName, const QString &sourceFilePath,
+                 const QString &compileCommand, const QString &lang);
+
+    /**
+     * @brief whether the build of the given key is running
+     */
+    bool isCompiling(const QByteArray &hash) const;
+
+    /**
+     * @brief use the speculative build as the output of a real compilation
+     * @param hash the key of the real compilation
+     * @param outputPath the output path of the real compilation, see Compiler::outputPath
+     * @param warning set to the compile warnings of the speculative build if it's taken
+     * @returns true if the build of the given key has succeeded and its output is moved to *outputPath*
+     * @note a build can be taken only once
+     */
+    bool take(const QByteArray &hash, const QString &outputPath, QString *warning);
+
+    /**
+     * @brief kill the running build and forget the finished one
+     */
+    void cancel();
+
+  signals:
+    /**
+     * @brief the speculative build has finished, successfully or not
+     */
+    void finished();
+
+  private:
+    void onFinished(bool success, const QString &warning);
+
+    QTemporaryDir *tmpDir = nullptr; // holds the copies of the code and the side outputs
+    Compiler *compiler = nullptr;    // the running build, nullptr if there isn't any
+    QByteArray currentHash;          // the key of the running or succeeded build
+    QString lang;                    // the language of the running or succeeded build
+    QString sideOutputPath;          // the output path of the running or succeeded build
+    QString warning;                 // the compile warnings of the succeeded build
+    bool succeeded = false;          // whether the build of currentHash has succeeded and is not taken yet
+};
+
+} // namespace Core
+
+#endif // SPECULATIVECOMPILER_HPP
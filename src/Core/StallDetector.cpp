@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/StallDetector.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QJsonArray>
+#include <QMetaEnum>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Core
+{
+
+namespace
+{
+std::atomic<bool> running{false};                 // whether the watchdog thread is running
+std::atomic<Qt::HANDLE> guiThread{nullptr};       // the thread whose event loop is watched
+std::atomic<const char *> eventReceiver{nullptr}; // the class name of the receiver of the outermost event
+std::atomic<int> eventType{QEvent::None};         // the type of the outermost event
+int eventDepth = 0;                               // the depth of the nested events, used in the GUI thread only
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool isGuiThread()
+{
+    return running.load(std::memory_order_relaxed) && QThread::currentThreadId() == guiThread.load();
+}
+} // namespace
+
+class StallDetector::Watchdog
+{
+  public:
+    static Watchdog &instance()
+    {
+        static Watchdog watchdog;
+        return watchdog;
+    }
+
+    void start(int threshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->threshold = qMax(threshold, 1);
+        if (!thread.joinable())
+        {
+            stopping = false;
+            pending = false;
+            thread = std::thread([this] { run(); });
+        }
+        condition.notify_one();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_one();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    ~Watchdog()
+    {
+        stop();
+    }
+
+    void pushOperation(const QString &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        operations.push_back(name);
+    }
+
+    /**
+     * @brief pop the innermost operation
+     * @param duration how long the operation has run, it's reported if it's the cause of the current stall
+     */
+    void popOperation(qint64 duration)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // If the stall ends before the watchdog thread notices it, the operation which took too long is the cause.
+        if (pending && stallOperation.isEmpty() && duration >= threshold)
+            stallOperation = operations.join(" > ");
+        if (!operations.isEmpty())
+            operations.pop_back();
+    }
+
+    /**
+     * @brief handle the ping from the watchdog thread, called in the GUI thread
+     */
+    void pong()
+    {
+        Stall stall;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!pending)
+                return;
+            pending = false;
+            stall.duration = now() - pingTime;
+            if (stall.duration < threshold)
+                return;
+            stall.time = QDateTime::currentDateTime();
+            stall.operation = stallOperation;
+            stall.event = stallEvent;
+            stalls.push_back(stall);
+            if (stalls.size() > MAX_STALLS)
+                stalls.pop_front();
+            ++totalStalls;
+            longestStall = qMax(longestStall, stall.duration);
+        }
+        LOG_WARN("The GUI was stalled for " << stall.duration << " ms" << INFO_OF(stall.operation)
+                                            << INFO_OF(stall.event));
+    }
+
+    QList<Stall> recordedStalls()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stalls;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stalls.clear();
+        totalStalls = 0;
+        longestStall = 0;
+    }
+
+    QJsonObject status()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {{"running", thread.joinable() && !stopping},
+                {"threshold", threshold},
+                {"totalStalls", totalStalls},
+                {"longestStall", longestStall}};
+    }
+
+  private:
+    Watchdog() = default;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            if (!pending && now() - pingTime >= threshold && QCoreApplication::instance() != nullptr)
+            {
+                pending = true;
+                pingTime = now();
+                stallOperation.clear();
+                stallEvent.clear();
+                lock.unlock();
+                QMetaObject::invokeMethod(QCoreApplication::instance(), [this] { pong(); }, Qt::QueuedConnection);
+                lock.lock();
+            }
+            else if (pending && now() - pingTime >= threshold)
+            {
+                // The GUI is stalled, find out what it's doing. An empty operation may be filled in later ticks.
+                if (stallOperation.isEmpty())
+                    stallOperation = operations.join(" > ");
+                if (stallEvent.isEmpty())
+                    stallEvent = currentEvent();
+            }
+
+            // While a ping is waiting, check a few times in the threshold, so the snapshot is taken soon after the
+            // stall begins. Otherwise wait for the next ping, so an idle GUI is woken at most once in the threshold.
+            const auto interval =
+                pending ? qBound<qint64>(10, threshold / 4, 100) : qMax<qint64>(1, pingTime + threshold - now());
+            condition.wait_for(lock, std::chrono::milliseconds(interval), [this] { return stopping; });
+        }
+    }
+
+    static QString currentEvent()
+    {
+        const auto *receiver = eventReceiver.load();
+        if (receiver == nullptr)
+            return QString();
+        const auto *type = QMetaEnum::fromType<QEvent::Type>().valueToKey(eventType.load());
+        return QString("%1 to %2").arg(type != nullptr ? type : QString::number(eventType.load())).arg(receiver);
+    }
+
+    std::thread thread;
+    std::mutex mutex; // guards the members below
+    std::condition_variable condition;
+    bool stopping = false;
+    int threshold = 200;     // the time in milliseconds a ping can wait before it's a stall
+    bool pending = false;    // whether a ping is sent and not handled yet
+    qint64 pingTime = 0;     // when the pending ping is sent
+    QString stallOperation;  // the operations running during the current stall
+    QString stallEvent;      // the event being dispatched during the current stall
+    QStringList operations;  // the operations running in the GUI thread, the outermost first
+    QList<Stall> stalls;     // the latest stalls, the oldest first
+    qint64 totalStalls = 0;  // the number of stalls since the detector is started or cleared
+    qint64 longestStall = 0; // the duration of the longest stall
+};
+
+StallDetector::Operation::Operation(const QString &name) : active(isGuiThread()), start(active ? now() : 0)
+{
+    if (active)
+        Watchdog::instance().pushOperation(name);
+}
+
+StallDetector::Operation::~Operation()
+{
+    if (active)
+        Watchdog::instance().popOperation(now() - start);
+}
+
+StallDetector::EventScope::EventScope(QObject *receiver, QEvent *event) : active(isGuiThread()), outermost(false)
+{
+    if (!active)
+        return;
+    outermost = eventDepth++ == 0;
+    if (outermost)
+    {
+        eventType.store(static_cast<int>(event->type()), std::memory_order_relaxed);
+        eventReceiver.store(receiver->metaObject()->className());
+    }
+}
+
+StallDetector::EventScope::~EventScope()
+{
+    if (!active)
+        return;
+    --eventDepth;
+    if (outermost)
+        eventReceiver.store(nullptr);
+}
+
+void StallDetector::start(int threshold)
+{
+    LOG_INFO(INFO_OF(threshold));
+    guiThread.store(QThread::currentThreadId());
+    running.store(true);
+    Watchdog::instance().start(threshold);
+}
+
+void StallDetector::stop()
+{
+    LOG_INFO("Stopping the stall detector");
+    running.store(false);
+    Watchdog::instance().stop();
+}
+
+QList<StallDetector::Stall> StallDetector::stalls()
+{
+    return Watchdog::instance().recordedStalls();
+}
+
+void StallDetector::clear()
+{
+    Watchdog::instance().clear();
+}
+
+QJsonObject StallDetector::toJson()
+{
+    auto json = Watchdog::instance().status();
+    QJsonArray array;
+    for (const auto &stall : stalls())
+    {
+        array.push_back(QJsonObject{{"time", stall.time.toString(Qt::ISODateWithMs)},
+                                    {"duration", stall.duration},
+                                    {"operation", stall.operation},
+                                    {"event", stall.event}});
+    }
+    json["stalls"] = array;
+    return json;
+}
+
+} // namespace Core
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The StallDetector finds the freezes of the GUI. A watchdog thread pings the GUI event loop, and if a ping isn't
+ * handled within the threshold, the GUI is stalled. Each stall is recorded with its duration, the operations which
+ * were running in the GUI thread (see StallDetector::Operation) and the event being dispatched when it's detected,
+ * so the blocking calls can be found and moved out of the GUI thread.
+ * The stalls are written to the log, and the latest MAX_STALLS stalls are kept in memory.
+ * A ping is sent at most once in the threshold and only after the previous one is handled, so an idle GUI is rarely
+ * woken, and a stall may be measured up to one threshold shorter than it is.
+ */
+
+#ifndef STALLDETECTOR_HPP
+#define STALLDETECTOR_HPP
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+class QEvent;
+class QObject;
+
+namespace Core
+{
+
+class StallDetector
+{
+  public:
+    static const int MAX_STALLS = 100; // the number of the latest stalls kept in memory
+
+    struct Stall
+    {
+        QDateTime time;      // when the stall ended
+        qint64 duration = 0; // in milliseconds
+        QString operation;   // the running operations, the outermost first, separated by " > "
+        QString event;       // the event being dispatched, e.g. "Timer to Editor::CodeEditor"
+    };
+
+    // an operation running in the GUI thread, it's reported if the GUI is stalled when it's running
+    class Operation
+    {
+      public:
+        /**
+         * @param name the name of the operation, e.g. "Format Code"
+         * @note it's ignored if it's not in the GUI thread
+         */
+        explicit Operation(const QString &name);
+        ~Operation();
+
+      private:
+        bool active;  // whether it's in the GUI thread when the detector is running
+        qint64 start; // when the operation starts, in milliseconds
+    };
+
+    // the event being dispatched in the GUI thread, used in QApplication::notify
+    class EventScope
+    {
+      public:
+        EventScope(QObject *receiver, QEvent *event);
+        ~EventScope();
+
+      private:
+        bool active;    // whether it's in the GUI thread when the detector is running
+        bool outermost; // whether it's not nested in another event
+    };
+
+    /**
+     * @brief start the watchdog thread, or change the threshold if it's already started
+     * @param threshold the time in milliseconds a ping can wait before it's a stall
+     * @note this should be called in the GUI thread
+     */
+    static void start(int threshold);
+
+    /**
+     * @brief stop the watchdog thread, the recorded stalls are kept
+     */
+    static void stop();
+
+    /**
+     * @brief the latest stalls, the oldest first
+     */
+    static QList<Stall> stalls();
+
+    /**
+     * @brief remove the recorded stalls
+     */
+    static void clear();
+
+    /**
+     * @brief the status of the detector and the latest stalls in JSON
+     */
+    static QJsonObject toJson();
+
+  private:
+    class Watchdog;
+};
+
+} // namespace Core
+
+#endif // STALLDETECTOR_HPP
@@ -49,16 +49,20 @@
 #include "generated/SettingsHelper.hpp"
 #include <KSyntaxHighlighting/Definition>
 #include <KSyntaxHighlighting/Format>
+#include <QAbstractItemView>
 #include <QApplication>
+#include <QCompleter>
 #include <QFontDatabase>
 #include <QMimeData>
 #include <QPainter>
 #include <QRegularExpression>
 #include <QScrollBar>
+#include <QStandardItemModel>
 #include <QTextBlock>
 #include <QTextCharFormat>
 #include <QTextStream>
 #include <QToolTip>
+#include <algorithm>
 
 namespace Editor
 {
@@ -69,12 +73,20 @@ CodeEditor::CodeEditor(QWidget *widget) : QPlainTextEdit(widget)
     languageRepo = new LanguageRepository(SettingsHelper::getDefaultLanguage(), this);
 
     connect(document(), &QTextDocument::blockCountChanged, this, &CodeEditor::updateBottomMargin);
+    connect(document(), &QTextDocument::blockCountChanged, this, &CodeEditor::clearLineAnnotations);
     connect(document(), &QTextDocument::blockCountChanged, this, &CodeEditor::updateSidebarGeometry);
     connect(this, &QPlainTextEdit::updateRequest, this, &CodeEditor::updateSidebarArea);
     connect(this, &QPlainTextEdit::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
     connect(this, &QPlainTextEdit::cursorPositionChanged, this, &CodeEditor::highlightParentheses);
     connect(this, &QPlainTextEdit::selectionChanged, this, &CodeEditor::highlightOccurrences);
 
+    completionModel = new QStandardItemModel(this);
+    completer = new QCompleter(completionModel, this);
+    completer->setWidget(this);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion); // the items are already filtered
+    completer->setMaxVisibleItems(12);
+    connect(completer, qOverload<const QModelIndex &>(&QCompleter::activated), this, &CodeEditor::insertCompletion);
+
     setMouseTracking(true);
 }
 
@@ -191,7 +203,11 @@ int CodeEditor::sidebarWidth() const
         ++digits;
         count /= 10;
     }
-    return 4 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * (digits + 1) + fontMetrics().lineSpacing();
+    int width = 4 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * (digits + 1) + fontMetrics().lineSpacing();
+    const int annotationsWidth = lineAnnotationsWidth();
+    if (annotationsWidth > 0)
+        width += annotationsWidth + fontMetrics().horizontalAdvance(QLatin1Char(' '));
+    return width;
 }
 
 void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
@@ -207,17 +223,35 @@ void CodeEditor::sidebarPaintEvent(QPaintEvent *event)
     const int currentBlockNumber = textCursor().blockNumber();
 
     const auto foldingMarkerSize = fontMetrics().lineSpacing();
+    const auto annotationsWidth = lineAnnotationsWidth();
 
     while (block.isValid() && top <= event->rect().bottom())
     {
         if (block.isVisible() && bottom >= event->rect().top())
         {
+            const auto annotation = lineAnnotations.constFind(blockNumber + 1);
+            const auto heat = annotation == lineAnnotations.constEnd() ? 0.0 : qBound(0.0, annotation->heat, 1.0);
+
+            // the heat map, the hotter the line the more opaque the red background
+            if (heat > 0)
+            {
+                QColor background(Qt::red);
+                background.setAlphaF(0.1 + 0.4 * heat);
+                painter.fillRect(0, top, sideBar->width(), bottom - top, background);
+            }
+
             const auto number = QString::number(blockNumber + 1);
             painter.setPen(getEditorColor((blockNumber == currentBlockNumber)
                                               ? KSyntaxHighlighting::Theme::CurrentLineNumber
                                               : KSyntaxHighlighting::Theme::LineNumbers));
             painter.drawText(0, top, sideBar->width() - 2 - foldingMarkerSize, fontMetrics().height(), Qt::AlignRight,
                              number);
+
+            if (annotation != lineAnnotations.constEnd())
+            {
+                painter.setPen(getEditorColor(KSyntaxHighlighting::Theme::LineNumbers));
+                painter.drawText(2, top, annotationsWidth, fontMetrics().height(), Qt::AlignRight, annotation->text);
+            }
         }
 
         // folding marker
@@ -854,6 +888,71 @@ int CodeEditor::getFirstVisibleBlock()
 }
 
 void CodeEditor::keyPressEvent(QKeyEvent *e)
+{
+    if (completer->popup()->isVisible())
+    {
+        switch (e->key())
+        {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Tab:
+        case Qt::Key_Escape:
+        case Qt::Key_Backtab:
+            if (e->key() == Qt::Key_Escape)
+                completionPosition = -1;
+            e->ignore(); // let the completer choose an item or close the popup
+            return;
+        default:
+            break;
+        }
+    }
+
+    editKeyPressEvent(e);
+    updateCompletion(e);
+}
+
+void CodeEditor::updateCompletion(QKeyEvent *e)
+{
+    switch (e->key())
+    {
+    case Qt::Key_Shift:
+    case Qt::Key_Control:
+    case Qt::Key_Alt:
+    case Qt::Key_Meta:
+        return;
+    default:
+        break;
+    }
+
+    const bool forced = e->key() == Qt::Key_Space && e->modifiers() == Qt::ControlModifier;
+    const auto prefix = wordBeforeCursor();
+    const auto typed = e->text();
+
+    const bool typing = e->modifiers() == Qt::NoModifier || e->modifiers() == Qt::ShiftModifier;
+    const bool wordTyped = typed.length() == 1 && (typed[0].isLetterOrNumber() || typed[0] == '_');
+
+    bool request = forced;
+    if (!request && !prefix.isEmpty() && typing)
+        request = wordTyped || e->key() == Qt::Key_Backspace;
+    if (!request && prefix.isEmpty() && typed.length() == 1)
+    {
+        // the member access operators, "." in all languages, "->" and "::" in C++
+        const auto cursor = textCursor();
+        const auto before = cursor.block().text().left(cursor.positionInBlock());
+        request = before.endsWith('.') || before.endsWith("->") || before.endsWith("::");
+    }
+
+    if (!request)
+    {
+        hideCompletions();
+        return;
+    }
+
+    completionPosition = textCursor().position();
+    emit completionRequested(textCursor().blockNumber(), textCursor().positionInBlock(), prefix);
+}
+
+void CodeEditor::editKeyPressEvent(QKeyEvent *e)
 {
     /* if(m_vimCursor) */
     /* { */
@@ -1130,28 +1229,50 @@ void CodeEditor::highlightAllSquiggle()
 {
     squigglesExtraSelections.clear();
     squigglesLineExtraSelections.clear();
-    for (const auto &info : squiggles)
+    highlightedSquiggles = 0;
+    highlightNewSquiggles();
+}
+
+void CodeEditor::highlightNewSquiggles()
+{
+    // resolve the lines in order, so the squiggles on the same line share one lookup of the block
+    QVector<int> order;
+    order.reserve(squiggles.size() - highlightedSquiggles);
+    for (int i = highlightedSquiggles; i < squiggles.size(); ++i)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(),
+              [this](int lhs, int rhs) { return squiggles[lhs].start < squiggles[rhs].start; });
+
+    QTextBlock block;
+    int blockNumber = -1;
+    for (int index : order)
     {
-        highlightSquiggle(info);
+        const auto &info = squiggles[index];
+        if (info.start.first - 1 != blockNumber)
+        {
+            blockNumber = info.start.first - 1;
+            block = document()->findBlockByNumber(blockNumber);
+        }
+        highlightSquiggle(info, block);
     }
+
+    highlightedSquiggles = squiggles.size();
     updateExtraSelections();
 }
 
-void CodeEditor::highlightSquiggle(const SquiggleInformation &info)
+void CodeEditor::highlightSquiggle(const SquiggleInformation &info, const QTextBlock &startBlock)
 {
+    if (!startBlock.isValid())
+        return;
 
-    auto cursor = textCursor();
-
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, info.start.first - 1);
-    cursor.movePosition(QTextCursor::StartOfBlock);
-    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::MoveAnchor, info.start.second);
-
-    if (info.stop.first > info.start.first)
-        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, info.stop.first - info.start.first);
+    auto stopBlock =
+        info.stop.first == info.start.first ? startBlock : document()->findBlockByNumber(info.stop.first - 1);
+    if (!stopBlock.isValid())
+        stopBlock = document()->lastBlock();
 
-    cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
-    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, info.stop.second);
+    QTextCursor cursor(document());
+    cursor.setPosition(startBlock.position() + qMin(info.start.second, startBlock.length() - 1));
+    cursor.setPosition(stopBlock.position() + qMin(info.stop.second, stopBlock.length() - 1), QTextCursor::KeepAnchor);
 
     QTextCharFormat newcharfmt = currentCharFormat();
     newcharfmt.setFontUnderline(true);
@@ -1209,10 +1330,90 @@ void CodeEditor::clearSquiggle()
     squiggles.clear();
     squigglesExtraSelections.clear();
     squigglesLineExtraSelections.clear();
+    highlightedSquiggles = 0;
 
     updateExtraSelections();
 }
 
+void CodeEditor::showCompletions(const QVector<CompletionItem> &items)
+{
+    if (completionPosition != textCursor().position())
+        return;
+
+    if (items.isEmpty())
+    {
+        completer->popup()->hide();
+        return;
+    }
+
+    completionModel->clear();
+    for (const auto &item : items)
+    {
+        auto *row = new QStandardItem(item.label);
+        row->setData(item.insertText, Qt::UserRole);
+        if (!item.detail.isEmpty())
+            row->setToolTip(item.detail);
+        completionModel->appendRow(row);
+    }
+
+    auto *popup = completer->popup();
+    QRect rect = cursorRect();
+    rect.setWidth(popup->sizeHintForColumn(0) + popup->verticalScrollBar()->sizeHint().width());
+    completer->complete(rect);
+    popup->setCurrentIndex(completer->completionModel()->index(0, 0));
+}
+
+void CodeEditor::hideCompletions()
+{
+    completionPosition = -1;
+    completer->popup()->hide();
+}
+
+void CodeEditor::insertCompletion(const QModelIndex &index)
+{
+    const auto text = index.data(Qt::UserRole).toString();
+    auto cursor = textCursor();
+    cursor.movePosition(QTextCursor::PreviousCharacter, QTextCursor::KeepAnchor, wordBeforeCursor().length());
+    cursor.insertText(text);
+    setTextCursor(cursor);
+    hideCompletions();
+}
+
+QString CodeEditor::wordBeforeCursor() const
+{
+    const auto cursor = textCursor();
+    const auto text = cursor.block().text();
+    int start = cursor.positionInBlock();
+    while (start > 0 && (text[start - 1].isLetterOrNumber() || text[start - 1] == '_'))
+        --start;
+    return text.mid(start, cursor.positionInBlock() - start);
+}
+
+void CodeEditor::setLineAnnotations(const QMap<int, LineAnnotation> &annotations)
+{
+    lineAnnotations = annotations;
+    updateSidebarGeometry();
+    sideBar->update();
+}
+
+void CodeEditor::clearLineAnnotations()
+{
+    if (lineAnnotations.isEmpty())
+        return;
+
+    lineAnnotations.clear();
+    updateSidebarGeometry();
+    sideBar->update();
+}
+
+int CodeEditor::lineAnnotationsWidth() const
+{
+    int width = 0;
+    for (const auto &annotation : lineAnnotations)
+        width = qMax(width, fontMetrics().horizontalAdvance(annotation.text));
+    return width;
+}
+
 QChar CodeEditor::charUnderCursor(int offset) const
 {
     auto block = textCursor().blockNumber();
@@ -44,9 +44,13 @@
 
 #include "HighLighter.hpp"
 #include <KSyntaxHighlighting/Theme>
+#include <QMap>
 #include <QPlainTextEdit>
 #include <utility>
 
+class QCompleter;
+class QStandardItemModel;
+
 namespace KSyntaxHighlighting
 {
 class SyntaxHighlighter;
@@ -70,6 +74,21 @@ class CodeEditor : public QPlainTextEdit
         Error
     };
 
+    // a short text shown in the sidebar next to the line number, e.g. the cost of the line in a profiled run
+    struct LineAnnotation
+    {
+        QString text;
+        double heat = 0; // how hot the line is, in [0, 1], the hotter the redder the background
+    };
+
+    // an item in the completion popup
+    struct CompletionItem
+    {
+        QString label;      // the text shown in the popup
+        QString insertText; // the text which replaces the word before the cursor when the item is chosen
+        QString detail;     // shown in the tooltip, e.g. the type of the item
+    };
+
     struct Parenthesis
     {
         QChar left, right;
@@ -106,11 +125,36 @@ class CodeEditor : public QPlainTextEdit
 
     void highlightAllSquiggle();
 
+    /**
+     * @brief highlight the squiggles added after the last highlightAllSquiggle or highlightNewSquiggles
+     * @note This is faster than highlightAllSquiggle when squiggles are added one by one.
+     */
+    void highlightNewSquiggles();
+
     /**
      * @brief clearSquiggle, Clears complete squiggle from editor
      */
     void clearSquiggle();
 
+    /**
+     * @brief show annotations in the sidebar next to the line numbers
+     * @param annotations the annotations by line numbers in 1-based indexing
+     * @note The annotations are cleared when lines are added or removed, because they would be attached to
+     *       the wrong lines.
+     */
+    void setLineAnnotations(const QMap<int, LineAnnotation> &annotations);
+
+    void clearLineAnnotations();
+
+    /**
+     * @brief show the completion popup at the cursor
+     * @param items the items in the order they are shown, the popup is hidden if it's empty
+     * @note It's ignored if the cursor is moved after the last completionRequested, so late results don't show up.
+     */
+    void showCompletions(const QVector<CompletionItem> &items);
+
+    void hideCompletions();
+
     /**
      * @brief Enables or disables Vim Like cursor
      */
@@ -140,6 +184,14 @@ class CodeEditor : public QPlainTextEdit
      */
     void fontChanged(const QFont &newFont);
 
+    /**
+     * @brief completions are needed at the cursor, e.g. a letter or "." is typed, or Ctrl+Space is pressed
+     * @param line the line of the cursor, 0-based
+     * @param column the column of the cursor, 0-based
+     * @param prefix the part of the word before the cursor, which the completions should match
+     */
+    void completionRequested(int line, int column, const QString &prefix);
+
   public slots:
     /**
      * @brief Slot, that indent the selected lines.
@@ -261,6 +313,27 @@ class CodeEditor : public QPlainTextEdit
     void highlightCurrentLine();
 
   private:
+    /**
+     * @brief handle a key press, except for completion
+     */
+    void editKeyPressEvent(QKeyEvent *e);
+
+    /**
+     * @brief request completions or hide the completion popup after a key press
+     */
+    void updateCompletion(QKeyEvent *e);
+
+    /**
+     * @brief replace the word before the cursor by a chosen completion item
+     * @param index the index of the item in completionModel
+     */
+    void insertCompletion(const QModelIndex &index);
+
+    /**
+     * @brief the part of the word before the cursor, e.g. "push_b" if the cursor is after it
+     */
+    QString wordBeforeCursor() const;
+
     /**
      * @brief Method for getting character under
      * cursor.
@@ -300,6 +373,11 @@ class CodeEditor : public QPlainTextEdit
 
     QColor getTextColor(KSyntaxHighlighting::Theme::TextStyle style);
 
+    /**
+     * @brief the width of the widest line annotation, 0 if there are no annotations
+     */
+    int lineAnnotationsWidth() const;
+
     /**
      * @brief The SquiggleInformation struct, Line number will be index of vector+1;
      */
@@ -316,7 +394,11 @@ class CodeEditor : public QPlainTextEdit
         QString tooltip;
     };
 
-    void highlightSquiggle(const SquiggleInformation &info);
+    /**
+     * @brief add the extra selections of a squiggle
+     * @param startBlock the block of the start line of the squiggle
+     */
+    void highlightSquiggle(const SquiggleInformation &info, const QTextBlock &startBlock);
 
     QList<QTextEdit::ExtraSelection> currentLineExtraSelections, parenthesesExtraSelections, occurrencesExtraSelections,
         squigglesExtraSelections, squigglesLineExtraSelections;
@@ -333,8 +415,18 @@ class CodeEditor : public QPlainTextEdit
 
     QVector<SquiggleInformation> squiggles;
 
+    int highlightedSquiggles = 0; // the number of squiggles which have extra selections
+
     QVector<Parenthesis> parentheses;
 
+    QMap<int, LineAnnotation> lineAnnotations;
+
+    QCompleter *completer = nullptr;
+
+    QStandardItemModel *completionModel = nullptr;
+
+    int completionPosition = -1; // the cursor position of the last completionRequested, -1 if it's hidden since
+
     Highlighter *highlighter = nullptr;
 
     KSyntaxHighlighting::Theme theme;
@@ -18,6 +18,7 @@
 #include "Extensions/CFTool.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "generated/SettingsHelper.hpp"
 #include <QFileInfo>
 #include <QProcess>
@@ -40,6 +41,8 @@ CFTool::~CFTool()
 
 void CFTool::submit(const QString &filePath, const QString &url)
 {
+    Core::StallDetector::Operation operation("Submit With CF Tool");
+
     if (CFToolProcess != nullptr)
     {
         if (CFToolProcess->state() == QProcess::Running)
@@ -108,6 +111,7 @@ void CFTool::submit(const QString &filePath, const QString &url)
 bool CFTool::check(const QString &path)
 {
     LOG_INFO(INFO_OF(path));
+    Core::StallDetector::Operation operation("Check CF Tool");
     QProcess checkProcess;
     checkProcess.start(path, {"--version"});
     bool finished = checkProcess.waitForFinished(2000);
@@ -190,6 +194,7 @@ void CFTool::showToastMessage(const QString &message)
 
 QString CFTool::getCFToolVersion() const
 {
+    Core::StallDetector::Operation operation("Get CF Tool Version");
     QProcess process;
     process.start(CFToolPath, {"--version"});
     if (!process.waitForFinished(2000))
@@ -18,6 +18,7 @@
 #include "Extensions/CodeFormatter.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "Editor/CodeEditor.hpp"
 #include "Settings/SettingsManager.hpp"
 #include "Util/FileUtil.hpp"
@@ -93,6 +94,7 @@ void CodeFormatter::format() const
 
 QString CodeFormatter::runProcess(const QStringList &args) const
 {
+    Core::StallDetector::Operation operation("Run " + settingKey());
     QProcess formatProcess;
     formatProcess.start(getSetting("Program").toString(), args);
     LOG_INFO(INFO_OF(formatProcess.program()) << INFO_OF(formatProcess.arguments().join(' ')));
@@ -21,9 +21,14 @@
 #include "Util/Util.hpp"
 #include "third_party/lsp-cpp/include/LSPClient.hpp"
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QRegularExpression>
+#include <QTextBlock>
+#include <QUrl>
+#include <algorithm>
 
 namespace Extensions
 {
@@ -52,73 +57,72 @@ LanguageServer::~LanguageServer()
 
 void LanguageServer::openDocument(QString const &path, Editor::CodeEditor *editor, MessageLogger *log)
 {
-    if (isDocumentOpen())
+    int index = indexOf(editor);
+    if (index != -1 && documents[index].path != path)
     {
-        LOG_WARN("openDocument called without closing the previous document. Closing it now");
-        closeDocument();
+        removeDocument(index, true);
+        index = -1;
     }
 
-    m_editor = editor;
-    openFile = path;
-    logger = log;
-
-    if (lsp == nullptr)
-        return;
-
-    if (!isInitialized)
+    if (index != -1)
     {
-        initializeLSP(path);
-        isInitialized = true;
+        // it's already open, mark it as the most recently used one
+        documents[index].logger = log;
+        documents.move(index, 0);
+        return;
     }
 
-    std::string uri = "file://" + path.toStdString();
-    std::string code = m_editor->toPlainText().toStdString();
-    std::string lang;
-
-    if (language == "Java")
-        lang = "java";
-    else if (language == "Python")
-        lang = "python";
-    else
+    Document document;
+    document.path = path;
+    document.editor = editor;
+    document.logger = log;
+    document.contentsChangeConnection =
+        connect(editor->document(), &QTextDocument::contentsChange, this,
+                [this, editor](int position, int charsRemoved, int charsAdded) {
+                    onContentsChange(editor, position, charsRemoved, charsAdded);
+                });
+    document.completionConnection =
+        connect(editor, &Editor::CodeEditor::completionRequested, this,
+                [this, editor](int line, int column, QString const &prefix) {
+                    onCompletionRequested(editor, line, column, prefix);
+                });
+    document.destroyedConnection = connect(editor, &QObject::destroyed, this, [this, editor] {
+        const int index = indexOf(editor);
+        if (index != -1)
+            removeDocument(index, false);
+    });
+    documents.push_front(document);
+
+    sendDidOpen(documents.front());
+
+    const int limit = qMax(1, SettingsManager::get("LSP/Open Documents Limit " + language).toInt());
+    while (documents.size() > limit)
     {
-        LOG_WARN_IF(language != "C++", "Unknown language " << language);
-        lang = "cpp";
+        LOG_INFO("Closing the least recently used document " << INFO_OF(documents.back().path));
+        removeDocument(documents.size() - 1, true);
     }
-
-    lsp->didOpen(uri, code, lang);
 }
 
-void LanguageServer::closeDocument()
+void LanguageServer::closeDocument(Editor::CodeEditor *editor)
 {
-    LOG_WARN_IF(!isDocumentOpen(), "Cannot close the document, No document was open");
-    if (!isDocumentOpen())
-        return;
-
-    std::string uri = "file://" + openFile.toStdString();
-    lsp->didClose(uri);
-
-    openFile = "";
-    logger = nullptr;
-    m_editor = nullptr;
+    const int index = indexOf(editor);
+    LOG_WARN_IF(index == -1, "Cannot close the document, the document of the editor is not open");
+    if (index != -1)
+        removeDocument(index, true);
 }
 
 void LanguageServer::requestLinting()
 {
-    if (m_editor == nullptr || !isDocumentOpen())
+    if (lsp == nullptr)
         return;
 
-    std::vector<TextDocumentContentChangeEvent> changes;
-    TextDocumentContentChangeEvent e;
-    e.text = m_editor->toPlainText().toStdString();
-    changes.push_back(e);
-
-    std::string uri = "file://" + openFile.toStdString();
-    lsp->didChange(uri, changes, true);
+    for (auto &document : documents)
+        sendChanges(document);
 }
 
-bool LanguageServer::isDocumentOpen() const
+bool LanguageServer::isDocumentOpen(Editor::CodeEditor *editor) const
 {
-    return !openFile.isEmpty() && lsp != nullptr;
+    return indexOf(editor) != -1;
 }
 
 void LanguageServer::updateSettings()
@@ -130,43 +134,364 @@ void LanguageServer::updateSettings()
         lsp->exit();
         delete lsp;
         lsp = nullptr;
+        isInitialized = false;
+        initializePending = false;
+        textDocumentSync = FullSync;
+        completionRequests.clear();
+        completionCacheContext = CompletionContext();
+        stats.resetQueue();
     }
 
-    if (m_editor != nullptr)
-        m_editor->clearSquiggle();
+    for (const auto &document : documents)
+        document.editor->clearSquiggle();
 
     if (shouldCreateClient())
     {
         createClient();
 
         performConnection();
-        initializeLSP(openFile);
 
         LOG_INFO("Recreated Language server Process");
-        if (m_editor != nullptr)
+
+        // reopen the documents in the new server, the least recently used first
+        for (int i = documents.size() - 1; i >= 0; --i)
+            sendDidOpen(documents[i]);
+        LOG_INFO_IF(!documents.isEmpty(), "Reopened " << documents.size() << " documents after restart");
+    }
+}
+
+void LanguageServer::updatePath(Editor::CodeEditor *editor, QString const &newPath)
+{
+    const int index = indexOf(editor);
+    if (index == -1 || documents[index].path == newPath)
+        return;
+    auto *log = documents[index].logger;
+    const bool recent = index == 0;
+    openDocument(newPath, editor, log); // this replaces the document with the old path
+    if (!recent && documents.size() > 1)
+        documents.move(0, 1); // don't make it the most recently used one
+}
+
+QJsonObject LanguageServer::statistics() const
+{
+    int pendingChanges = 0;
+    for (const auto &document : documents)
+        pendingChanges += document.pendingChanges.size();
+
+    auto json = stats.toJson();
+    json["language"] = language;
+    json["running"] = lsp != nullptr;
+    json["openDocuments"] = documents.size();
+    json["pendingChanges"] = pendingChanges;
+    return json;
+}
+
+void LanguageServer::onContentsChange(Editor::CodeEditor *editor, int position, int charsRemoved, int charsAdded)
+{
+    const int index = indexOf(editor);
+    if (index == -1 || lsp == nullptr)
+        return;
+
+    auto &document = documents[index];
+    auto *textDocument = editor->document();
+    const int length = textDocument->characterCount() - 1; // without the paragraph separator at the end
+
+    // Qt counts the paragraph separator at the end in the change when the whole document is replaced
+    const int overflow =
+        qMax(0, qMax(position + charsRemoved - document.text.length(), position + charsAdded - length));
+    charsRemoved -= overflow;
+    charsAdded -= overflow;
+    if (charsRemoved < 0 || charsAdded < 0)
+    {
+        resyncDocument(document);
+        return;
+    }
+
+    QTextCursor cursor(textDocument);
+    cursor.setPosition(position);
+    cursor.setPosition(position + charsAdded, QTextCursor::KeepAnchor);
+    auto added = cursor.selectedText();
+    added.replace(QChar::ParagraphSeparator, '\n').replace(QChar::LineSeparator, '\n').replace(QChar::Nbsp, ' ');
+
+    const auto removed = document.text.mid(position, charsRemoved);
+    if (added == removed) // only the format is changed, e.g. by the syntax highlighter
+        return;
+
+    // the text before the position isn't changed, so the start of the range can be found in the new document
+    const auto block = textDocument->findBlock(position);
+    TextChange change;
+    change.startLine = block.blockNumber();
+    change.startCharacter = position - block.position();
+    const int removedLines = removed.count('\n');
+    change.endLine = change.startLine + removedLines;
+    change.endCharacter = removedLines == 0 ? change.startCharacter + removed.length()
+                                            : removed.length() - removed.lastIndexOf('\n') - 1;
+    change.text = added;
+
+    document.text.replace(position, charsRemoved, added);
+    if (document.text.length() != length)
+    {
+        LOG_WARN("The tracked text is out of sync with the editor " << INFO_OF(document.text.length())
+                                                                     << INFO_OF(length));
+        resyncDocument(document);
+        return;
+    }
+
+    document.pendingChanges.push_back(change);
+    stats.documentEdited(QString::fromStdString(uriOf(document.path)));
+}
+
+void LanguageServer::onCompletionRequested(Editor::CodeEditor *editor, int line, int column, QString const &prefix)
+{
+    const int index = indexOf(editor);
+    if (index == -1 || lsp == nullptr || !SettingsManager::get("LSP/Use Autocomplete " + language).toBool())
+        return;
+
+    activeCompletionContext.editor = editor;
+    activeCompletionContext.line = line;
+    activeCompletionContext.wordStart = column - prefix.length();
+    activeCompletionPrefix = prefix;
+
+    // The results for the start of the word are also valid when more characters are typed, only if the server didn't
+    // leave out any candidates. Show the cached ones anyway while waiting for the complete results.
+    if (completionCacheContext == activeCompletionContext)
+    {
+        showCompletions();
+        if (!completionCacheIncomplete)
+            return;
+    }
+
+    cancelCompletionRequests();
+
+    auto &document = documents[index];
+    sendChanges(document); // the server should complete the code with the typed characters
+
+    Position position;
+    position.line = line;
+    position.character = column;
+    CompletionRequest request;
+    request.id = lsp->completion(uriOf(document.path), position);
+    stats.requestSent("textDocument/completion", static_cast<qint64>(uriOf(document.path).size()));
+    request.context = activeCompletionContext;
+    completionRequests.push_back(request);
+}
+
+void LanguageServer::onCompletionResult(QJsonObject const &result)
+{
+    if (completionRequests.isEmpty())
+    {
+        LOG_WARN("Received a completion result without a request");
+        return;
+    }
+
+    const auto request = completionRequests.takeFirst();
+    if (request.cancelled)
+        return;
+
+    // LSPClient only passes object results, a CompletionItem[] result is lost and arrives as an empty object like null
+    LOG_INFO_IF(result.isEmpty(), "Received an empty completion result, it's either null or a lost array");
+    const auto items = result["items"].toArray();
+
+    completionCacheContext = request.context;
+    completionCacheIncomplete = result["isIncomplete"].toBool();
+    completionCache.clear();
+
+    // snippets are inserted as plain text, without the placeholders
+    static const QRegularExpression placeholderRegex(R"(\$\{\d+(:[^}]*)?\}|\$\d+)");
+
+    for (auto const &value : items)
+    {
+        const auto item = value.toObject();
+        CompletionCandidate candidate;
+        candidate.item.label = item["label"].toString().trimmed();
+        candidate.item.detail = item["detail"].toString();
+        if (item.contains("textEdit"))
+            candidate.item.insertText = item["textEdit"].toObject()["newText"].toString();
+        else
+            candidate.item.insertText = item["insertText"].toString();
+        if (candidate.item.insertText.isEmpty())
+            candidate.item.insertText = candidate.item.label;
+        else if (item["insertTextFormat"].toInt() == 2) // snippet
+            candidate.item.insertText.remove(placeholderRegex);
+        candidate.filterText = item.contains("filterText") ? item["filterText"].toString() : candidate.item.label;
+        candidate.sortText = item.contains("sortText") ? item["sortText"].toString() : candidate.item.label;
+        completionCache.push_back(candidate);
+    }
+
+    if (completionCacheContext == activeCompletionContext)
+        showCompletions();
+}
+
+void LanguageServer::showCompletions()
+{
+    static const int MAX_COMPLETION_ITEMS = 100;
+
+    QVector<QPair<int, const CompletionCandidate *>> matched; // the scores and the candidates
+    for (auto const &candidate : completionCache)
+    {
+        const int score =
+            activeCompletionPrefix.isEmpty() ? 0 : Util::fuzzyScore(activeCompletionPrefix, candidate.filterText);
+        if (score >= 0)
+            matched.push_back({score, &candidate});
+    }
+
+    const int count = qMin(matched.size(), MAX_COMPLETION_ITEMS);
+    std::partial_sort(matched.begin(), matched.begin() + count, matched.end(),
+                      [](QPair<int, const CompletionCandidate *> const &lhs,
+                         QPair<int, const CompletionCandidate *> const &rhs) {
+                          if (lhs.first != rhs.first)
+                              return lhs.first > rhs.first;
+                          return lhs.second->sortText < rhs.second->sortText;
+                      });
+
+    QVector<Editor::CodeEditor::CompletionItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i)
+        items.push_back(matched[i].second->item);
+    activeCompletionContext.editor->showCompletions(items);
+}
+
+void LanguageServer::cancelCompletionRequests()
+{
+    for (auto &request : completionRequests)
+    {
+        if (!request.cancelled)
         {
-            auto *tmpEditor = m_editor;
-            auto tmpPath = openFile;
-            auto *tmpLog = logger;
-            if (isDocumentOpen())
-                closeDocument();
-            openDocument(tmpPath, tmpEditor, tmpLog);
-            LOG_INFO("Reopened document after restart");
+            const QJsonObject param{{"id", QString::fromStdString(request.id)}};
+            lsp->sendNotification("$/cancelRequest", param);
+            stats.notificationSent("$/cancelRequest", LanguageServerStats::payloadSize(param));
+            request.cancelled = true;
         }
     }
 }
 
-void LanguageServer::updatePath(QString const &newPath)
+// Private methods
+void LanguageServer::sendChanges(Document &document)
 {
-    if (lsp == nullptr || (openFile == newPath))
+    if (lsp == nullptr || document.pendingChanges.isEmpty())
         return;
-    auto *tmpLogger = logger;
-    auto *tmpEditor = m_editor;
-    closeDocument();
-    openDocument(newPath, tmpEditor, tmpLogger);
+
+    std::vector<TextDocumentContentChangeEvent> changes;
+    qint64 bytes = 0;
+    if (textDocumentSync != IncrementalSync)
+    {
+        // the server doesn't accept ranged changes, send the whole text instead
+        TextChange change;
+        change.full = true;
+        change.text = document.text;
+        document.pendingChanges = {change};
+    }
+    for (const auto &change : document.pendingChanges)
+    {
+        TextDocumentContentChangeEvent e;
+        if (!change.full)
+        {
+            Range range;
+            range.start.line = change.startLine;
+            range.start.character = change.startCharacter;
+            range.end.line = change.endLine;
+            range.end.character = change.endCharacter;
+            e.range = option<Range>(range);
+        }
+        e.text = change.text.toStdString();
+        bytes += change.text.size();
+        changes.push_back(e);
+    }
+    document.pendingChanges.clear();
+
+    const auto uri = uriOf(document.path);
+    lsp->didChange(uri, changes, true);
+    stats.notificationSent("textDocument/didChange", bytes + static_cast<qint64>(uri.size()));
+    stats.documentSent(QString::fromStdString(uri));
+}
+
+void LanguageServer::resyncDocument(Document &document)
+{
+    document.text = document.editor->toPlainText();
+    TextChange change;
+    change.full = true;
+    change.text = document.text;
+    document.pendingChanges = {change}; // the earlier changes are replaced by the whole text
+}
+
+void LanguageServer::sendDidOpen(Document &document)
+{
+    document.text = document.editor->toPlainText();
+    document.pendingChanges.clear();
+
+    if (lsp == nullptr)
+        return;
+
+    if (!isInitialized)
+    {
+        initializeLSP(document.path);
+        isInitialized = true;
+    }
+
+    std::string lang;
+
+    if (language == "Java")
+        lang = "java";
+    else if (language == "Python")
+        lang = "python";
+    else
+    {
+        LOG_WARN_IF(language != "C++", "Unknown language " << language);
+        lang = "cpp";
+    }
+
+    const auto uri = uriOf(document.path);
+    const auto text = document.text.toStdString();
+    lsp->didOpen(uri, text, lang);
+    stats.notificationSent("textDocument/didOpen",
+                           static_cast<qint64>(uri.size() + lang.size()) + document.text.size());
+    stats.documentSent(QString::fromStdString(uri));
+}
+
+void LanguageServer::removeDocument(int index, bool clearSquiggles)
+{
+    auto document = documents.takeAt(index);
+    disconnect(document.contentsChangeConnection);
+    disconnect(document.destroyedConnection);
+    disconnect(document.completionConnection);
+    for (auto &request : completionRequests)
+    {
+        if (request.context.editor == document.editor)
+            request.cancelled = true; // the editor may be destroyed when the result arrives
+    }
+    if (completionCacheContext.editor == document.editor)
+        completionCacheContext = CompletionContext();
+    if (activeCompletionContext.editor == document.editor)
+        activeCompletionContext = CompletionContext();
+    if (clearSquiggles)
+        document.editor->clearSquiggle();
+    if (lsp != nullptr)
+    {
+        lsp->didClose(uriOf(document.path));
+        stats.notificationSent("textDocument/didClose", static_cast<qint64>(uriOf(document.path).size()));
+    }
+}
+
+int LanguageServer::indexOf(Editor::CodeEditor *editor) const
+{
+    for (int i = 0; i < documents.size(); ++i)
+    {
+        if (documents[i].editor == editor)
+            return i;
+    }
+    return -1;
+}
+
+MessageLogger *LanguageServer::logger() const
+{
+    return documents.isEmpty() ? nullptr : documents.front().logger;
+}
+
+std::string LanguageServer::uriOf(QString const &path)
+{
+    return "file://" + path.toStdString();
 }
 
-// Private methods
 bool LanguageServer::shouldCreateClient()
 {
     return SettingsManager::get("LSP/Use Linting " + language).toBool() ||
@@ -222,44 +547,81 @@ void LanguageServer::initializeLSP(QString const &filePath)
     std::string uri = "file://" + info.absoluteDir().absolutePath().toStdString();
     option<DocumentUri> rootUri(uri);
     lsp->initialize(rootUri);
+    initializePending = true;
+    stats.requestSent("initialize", uri.size());
 }
 // ---------------------------- LSP SLOTS ------------------------
 
 void LanguageServer::onLSPServerNotificationArrived(QString const &method, QJsonObject const &param)
 {
-    if (method == "textDocument/publishDiagnostics" && m_editor != nullptr) // Linting
+    stats.notificationReceived(method, LanguageServerStats::payloadSize(param));
+
+    if (method == "textDocument/publishDiagnostics") // Linting
     {
-        m_editor->clearSquiggle();
-        QJsonArray doc = QJsonDocument::fromVariant(param.toVariantMap()).object()["diagnostics"].toArray();
-        for (auto e : doc)
+        // route the diagnostics to the editor of the document, which may not be in the current tab
+        const auto uri = param["uri"].toString();
+        const auto decodedUri = QUrl::fromPercentEncoding(uri.toUtf8());
+        Editor::CodeEditor *editor = nullptr;
+        for (const auto &document : documents)
         {
-            QString tooltip = e.toObject()["message"].toString();
-            Editor::CodeEditor::SeverityLevel level = lspSeverity(e.toObject()["severity"].toInt());
-
-            auto beg = e.toObject()["range"].toObject()["start"].toObject();
-            auto end = e.toObject()["range"].toObject()["end"].toObject();
-
-            QPair<int, int> start;
-            QPair<int, int> stop;
+            const auto documentUri = QString::fromStdString(uriOf(document.path));
+            if (documentUri == uri || documentUri == decodedUri)
+            {
+                editor = document.editor;
+                break;
+            }
+        }
+        if (editor == nullptr)
+        {
+            LOG_INFO("Ignoring the diagnostics of a closed document " << INFO_OF(uri));
+            return;
+        }
 
-            start.first = beg["line"].toInt() + 1;
-            start.second = beg["character"].toInt();
+        QElapsedTimer timer;
+        timer.start();
+        editor->clearSquiggle();
+        for (auto const &value : param["diagnostics"].toArray())
+        {
+            const auto diagnostic = value.toObject();
+            const auto range = diagnostic["range"].toObject();
+            const auto beg = range["start"].toObject();
+            const auto end = range["end"].toObject();
 
-            stop.first = end["line"].toInt() + 1;
-            stop.second = end["character"].toInt();
+            QString tooltip = diagnostic["message"].toString();
+            tooltip.remove(" (fix available)"); // We do not provide quick fix so remove this text.
 
-            m_editor->addSquiggle(
-                level, start, stop,
-                tooltip.remove(" (fix available)")); // We do not provide quick fix so remove this text.
+            editor->addSquiggle(lspSeverity(diagnostic["severity"].toInt()),
+                                {beg["line"].toInt() + 1, beg["character"].toInt()},
+                                {end["line"].toInt() + 1, end["character"].toInt()}, tooltip);
         }
-        m_editor->highlightAllSquiggle();
+        editor->highlightAllSquiggle();
+        stats.diagnosticsReceived(uri, timer.elapsed());
     }
 }
 
-void LanguageServer::onLSPServerResponseArrived(QJsonObject const &method, // NOLINT: It can be made static.
-                                                QJsonObject const &param)
+void LanguageServer::onLSPServerResponseArrived(QJsonObject const &method, QJsonObject const &param)
 {
     LOG_INFO("Response from Server has arrived");
+
+    // The ids of the responses are not available, but completion requests are the only requests waiting for
+    // results except initialize, which is recognized by its capabilities. Any other response answers the oldest
+    // completion request, even if it's empty, so the later results are still paired with the right requests.
+    const auto bytes = LanguageServerStats::payloadSize(param);
+    if (param.contains("capabilities"))
+    {
+        initializePending = false;
+        stats.responseReceived("initialize", bytes);
+
+        // textDocumentSync is either a TextDocumentSyncKind or TextDocumentSyncOptions
+        const auto sync = param["capabilities"].toObject()["textDocumentSync"];
+        textDocumentSync = sync.isObject() ? sync.toObject()["change"].toInt(NoSync) : sync.toInt(NoSync);
+        LOG_INFO(INFO_OF(textDocumentSync));
+    }
+    else
+    {
+        stats.responseReceived("textDocument/completion", bytes);
+        onCompletionResult(param);
+    }
 }
 
 void LanguageServer::onLSPServerRequestArrived(QString const &method, // NOLINT: It can be made static.
@@ -270,6 +632,21 @@ void LanguageServer::onLSPServerRequestArrived(QString const &method, // NOLINT:
 
 void LanguageServer::onLSPServerErrorArrived(QJsonObject const &id, QJsonObject const &error)
 {
+    static const int REQUEST_CANCELLED = -32800;
+    if (initializePending)
+    {
+        // the requests are answered in order, and initialize is the first one
+        initializePending = false;
+    }
+    else if (!completionRequests.isEmpty())
+    {
+        // a failed completion request is answered too, otherwise the later results are paired with the wrong requests
+        const auto request = completionRequests.takeFirst();
+        stats.responseReceived("textDocument/completion", 0);
+        if (request.cancelled || error["code"].toInt() == REQUEST_CANCELLED)
+            return;
+    }
+
     QString ID;
     QString ERR;
     ID = QJsonDocument::fromVariant(id.toVariantMap()).toJson();
@@ -278,8 +655,8 @@ void LanguageServer::onLSPServerErrorArrived(QJsonObject const &id, QJsonObject
     LOG_ERR("ID is \n" << ID);
     LOG_ERR("ERR is \n" << ERR);
 
-    if (logger != nullptr)
-        logger->error(tr("Language Server [%1]").arg(language),
+    if (logger() != nullptr)
+        logger()->error(tr("Language Server [%1]").arg(language),
                       tr("Language server sent an error. Please check log for details."));
 }
 
@@ -287,6 +664,7 @@ void LanguageServer::onLSPServerProcessError(QProcess::ProcessError const &error
 {
     LOG_WARN_IF(error == QProcess::Crashed, "LSP Process errored out " << INFO_OF(error));
     LOG_ERR_IF(error != QProcess::Crashed, "LSP Process errored out " << INFO_OF(error));
+    auto *logger = this->logger();
     if (logger == nullptr)
         return;
     switch (error)
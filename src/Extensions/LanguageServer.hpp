@@ -15,11 +15,21 @@
  *
  */
 
+/*
+ * A LanguageServer talks to the language server of one language. It keeps the documents of several tabs open at the
+ * same time, so switching tabs doesn't make the server parse the code again. The least recently used documents are
+ * closed when there are more than the LSP/Open Documents Limit setting. The diagnostics of each document are shown
+ * in the editor of the document, even if it's not in the current tab.
+ * The completion results are cached, so the popup is updated locally while the word at the cursor is being typed.
+ */
+
 #ifndef LANGUAGE_SERVER_H
 #define LANGUAGE_SERVER_H
 
 #include "Editor/CodeEditor.hpp"
+#include "Extensions/LanguageServerStats.hpp"
 #include <QJsonObject>
+#include <QList>
 #include <QProcess>
 
 class MessageLogger;
@@ -35,14 +45,34 @@ class LanguageServer : public QObject
     explicit LanguageServer(QString const &lang);
     ~LanguageServer() override;
 
+    /**
+     * @brief open the document of an editor, or mark it as the most recently used one if it's already open
+     * @param path the path of the document
+     * @param editor the editor of the document, the document is closed when the editor is destroyed
+     * @param log the message logger of the tab of the editor
+     */
     void openDocument(QString const &path, Editor::CodeEditor *editor, MessageLogger *log);
-    void closeDocument();
+
+    /**
+     * @brief close the document of an editor, and clear its diagnostics
+     */
+    void closeDocument(Editor::CodeEditor *editor);
+
+    /**
+     * @brief send the changes of all open documents to the server, which lints the changed documents
+     */
     void requestLinting();
 
-    bool isDocumentOpen() const;
+    bool isDocumentOpen(Editor::CodeEditor *editor) const;
 
     void updateSettings();
-    void updatePath(QString const &);
+    void updatePath(Editor::CodeEditor *editor, QString const &newPath);
+
+    /**
+     * @brief the traffic and latency statistics of the server, together with the state of the open documents
+     * @returns a JSON object, see LanguageServerStats::toJson for the keys of the statistics
+     */
+    QJsonObject statistics() const;
 
   private slots:
     void onLSPServerNotificationArrived(QString const &method, QJsonObject const &param);
@@ -54,6 +84,122 @@ class LanguageServer : public QObject
     void onLSPServerNewStderr(const QString &content);
 
   private:
+    // a change of an open document, the range is in the text before the change, 0-based in UTF-16 code units
+    struct TextChange
+    {
+        bool full = false; // whether the whole text is replaced, the range is ignored if it is
+        int startLine = 0;
+        int startCharacter = 0;
+        int endLine = 0;
+        int endCharacter = 0;
+        QString text;
+    };
+
+    // a document opened in the server
+    struct Document
+    {
+        QString path;
+        Editor::CodeEditor *editor = nullptr;
+        MessageLogger *logger = nullptr;
+        QString text;                       // the text of the document after the pending changes
+        QVector<TextChange> pendingChanges; // the changes not sent to the server yet
+        QMetaObject::Connection contentsChangeConnection;
+        QMetaObject::Connection destroyedConnection;
+        QMetaObject::Connection completionConnection;
+    };
+
+    // an item of a completion result
+    struct CompletionCandidate
+    {
+        Editor::CodeEditor::CompletionItem item;
+        QString filterText; // the text matched with the typed prefix
+        QString sortText;   // the order of the candidates with the same score
+    };
+
+    // where completions are requested, the results are valid for the whole word starting at the same position
+    struct CompletionContext
+    {
+        Editor::CodeEditor *editor = nullptr;
+        int line = -1;
+        int wordStart = -1; // the column where the word before the cursor starts
+
+        bool operator==(const CompletionContext &other) const
+        {
+            return editor == other.editor && line == other.line && wordStart == other.wordStart;
+        }
+    };
+
+    // a textDocument/completion request which is not answered yet
+    struct CompletionRequest
+    {
+        std::string id;
+        CompletionContext context;
+        bool cancelled = false; // whether $/cancelRequest is sent, its result is ignored
+    };
+
+    /**
+     * @brief record an edit in an editor as a change to be sent in the next requestLinting
+     * @note the last three parameters are the same as QTextDocument::contentsChange
+     */
+    void onContentsChange(Editor::CodeEditor *editor, int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief show the cached completions or request new ones
+     * @note the last three parameters are the same as CodeEditor::completionRequested
+     */
+    void onCompletionRequested(Editor::CodeEditor *editor, int line, int column, QString const &prefix);
+
+    /**
+     * @brief cache the result of the oldest completion request, and show it if it's still wanted
+     * @param result the result sent by the server as a CompletionList, LSPClient passes an array or null as an empty
+     *               object
+     */
+    void onCompletionResult(QJsonObject const &result);
+
+    /**
+     * @brief filter the cached completions by the last typed prefix, and show them in the editor
+     */
+    void showCompletions();
+
+    /**
+     * @brief send $/cancelRequest for all unanswered completion requests
+     */
+    void cancelCompletionRequests();
+
+    /**
+     * @brief replace the whole document in the next requestLinting, when the edits can't be tracked
+     */
+    static void resyncDocument(Document &document);
+
+    /**
+     * @brief send the pending changes of a document to the server
+     */
+    void sendChanges(Document &document);
+
+    /**
+     * @brief send didOpen of a document to the server
+     */
+    void sendDidOpen(Document &document);
+
+    /**
+     * @brief close a document and forget it
+     * @param index the index of the document in documents
+     * @param clearSquiggles whether to clear the diagnostics in the editor, false if the editor is being destroyed
+     */
+    void removeDocument(int index, bool clearSquiggles);
+
+    /**
+     * @brief the index of the document of an editor in documents, or -1 if it's not open
+     */
+    int indexOf(Editor::CodeEditor *editor) const;
+
+    /**
+     * @brief the message logger of the most recently used document, nullptr if there are no documents
+     */
+    MessageLogger *logger() const;
+
+    static std::string uriOf(QString const &path);
+
     void performConnection();
     void createClient();
     bool shouldCreateClient();
@@ -61,12 +207,29 @@ class LanguageServer : public QObject
     static Editor::CodeEditor::SeverityLevel lspSeverity(int in);
     void initializeLSP(QString const &filePath);
 
-    Editor::CodeEditor *m_editor = nullptr;
-    MessageLogger *logger = nullptr;
+    // the values of TextDocumentSyncKind
+    enum TextDocumentSync
+    {
+        NoSync = 0,
+        FullSync = 1,
+        IncrementalSync = 2
+    };
+
     LSPClient *lsp = nullptr;
     bool isInitialized = false;
+    bool initializePending = false;  // whether the initialize request is sent and not answered yet
+    int textDocumentSync = FullSync; // how the server wants the changes, the whole text until it's initialized
     QString language;
-    QString openFile;
+    QList<Document> documents; // the open documents, the most recently used first
+
+    QList<CompletionRequest> completionRequests;  // the unanswered requests, the servers answer them in order
+    CompletionContext completionCacheContext;     // where the cached completions are requested
+    QVector<CompletionCandidate> completionCache; // the candidates sent by the server
+    bool completionCacheIncomplete = false;       // whether the server may have more candidates for longer prefixes
+    CompletionContext activeCompletionContext;    // where completions are wanted, by the last completionRequested
+    QString activeCompletionPrefix;               // the prefix of the last completionRequested
+
+    LanguageServerStats stats;
 };
 } // namespace Extensions
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/LanguageServerStats.hpp"
+#include <QJsonArray>
+#include <algorithm>
+#include <iterator>
+
+namespace Extensions
+{
+
+// the upper bounds of the histogram buckets in milliseconds, the last bucket is unbounded
+static const qint64 BOUNDS[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+static const int BUCKET_COUNT = std::end(BOUNDS) - std::begin(BOUNDS) + 1;
+
+LanguageServerStats::Histogram::Histogram() : buckets(BUCKET_COUNT)
+{
+}
+
+void LanguageServerStats::Histogram::add(qint64 ms)
+{
+    ++buckets[std::lower_bound(std::begin(BOUNDS), std::end(BOUNDS), ms) - std::begin(BOUNDS)];
+    total += ms;
+    max = qMax(max, ms);
+    ++samples;
+}
+
+qint64 LanguageServerStats::Histogram::count() const
+{
+    return samples;
+}
+
+qint64 LanguageServerStats::Histogram::percentile(double percent) const
+{
+    if (samples == 0)
+        return -1;
+    const qint64 rank = qMax<qint64>(1, qRound64(samples * percent / 100));
+    qint64 seen = 0;
+    for (int i = 0; i + 1 < BUCKET_COUNT; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return qMin(BOUNDS[i], max);
+    }
+    return max;
+}
+
+QJsonObject LanguageServerStats::Histogram::toJson() const
+{
+    QJsonArray counts;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        QJsonObject bucket;
+        bucket["le"] = i + 1 < BUCKET_COUNT ? QJsonValue(BOUNDS[i]) : QJsonValue("inf");
+        bucket["count"] = buckets[i];
+        counts.push_back(bucket);
+    }
+
+    QJsonObject json;
+    json["count"] = samples;
+    json["mean"] = samples == 0 ? 0 : double(total) / samples;
+    json["p50"] = percentile(50);
+    json["p90"] = percentile(90);
+    json["p99"] = percentile(99);
+    json["max"] = max;
+    json["buckets"] = counts;
+    return json;
+}
+
+LanguageServerStats::LanguageServerStats()
+{
+    clock.start();
+}
+
+qint64 LanguageServerStats::payloadSize(const QJsonValue &value)
+{
+    qint64 size = 0;
+    if (value.isString())
+        size = value.toString().size();
+    else if (value.isArray())
+    {
+        for (const auto &element : value.toArray())
+            size += payloadSize(element);
+    }
+    else if (value.isObject())
+    {
+        const auto object = value.toObject();
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it)
+            size += payloadSize(it.value());
+    }
+    return size;
+}
+
+void LanguageServerStats::requestSent(const QString &method, qint64 bytes)
+{
+    auto &stats = methods[method];
+    ++stats.sent;
+    stats.bytesSent += bytes;
+    pendingRequests[method].push_back(clock.elapsed());
+    maxQueueDepth = qMax(maxQueueDepth, queueDepth());
+}
+
+void LanguageServerStats::responseReceived(const QString &method, qint64 bytes)
+{
+    auto &stats = methods[method];
+    ++stats.received;
+    stats.bytesReceived += bytes;
+    auto &pending = pendingRequests[method];
+    if (!pending.isEmpty())
+        stats.latency.add(clock.elapsed() - pending.takeFirst());
+}
+
+void LanguageServerStats::notificationSent(const QString &method, qint64 bytes)
+{
+    auto &stats = methods[method];
+    ++stats.sent;
+    stats.bytesSent += bytes;
+}
+
+void LanguageServerStats::notificationReceived(const QString &method, qint64 bytes)
+{
+    auto &stats = methods[method];
+    ++stats.received;
+    stats.bytesReceived += bytes;
+}
+
+void LanguageServerStats::documentEdited(const QString &uri)
+{
+    if (!editTimes.contains(uri))
+        editTimes[uri] = clock.elapsed();
+}
+
+void LanguageServerStats::documentSent(const QString &uri)
+{
+    const auto now = clock.elapsed();
+    if (editTimes.contains(uri))
+        debounceLatency.add(now - editTimes.take(uri));
+    sendTimes[uri] = now;
+}
+
+void LanguageServerStats::diagnosticsReceived(const QString &uri, qint64 handlingTime)
+{
+    // the handling time is included, because the diagnostics are applied when this is called
+    if (sendTimes.contains(uri))
+        lintLatency.add(clock.elapsed() - handlingTime - sendTimes.take(uri));
+    diagnosticsHandling.add(handlingTime);
+}
+
+int LanguageServerStats::queueDepth() const
+{
+    int depth = 0;
+    for (const auto &pending : pendingRequests)
+        depth += pending.size();
+    return depth;
+}
+
+void LanguageServerStats::resetQueue()
+{
+    pendingRequests.clear();
+    sendTimes.clear();
+}
+
+QJsonObject LanguageServerStats::toJson() const
+{
+    QJsonObject methodsJson;
+    qint64 bytesSent = 0;
+    qint64 bytesReceived = 0;
+    for (auto it = methods.cbegin(); it != methods.cend(); ++it)
+    {
+        QJsonObject method;
+        method["sent"] = it->sent;
+        method["received"] = it->received;
+        method["bytesSent"] = it->bytesSent;
+        method["bytesReceived"] = it->bytesReceived;
+        if (it->latency.count() > 0)
+            method["latency"] = it->latency.toJson();
+        methodsJson[it.key()] = method;
+        bytesSent += it->bytesSent;
+        bytesReceived += it->bytesReceived;
+    }
+
+    QJsonObject json;
+    json["uptime"] = clock.elapsed();
+    json["bytesSent"] = bytesSent;
+    json["bytesReceived"] = bytesReceived;
+    json["queueDepth"] = queueDepth();
+    json["maxQueueDepth"] = maxQueueDepth;
+    json["methods"] = methodsJson;
+    json["debounceLatency"] = debounceLatency.toJson();
+    json["lintLatency"] = lintLatency.toJson();
+    json["diagnosticsHandling"] = diagnosticsHandling.toJson();
+    return json;
+}
+
+} // namespace Extensions
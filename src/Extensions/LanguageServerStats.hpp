@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The LanguageServerStats records the traffic between a LanguageServer and its server process: the number and the
+ * payload bytes of the messages of each method, the latency of the requests, and the time of the linting pipeline,
+ * i.e. from an edit to the didChange notification (the debounce), from didChange to publishDiagnostics (the server),
+ * and the time to apply the diagnostics (the client).
+ * The latencies are kept in histograms with fixed buckets, so recording is cheap and the memory is bounded.
+ * The payload bytes are estimated by the total length of the strings in the parameters, e.g. the URIs, the texts and
+ * the messages, without the keys, the numbers and the JSON-RPC envelope. The messages are not serialized again to
+ * count them, and the estimate is the same for every method.
+ */
+
+#ifndef LANGUAGESERVERSTATS_HPP
+#define LANGUAGESERVERSTATS_HPP
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+namespace Extensions
+{
+
+class LanguageServerStats
+{
+  public:
+    // a latency histogram in milliseconds
+    class Histogram
+    {
+      public:
+        Histogram();
+
+        void add(qint64 ms);
+
+        qint64 count() const;
+
+        /**
+         * @brief an upper bound of a percentile, the upper bound of the bucket it falls in
+         * @param percent the percentile in [0, 100]
+         * @returns the upper bound in milliseconds, -1 if it's empty, or the maximum if it's in the last bucket
+         */
+        qint64 percentile(double percent) const;
+
+        QJsonObject toJson() const;
+
+      private:
+        QVector<qint64> buckets; // the counts of the latencies in (BOUNDS[i-1], BOUNDS[i]], the last is unbounded
+        qint64 total = 0;        // the sum of the latencies
+        qint64 max = 0;
+        qint64 samples = 0;
+    };
+
+    // the messages of a method
+    struct MethodStats
+    {
+        qint64 sent = 0;
+        qint64 received = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+        Histogram latency; // from a request to its response, empty for notifications
+    };
+
+    LanguageServerStats();
+
+    /**
+     * @brief the estimated payload bytes of JSON parameters, the total length of the strings in them
+     */
+    static qint64 payloadSize(const QJsonValue &value);
+
+    void requestSent(const QString &method, qint64 bytes);
+
+    /**
+     * @brief the response of the oldest unanswered request of a method is received
+     */
+    void responseReceived(const QString &method, qint64 bytes);
+
+    void notificationSent(const QString &method, qint64 bytes);
+
+    void notificationReceived(const QString &method, qint64 bytes);
+
+    /**
+     * @brief a document is edited, the edit waits for the debounce timer before being sent
+     * @note only the first edit after the last didChange is timed
+     */
+    void documentEdited(const QString &uri);
+
+    /**
+     * @brief didOpen or didChange of a document is sent, the server is expected to publish its diagnostics
+     */
+    void documentSent(const QString &uri);
+
+    /**
+     * @brief the diagnostics of a document are received and applied
+     * @param handlingTime the time used to apply the diagnostics in the editor in milliseconds
+     */
+    void diagnosticsReceived(const QString &uri, qint64 handlingTime);
+
+    /**
+     * @brief the number of requests waiting for their responses
+     */
+    int queueDepth() const;
+
+    /**
+     * @brief forget the unanswered requests, e.g. when the server is restarted
+     */
+    void resetQueue();
+
+    QJsonObject toJson() const;
+
+  private:
+    QElapsedTimer clock;
+    QMap<QString, MethodStats> methods;
+    QMap<QString, QList<qint64>> pendingRequests; // the send times of the unanswered requests of each method
+    QMap<QString, qint64> editTimes;              // the times of the first unsent edits of the documents
+    QMap<QString, qint64> sendTimes;              // the times of the last didChange of the documents
+    Histogram debounceLatency;                    // from an edit to didChange
+    Histogram lintLatency;                        // from didChange to publishDiagnostics
+    Histogram diagnosticsHandling;                // the time to apply the diagnostics
+    int maxQueueDepth = 0;
+};
+
+} // namespace Extensions
+
+#endif // LANGUAGESERVERSTATS_HPP
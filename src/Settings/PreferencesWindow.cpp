@@ -195,7 +195,9 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .page(TRKEY("General"), {"Default Language"})
             .dir(TRKEY("C++"))
                 .page("C++ Commands", tr("%1 Commands").arg(tr("C++")),
-                      {"C++/Compile Command", "C++/Output Path", "C++/Run Arguments", "C++/Compiler Output Codec"})
+                      {"C++/Compile Command", "C++/Output Path", "C++/Compile Profiles", "C++/Sanitizer Profile", "C++/Run Arguments",
+                       "C++/Compiler Output Codec", "C++/Compiler Launcher", "C++/Fast Linker", "C++/Report Compile Time",
+                       "C++/Profiler", "C++/Gcov Command"})
                 .page("C++ Template", tr("%1 Template").arg(tr("C++")),
                       {"C++/Template Path", "C++/Template Cursor Position Regex",
                        "C++/Template Cursor Position Offset Type", "C++/Template Cursor Position Offset Characters"})
@@ -207,7 +209,8 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .end()
             .dir(TRKEY("Java"))
                 .page("Java Commands", tr("%1 Commands").arg(tr("Java")),
-                      {"Java/Compile Command", "Java/Output Path", "Java/Class Name", "Java/Run Command", "Java/Run Arguments", "Java/Compiler Output Codec"})
+                      {"Java/Compile Command", "Java/Output Path", "Java/Compile Profiles", "Java/Class Name", "Java/Run Command",
+                       "Java/Run Arguments", "Java/Compiler Output Codec", "Java/Compile Daemon"})
                 .page("Java Template", tr("%1 Template").arg(tr("Java")),
                       {"Java/Template Path", "Java/Template Cursor Position Regex", "Java/Template Cursor Position Offset Type",
                        "Java/Template Cursor Position Offset Characters"})
@@ -243,8 +246,12 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .page(TRKEY("Detached Execution"), {"Detached Run Terminal Program", "Detached Run Terminal Arguments"})
 #endif
             .page(TRKEY("Save Session"), {"Hot Exit/Enable", "Hot Exit/Auto Save", "Hot Exit/Auto Save Interval"})
+            .page(TRKEY("Tab Hibernation"), {"Tab Hibernation/Enable", "Tab Hibernation/Inactive Minutes"})
             .page(TRKEY("Bind file and problem"), {"Restore Old Problem Url", "Open Old File For Old Problem Url"})
-            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases"})
+            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases",
+                                        "Count Hardware Events"})
+            .page(TRKEY("File I/O"), {"File I/O/Input File", "File I/O/Output File"})
+            .page(TRKEY("Speculative Compilation"), {"Speculative Compilation/Enable", "Speculative Compilation/Delay"})
             .page(TRKEY("Load External File Changes"), {"Auto Load External Changes If No Unsaved Modification", "Ask For Loading External Changes"})
             .page(TRKEY("Stopwatch"), {"Display Stopwatch", "Toggle Stopwatch On Tab Switch", "Hide Stopwatch Result"})
         .end()
@@ -255,9 +262,12 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
                 .page(TRKEY("YAPF"), {"YAPF/Program", "YAPF/Arguments", "YAPF/Style"}, false)
             .end()
             .dir(TRKEY("Language Server"))
-                .page("C++ Server", tr("%1 Server").arg(tr("C++")), {"LSP/Use Linting C++", "LSP/Delay C++", "LSP/Path C++", "LSP/Args C++"})
-                .page("Java Server", tr("%1 Server").arg(tr("Java")), {"LSP/Use Linting Java", "LSP/Delay Java", "LSP/Path Java", "LSP/Args Java"})
-                .page("Python Server", tr("%1 Server").arg(tr("Python")), {"LSP/Use Linting Python", "LSP/Delay Python", "LSP/Path Python", "LSP/Args Python"})
+                .page("C++ Server", tr("%1 Server").arg(tr("C++")), {"LSP/Use Linting C++", "LSP/Use Autocomplete C++", "LSP/Delay C++", "LSP/Path C++", "LSP/Args C++",
+                    "LSP/Open Documents Limit C++"})
+                .page("Java Server", tr("%1 Server").arg(tr("Java")), {"LSP/Use Linting Java", "LSP/Use Autocomplete Java", "LSP/Delay Java", "LSP/Path Java", "LSP/Args Java",
+                    "LSP/Open Documents Limit Java"})
+                .page("Python Server", tr("%1 Server").arg(tr("Python")), {"LSP/Use Linting Python", "LSP/Use Autocomplete Python", "LSP/Delay Python", "LSP/Path Python", "LSP/Args Python",
+                    "LSP/Open Documents Limit Python"})
             .end()
             .page(TRKEY("Competitive Companion"), {"Competitive Companion/Enable", "Competitive Companion/Open New Tab",
                 "Competitive Companion/Set Time Limit For Tab", "Competitive Companion/Connection Port",
@@ -275,9 +285,12 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
                                    "Hotkey/Change View Mode", "Hotkey/Snippets"})
         .dir(TRKEY("Advanced"))
             .page(TRKEY("Update"), {"Check Update", "Beta"})
-            .page(TRKEY("Limits"), {"Default Time Limit", "Output Length Limit", "Output Display Length Limit", "Message Length Limit",
-                                    "HTML Diff Viewer Length Limit", "Open File Length Limit", "Display Test Case Length Limit"})
+            .page(TRKEY("Limits"), {"Default Time Limit", "Output Length Limit", "Bounded Output Capture",
+                                    "Bounded Output Head Length", "Bounded Output Tail Length", "Output Display Length Limit",
+                                    "Message Length Limit", "HTML Diff Viewer Length Limit", "Open File Length Limit",
+                                    "Display Test Case Length Limit"})
             .page(TRKEY("Network Proxy"), {"Proxy/Enabled", "Proxy/Type", "Proxy/Host Name", "Proxy/Port", "Proxy/User", "Proxy/Password"})
+            .page(TRKEY("Stall Detection"), {"Stall Detection/Enable", "Stall Detection/Threshold"})
         .end()
     .ensureAtTop();
 
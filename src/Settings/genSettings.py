@@ -121,6 +121,9 @@ def addDefaultPaths(obj):
         ("Export And Import Settings", "${settings}", "settings"),
         ("Export And Load Session", "${session}", "session"),
         ("Extract And Load Snippets", "${snippets}", "snippets"),
+        ("Export Language Server Statistics", "${statistics}", "statistics"),
+        ("Export Pipeline Trace", "${statistics}", "statistics"),
+        ("Export GUI Stalls", "${statistics}", "statistics"),
     ]
 
     for action in actions:
@@ -18,6 +18,7 @@
 #include "Util/FileUtil.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "generated/SettingsHelper.hpp"
 #include <QCoreApplication>
 #include <QDesktopServices>
@@ -70,6 +71,12 @@ QString fileNameWithSuffix(const QString &name, const QString &lang)
 
 bool saveFile(const QString &path, const QString &content, const QString &head, bool safe, MessageLogger *log,
               bool createDirectory)
+{
+    return saveFile(path, content.toUtf8(), head, safe, log, createDirectory);
+}
+
+bool saveFile(const QString &path, const QByteArray &content, const QString &head, bool safe, MessageLogger *log,
+              bool createDirectory)
 {
     if (createDirectory)
     {
@@ -88,7 +95,7 @@ bool saveFile(const QString &path, const QString &content, const QString &head,
             LOG_ERR("Failed to open [" << path << "]");
             return false;
         }
-        file.write(content.toUtf8());
+        file.write(content);
         if (!file.commit())
         {
             if (log != nullptr)
@@ -111,7 +118,7 @@ bool saveFile(const QString &path, const QString &content, const QString &head,
             LOG_ERR("unsafe: Failed to open [" << path << "]");
             return false;
         }
-        if (file.write(content.toUtf8()) == -1)
+        if (file.write(content) == -1)
         {
             if (log != nullptr)
                 log->error(head, QCoreApplication::translate("Util::FileUtil",
@@ -209,6 +216,7 @@ QPair<std::function<void()>, QString> revealInFileManager(const QString &filePat
             },
             QCoreApplication::translate("Util::FileUtil", "Reveal %1 in Explorer").arg(name)};
 #elif defined(Q_OS_UNIX)
+    Core::StallDetector::Operation operation("Query The Default File Manager");
     QProcess proc;
     proc.start("xdg-mime", QStringList() << "query"
                                          << "default"
@@ -40,6 +40,13 @@ QString fileNameFilter(bool cpp, bool java, bool python);
 bool saveFile(const QString &path, const QString &content, const QString &head = "Save File", bool safe = true,
               MessageLogger *log = nullptr, bool createDirectory = false);
 
+/**
+ * @brief save UTF-8 encoded content to a file without converting it to a QString first
+ * @note the parameters are the same as the QString overload
+ */
+bool saveFile(const QString &path, const QByteArray &content, const QString &head = "Save File", bool safe = true,
+              MessageLogger *log = nullptr, bool createDirectory = false);
+
 /**
  * @brief get the content of a file
  * @param path the path to the file
@@ -48,4 +48,53 @@ QString websiteLink(const QString &path)
         .url(QUrl::NormalizePathSegments);
 }
 
+QString shortNumber(qint64 number)
+{
+    static const char suffixes[] = {'K', 'M', 'G', 'T', 'P'};
+    if (number < 1000)
+        return QString::number(number);
+    double value = number;
+    int suffix = -1;
+    while (value >= 999.5 && suffix + 1 < static_cast<int>(sizeof(suffixes)))
+    {
+        value /= 1000;
+        ++suffix;
+    }
+    return QString::number(value, 'f', value < 9.95 ? 1 : 0) + suffixes[suffix];
+}
+
+int fuzzyScore(const QString &pattern, const QString &text)
+{
+    int score = 0;
+    int matched = 0;
+    int last = -1; // the index of the last matched character in text
+
+    for (int i = 0; i < text.length() && matched < pattern.length(); ++i)
+    {
+        if (text[i].toLower() != pattern[matched].toLower())
+            continue;
+
+        int bonus = 1;
+        if (i == 0)
+            bonus += 8;
+        else if (last == i - 1)
+            bonus += 5;
+        else if (text[i - 1] == '_' || (text[i].isUpper() && text[i - 1].isLower()))
+            bonus += 4;
+        if (text[i] == pattern[matched])
+            bonus += 1;
+        if (last != -1 && last != i - 1)
+            bonus -= qMin(i - last - 1, 3);
+
+        score += bonus;
+        last = i;
+        ++matched;
+    }
+
+    if (matched < pattern.length())
+        return -1;
+    // a weak match in a long text, e.g. "e" in the middle of a word, still matches
+    return qMax(0, score * 8 - qMin(text.length(), 64));
+}
+
 } // namespace Util
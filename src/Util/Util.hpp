@@ -29,6 +29,21 @@ QString sanitizeAnchorName(const QString &str);
 
 QString websiteLink(const QString &path = QString());
 
+/**
+ * @brief a short form of a large number, e.g. 999, 1.2K, 35M, 1.0G
+ */
+QString shortNumber(qint64 number);
+
+/**
+ * @brief score how well a text matches a pattern typed by the user, e.g. "pb" matches "push_back"
+ * @param pattern the typed pattern, whose characters must appear in the text in order, case-insensitively
+ * @param text the text to match
+ * @returns the score, which is non-negative and the higher the better, or -1 if the text doesn't match
+ * @note The characters are matched greedily. Matches at the start, at word boundaries, consecutive matches and
+ *       matches with the same case score higher, while gaps and longer texts score lower.
+ */
+int fuzzyScore(const QString &pattern, const QString &text);
+
 } // namespace Util
 
 #endif // UTIL_HPP
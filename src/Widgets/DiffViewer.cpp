@@ -18,6 +18,7 @@
 #include "Widgets/DiffViewer.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "third_party/diff_match_patch/diff_match_patch.h"
 #include <QHBoxLayout>
 #include <QLabel>
@@ -67,6 +68,7 @@ DiffViewer::DiffViewer(QWidget *parent) : QMainWindow(parent)
 
 void DiffViewer::setText(const QString &output, const QString &expected)
 {
+    Core::StallDetector::Operation operation("Show Diff");
     if (output.length() <= SettingsHelper::getHTMLDiffViewerLengthLimit() &&
         expected.length() <= SettingsHelper::getHTMLDiffViewerLengthLimit())
     {
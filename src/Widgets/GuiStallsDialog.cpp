@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/GuiStallsDialog.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/StallDetector.hpp"
+#include "Settings/DefaultPathManager.hpp"
+#include "Settings/SettingsManager.hpp"
+#include "Util/FileUtil.hpp"
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTextBrowser>
+#include <QVBoxLayout>
+
+namespace Widgets
+{
+GuiStallsDialog::GuiStallsDialog(QWidget *parent) : QDialog(parent)
+{
+    browser = new QTextBrowser(this);
+
+    auto *mainLayout = new QVBoxLayout(this);
+    auto *buttonLayout = new QHBoxLayout();
+
+    auto *refreshButton = new QPushButton(tr("Refresh"), this);
+    auto *clearButton = new QPushButton(tr("Clear"), this);
+    auto *saveButton = new QPushButton(tr("Save As JSON"), this);
+    auto *closeButton = new QPushButton(tr("Close"), this);
+
+    connect(refreshButton, &QPushButton::clicked, this, &GuiStallsDialog::refresh);
+    connect(clearButton, &QPushButton::clicked, this, &GuiStallsDialog::clear);
+    connect(saveButton, &QPushButton::clicked, this, &GuiStallsDialog::saveAsJson);
+    connect(closeButton, &QPushButton::clicked, this, &GuiStallsDialog::close);
+
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addWidget(clearButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(saveButton);
+    buttonLayout->addWidget(closeButton);
+
+    mainLayout->addWidget(browser);
+    mainLayout->addLayout(buttonLayout);
+
+    setWindowTitle(tr("GUI Stalls"));
+    resize(720, 560);
+
+    refresh();
+}
+
+void GuiStallsDialog::refresh()
+{
+    lastStalls = Core::StallDetector::toJson();
+
+    QString html = "<p>";
+    if (lastStalls["running"].toBool())
+        html += tr("A stall is recorded when the GUI doesn't respond for %1 ms.").arg(lastStalls["threshold"].toInt());
+    else
+        html += tr("The stall detector is not running. It can be enabled at %1.")
+                    .arg(SettingsManager::getPathText("Stall Detection/Enable"));
+    html += "<br />" +
+            tr("Stalls: %1, the longest: %2 ms")
+                .arg(lastStalls["totalStalls"].toVariant().toLongLong())
+                .arg(lastStalls["longestStall"].toVariant().toLongLong()) +
+            "</p>";
+
+    const auto stalls = lastStalls["stalls"].toArray();
+    if (!stalls.isEmpty())
+    {
+        html += "<table border=\"1\" cellpadding=\"3\" cellspacing=\"0\"><tr><th>" + tr("Time") + "</th><th>" +
+                tr("Duration (ms)") + "</th><th>" + tr("Operation") + "</th><th>" + tr("Event") + "</th></tr>";
+        // the latest stall first
+        for (int i = stalls.size() - 1; i >= 0; --i)
+        {
+            const auto stall = stalls[i].toObject();
+            html += QString("<tr><td>%1</td><td align=\"right\">%2</td><td>%3</td><td>%4</td></tr>")
+                        .arg(stall["time"].toString().toHtmlEscaped())
+                        .arg(stall["duration"].toVariant().toLongLong())
+                        .arg(stall["operation"].toString().toHtmlEscaped(), stall["event"].toString().toHtmlEscaped());
+        }
+        html += "</table>";
+    }
+
+    browser->setHtml(html);
+}
+
+void GuiStallsDialog::clear()
+{
+    Core::StallDetector::clear();
+    refresh();
+}
+
+void GuiStallsDialog::saveAsJson()
+{
+    auto path = DefaultPathManager::getSaveFileName("Export GUI Stalls", this, tr("Save GUI stalls"),
+                                                    tr("JSON Files") + " (*.json)");
+    if (path.isEmpty())
+        return;
+
+    LOG_INFO(INFO_OF(path));
+    if (!Util::saveFile(path, QJsonDocument(lastStalls).toJson(), "GUI Stalls"))
+        QMessageBox::warning(this, tr("GUI Stalls"), tr("Failed to save the GUI stalls to [%1]").arg(path));
+}
+} // namespace Widgets
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The GuiStallsDialog shows the latest stalls of the GUI recorded by Core::StallDetector, i.e. when and how long the
+ * GUI was frozen and what it was doing, so the blocking calls in the GUI thread can be found.
+ * The stalls can be saved as a JSON file.
+ */
+
+#ifndef GUISTALLSDIALOG_HPP
+#define GUISTALLSDIALOG_HPP
+
+#include <QDialog>
+#include <QJsonObject>
+
+class QTextBrowser;
+
+namespace Widgets
+{
+class GuiStallsDialog : public QDialog
+{
+    Q_OBJECT
+
+  public:
+    explicit GuiStallsDialog(QWidget *parent = nullptr);
+
+  private slots:
+    void refresh();
+    void clear();
+    void saveAsJson();
+
+  private:
+    QJsonObject lastStalls; // the stalls shown in the dialog, which are saved by saveAsJson
+    QTextBrowser *browser = nullptr;
+};
+} // namespace Widgets
+
+#endif // GUISTALLSDIALOG_HPP
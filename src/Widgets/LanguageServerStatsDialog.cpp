@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/LanguageServerStatsDialog.hpp"
+#include "Core/EventLogger.hpp"
+#include "Settings/DefaultPathManager.hpp"
+#include "Util/FileUtil.hpp"
+#include <QHBoxLayout>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTextBrowser>
+#include <QVBoxLayout>
+
+namespace Widgets
+{
+LanguageServerStatsDialog::LanguageServerStatsDialog(std::function<QJsonObject()> collect, QWidget *parent)
+    : QDialog(parent), collect(std::move(collect))
+{
+    browser = new QTextBrowser(this);
+
+    auto *mainLayout = new QVBoxLayout(this);
+    auto *buttonLayout = new QHBoxLayout();
+
+    auto *refreshButton = new QPushButton(tr("Refresh"), this);
+    auto *saveButton = new QPushButton(tr("Save As JSON"), this);
+    auto *closeButton = new QPushButton(tr("Close"), this);
+
+    connect(refreshButton, &QPushButton::clicked, this, &LanguageServerStatsDialog::refresh);
+    connect(saveButton, &QPushButton::clicked, this, &LanguageServerStatsDialog::saveAsJson);
+    connect(closeButton, &QPushButton::clicked, this, &LanguageServerStatsDialog::close);
+
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(saveButton);
+    buttonLayout->addWidget(closeButton);
+
+    mainLayout->addWidget(browser);
+    mainLayout->addLayout(buttonLayout);
+
+    setWindowTitle(tr("Language Server Statistics"));
+    resize(720, 560);
+
+    refresh();
+}
+
+void LanguageServerStatsDialog::refresh()
+{
+    lastStats = collect();
+    QString html;
+    for (auto it = lastStats.constBegin(); it != lastStats.constEnd(); ++it)
+        html += toHtml(it.key(), it.value().toObject());
+    browser->setHtml(html);
+}
+
+void LanguageServerStatsDialog::saveAsJson()
+{
+    auto path = DefaultPathManager::getSaveFileName("Export Language Server Statistics", this,
+                                                    tr("Save language server statistics"),
+                                                    tr("JSON Files") + " (*.json)");
+    if (path.isEmpty())
+        return;
+
+    LOG_INFO(INFO_OF(path));
+    if (!Util::saveFile(path, QJsonDocument(lastStats).toJson(), "Language Server Statistics"))
+    {
+        QMessageBox::warning(this, tr("Language Server Statistics"),
+                             tr("Failed to save the language server statistics to [%1]").arg(path));
+    }
+}
+
+QString LanguageServerStatsDialog::histogramRow(const QString &name, const QJsonObject &histogram)
+{
+    const auto ms = [&histogram](const QString &key) {
+        const auto value = histogram[key].toDouble();
+        return value < 0 ? QString("-") : QString::number(value, 'f', key == "mean" ? 1 : 0);
+    };
+    return QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
+        .arg(name.toHtmlEscaped())
+        .arg(histogram["count"].toVariant().toLongLong())
+        .arg(ms("mean"), ms("p50"), ms("p90"), ms("p99"), ms("max"));
+}
+
+QString LanguageServerStatsDialog::toHtml(const QString &language, const QJsonObject &stats)
+{
+    QString html = QString("<h2>%1</h2>").arg(language.toHtmlEscaped());
+    if (!stats["running"].toBool())
+        html += "<p>" + tr("The language server is not running.") + "</p>";
+
+    html += "<p>" +
+            tr("Uptime: %1 s, open documents: %2, pending changes: %3, requests in flight: %4 (max %5)")
+                .arg(stats["uptime"].toDouble() / 1000, 0, 'f', 1)
+                .arg(stats["openDocuments"].toInt())
+                .arg(stats["pendingChanges"].toInt())
+                .arg(stats["queueDepth"].toInt())
+                .arg(stats["maxQueueDepth"].toInt()) +
+            "<br />" +
+            tr("Payload sent: %1 bytes, received: %2 bytes")
+                .arg(stats["bytesSent"].toVariant().toLongLong())
+                .arg(stats["bytesReceived"].toVariant().toLongLong()) +
+            "</p>";
+
+    const QString latencyHeader = "<tr><th></th><th>" + tr("Count") + "</th><th>" + tr("Mean") + "</th><th>p50</th>" +
+                                  "<th>p90</th><th>p99</th><th>" + tr("Max") + "</th></tr>";
+
+    html += "<h3>" + tr("Linting (ms)") + "</h3><table border=\"1\" cellpadding=\"3\" cellspacing=\"0\">" +
+            latencyHeader + histogramRow(tr("Edit to didChange (debounce)"), stats["debounceLatency"].toObject()) +
+            histogramRow(tr("didChange to diagnostics (server)"), stats["lintLatency"].toObject()) +
+            histogramRow(tr("Applying diagnostics (editor)"), stats["diagnosticsHandling"].toObject()) + "</table>";
+
+    const auto methods = stats["methods"].toObject();
+    html += "<h3>" + tr("Messages") + "</h3><table border=\"1\" cellpadding=\"3\" cellspacing=\"0\"><tr><th>" +
+            tr("Method") + "</th><th>" + tr("Sent") + "</th><th>" + tr("Received") + "</th><th>" + tr("Bytes Sent") +
+            "</th><th>" + tr("Bytes Received") + "</th></tr>";
+    QString latencies;
+    for (auto it = methods.constBegin(); it != methods.constEnd(); ++it)
+    {
+        const auto method = it.value().toObject();
+        html += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
+                    .arg(it.key().toHtmlEscaped())
+                    .arg(method["sent"].toVariant().toLongLong())
+                    .arg(method["received"].toVariant().toLongLong())
+                    .arg(method["bytesSent"].toVariant().toLongLong())
+                    .arg(method["bytesReceived"].toVariant().toLongLong());
+        if (method.contains("latency"))
+            latencies += histogramRow(it.key(), method["latency"].toObject());
+    }
+    html += "</table>";
+
+    if (!latencies.isEmpty())
+    {
+        html += "<h3>" + tr("Request Latency (ms)") + "</h3><table border=\"1\" cellpadding=\"3\" cellspacing=\"0\">" +
+                latencyHeader + latencies + "</table>";
+    }
+
+    return html;
+}
+} // namespace Widgets
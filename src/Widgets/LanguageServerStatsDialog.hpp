@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The LanguageServerStatsDialog shows the statistics of the language servers, i.e. the latencies and the traffic of
+ * each method and the time of the linting pipeline, so the LSP settings can be tuned with real numbers.
+ * The statistics can be saved as a JSON file.
+ */
+
+#ifndef LANGUAGESERVERSTATSDIALOG_HPP
+#define LANGUAGESERVERSTATSDIALOG_HPP
+
+#include <QDialog>
+#include <QJsonObject>
+#include <functional>
+
+class QTextBrowser;
+
+namespace Widgets
+{
+class LanguageServerStatsDialog : public QDialog
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief construct a language server statistics dialog
+     * @param collect returns the statistics of each language server, keyed by the language
+     * @param parent the parent widget
+     */
+    explicit LanguageServerStatsDialog(std::function<QJsonObject()> collect, QWidget *parent = nullptr);
+
+  private slots:
+    void refresh();
+    void saveAsJson();
+
+  private:
+    static QString histogramRow(const QString &name, const QJsonObject &histogram);
+    static QString toHtml(const QString &language, const QJsonObject &stats);
+
+    std::function<QJsonObject()> collect;
+    QJsonObject lastStats; // the statistics shown in the dialog, which are saved by saveAsJson
+    QTextBrowser *browser = nullptr;
+};
+} // namespace Widgets
+
+#endif // LANGUAGESERVERSTATSDIALOG_HPP
@@ -54,6 +54,7 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     expectedLabel = new QLabel(tr("Expected"), this);
     runButton = new QPushButton(tr("Run"), this);
     diffButton = new QPushButton("**", this);
+    sanitizerButton = new QPushButton(this);
     delButton = new QPushButton(tr("Del"), this);
     inputEdit = new TestCaseEdit(TestCaseEdit::Input, index, log, in, this);
     outputEdit = new TestCaseEdit(TestCaseEdit::Output, index, log, QString(), this);
@@ -70,6 +71,7 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     inputUpLayout->addWidget(inputLabel);
     inputUpLayout->addWidget(runButton);
     outputUpLayout->addWidget(outputLabel);
+    outputUpLayout->addWidget(sanitizerButton);
     outputUpLayout->addWidget(diffButton);
     expectedUpLayout->addWidget(expectedLabel);
     expectedUpLayout->addWidget(delButton);
@@ -90,12 +92,17 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
 
     splitter->setChildrenCollapsible(false);
 
-    runButton->setToolTip(tr("Test on a single testcase"));
+    runButton->setToolTip(tr("Test on a single testcase, right click for profiling"));
+    runButton->setContextMenuPolicy(Qt::CustomContextMenu);
     diffButton->setToolTip(tr("Open the Diff Viewer"));
+    sanitizerButton->setStyleSheet("background: #e60");
+    sanitizerButton->hide();
 
     connect(checkBox, &QCheckBox::toggled, this, &TestCase::onCheckBoxToggled);
     connect(runButton, &QPushButton::clicked, this, &TestCase::onRunButtonClicked);
+    connect(runButton, &QPushButton::customContextMenuRequested, this, &TestCase::onRunButtonContextMenuRequested);
     connect(diffButton, &QPushButton::clicked, this, &TestCase::onDiffButtonClicked);
+    connect(sanitizerButton, &QPushButton::clicked, this, &TestCase::onSanitizerButtonClicked);
     connect(delButton, &QPushButton::clicked, this, &TestCase::onDelButtonClicked);
     connect(diffViewer, &DiffViewer::toLongForHtml, this, &TestCase::onToLongForHtml);
     connect(expectedEdit, &TestCaseEdit::requestCopyOutputToExpected, this,
@@ -107,13 +114,13 @@ void TestCase::setInput(const QString &text)
     inputEdit->modifyText(text);
 }
 
-void TestCase::setOutput(const QString &text)
+void TestCase::setOutput(const Core::OutputBuffer &output)
 {
-    outputEdit->modifyText(text);
+    outputEdit->setOutput(output);
     outputEdit->startAnimation();
 
     if (!diffViewer->isHidden())
-        diffViewer->setText(text, expected());
+        diffViewer->setText(output.text(), expected());
 }
 
 void TestCase::setExpected(const QString &text)
@@ -121,9 +128,29 @@ void TestCase::setExpected(const QString &text)
     expectedEdit->modifyText(text);
 }
 
+void TestCase::setSanitizerReports(const QVector<Core::SanitizerReport> &reports)
+{
+    LOG_INFO(INFO_OF(id) << INFO_OF(reports.size()));
+
+    sanitizerReports = reports;
+    if (reports.isEmpty())
+    {
+        sanitizerButton->hide();
+        return;
+    }
+
+    QStringList lines;
+    for (const auto &report : reports)
+        lines.push_back(report.toString());
+    sanitizerButton->setText(tr("San: %1").arg(reports.size()));
+    sanitizerButton->setToolTip(lines.join('\n'));
+    sanitizerButton->show();
+}
+
 void TestCase::clearOutput()
 {
     outputEdit->modifyText(QString());
+    setSanitizerReports({});
     currentVerdict = UNKNOWN;
     diffButton->setStyleSheet("");
     diffButton->setText("**");
@@ -254,6 +281,21 @@ void TestCase::onRunButtonClicked()
     emit requestRun(id);
 }
 
+void TestCase::onRunButtonContextMenuRequested(const QPoint &pos)
+{
+    auto *menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+    menu->addAction(tr("Profile Run"), [this] {
+        LOG_INFO("Profile run requested for " << INFO_OF(id));
+        emit requestProfileRun(id);
+    });
+    menu->addAction(tr("Count Line Executions"), [this] {
+        LOG_INFO("Coverage run requested for " << INFO_OF(id));
+        emit requestCoverageRun(id);
+    });
+    menu->popup(runButton->mapToGlobal(pos));
+}
+
 void TestCase::onDiffButtonClicked()
 {
     LOG_INFO("Diff button clicked for " << INFO_OF(id));
@@ -261,6 +303,15 @@ void TestCase::onDiffButtonClicked()
     Util::showWidgetOnTop(diffViewer);
 }
 
+void TestCase::onSanitizerButtonClicked()
+{
+    LOG_INFO("Sanitizer button clicked for " << INFO_OF(id));
+    QStringList lines;
+    for (const auto &report : qAsConst(sanitizerReports))
+        lines.push_back(report.toString());
+    QMessageBox::information(this, tr("Sanitizer Reports of Test Case #%1").arg(id + 1), lines.join("\n\n"));
+}
+
 void TestCase::onDelButtonClicked()
 {
     LOG_INFO("Del button clicked for " << INFO_OF(id));
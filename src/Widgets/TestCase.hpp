@@ -18,6 +18,8 @@
 #ifndef TESTCASE_HPP
 #define TESTCASE_HPP
 
+#include "Core/OutputBuffer.hpp"
+#include "Core/SanitizerReport.hpp"
 #include <QWidget>
 
 class MessageLogger;
@@ -51,8 +53,14 @@ class TestCase : public QWidget
     explicit TestCase(int index, MessageLogger *logger, QWidget *parent = nullptr, const QString &in = QString(),
                       const QString &exp = QString());
     void setInput(const QString &text);
-    void setOutput(const QString &text);
+    void setOutput(const Core::OutputBuffer &output);
     void setExpected(const QString &text);
+
+    /**
+     * @brief attach the reports of the sanitizer build on this test case, they are cleared with the output
+     */
+    void setSanitizerReports(const QVector<Core::SanitizerReport> &reports);
+
     void clearOutput();
     QString input() const;
     QString output() const;
@@ -71,11 +79,15 @@ class TestCase : public QWidget
   signals:
     void deleted(TestCase *widget);
     void requestRun(int index);
+    void requestProfileRun(int index);
+    void requestCoverageRun(int index);
 
   private slots:
     void onCheckBoxToggled(bool checked);
     void onRunButtonClicked();
+    void onRunButtonContextMenuRequested(const QPoint &pos);
     void onDiffButtonClicked();
+    void onSanitizerButtonClicked();
     void onDelButtonClicked();
     void onToLongForHtml();
 
@@ -86,11 +98,12 @@ class TestCase : public QWidget
     QVBoxLayout *inputLayout = nullptr, *outputLayout = nullptr, *expectedLayout = nullptr;
     QCheckBox *checkBox = nullptr;
     QLabel *inputLabel = nullptr, *outputLabel = nullptr, *expectedLabel = nullptr;
-    QPushButton *runButton = nullptr, *diffButton = nullptr, *delButton = nullptr;
+    QPushButton *runButton = nullptr, *diffButton = nullptr, *delButton = nullptr, *sanitizerButton = nullptr;
     TestCaseEdit *inputEdit = nullptr, *outputEdit = nullptr, *expectedEdit = nullptr;
     DiffViewer *diffViewer = nullptr;
     MessageLogger *log;
     Verdict currentVerdict = UNKNOWN;
+    QVector<Core::SanitizerReport> sanitizerReports;
     int id;
 };
 } // namespace Widgets
@@ -18,6 +18,7 @@
 #include "Widgets/TestCaseEdit.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "Settings/DefaultPathManager.hpp"
 #include "Util/FileUtil.hpp"
 #include <QApplication>
@@ -89,26 +90,53 @@ void TestCaseEdit::dropEvent(QDropEvent *event)
 
 void TestCaseEdit::modifyText(const QString &text, bool keepHistory)
 {
-    this->text = text;
+    if (role == Output)
+        output = Core::OutputBuffer(text.toUtf8());
+    else
+        this->text = text;
+
+    const int limit = role == Output ? SettingsHelper::getOutputDisplayLengthLimit()
+                                     : SettingsHelper::getDisplayTestCaseLengthLimit();
+
+    showText(text.left(limit + 1), keepHistory);
+}
+
+void TestCaseEdit::setOutput(const Core::OutputBuffer &output)
+{
+    this->output = output;
+    showText(output.left(SettingsHelper::getOutputDisplayLengthLimit() + 1), true);
+}
+
+QString TestCaseEdit::getText()
+{
+    if (role == Output)
+        return output.text();
+    if (!isReadOnly())
+        text = toPlainText();
+    return text;
+}
 
+void TestCaseEdit::showText(const QString &head, bool keepHistory)
+{
+    Core::StallDetector::Operation operation("Show Test Case Text");
     const int limit = role == Output ? SettingsHelper::getOutputDisplayLengthLimit()
                                      : SettingsHelper::getDisplayTestCaseLengthLimit();
 
     QString displayText;
 
-    if (text.length() <= limit)
+    if (head.length() <= limit)
     {
-        displayText = text;
+        displayText = head;
         if (role != Output)
             setReadOnly(false);
     }
     else
     {
-        LOG_INFO("Too long: " << INFO_OF(role) << INFO_OF(id) << INFO_OF(text.length()));
+        LOG_INFO("Too long: " << INFO_OF(role) << INFO_OF(id) << INFO_OF(limit));
 
         setReadOnly(true);
 
-        displayText = text.left(limit) + "...";
+        displayText = head.left(limit) + "...";
 
         const QString name = role == Input ? tr("Input") : (role == Output ? tr("Output") : tr("Expected"));
         const QString setLimitPlace = role == Output ? SettingsHelper::pathOfOutputDisplayLengthLimit()
@@ -134,13 +162,6 @@ void TestCaseEdit::modifyText(const QString &text, bool keepHistory)
     }
 }
 
-QString TestCaseEdit::getText()
-{
-    if (!isReadOnly())
-        text = toPlainText();
-    return text;
-}
-
 void TestCaseEdit::startAnimation()
 {
     int newHeight = qMin(fontMetrics().boundingRect("f").height() * (document()->lineCount() + 2),
@@ -164,7 +185,11 @@ void TestCaseEdit::onCustomContextMenuRequested(const QPoint &pos)
         LOG_INFO("Saving test case to file");
         QString fileName =
             DefaultPathManager::getSaveFileName("Save Test Case To A File", this, tr("Save test case to file"));
-        if (!fileName.isEmpty())
+        if (fileName.isEmpty())
+            return;
+        if (role == Output)
+            Util::saveFile(fileName, output.bytes(), tr("Save test case to file"), true, log);
+        else
             Util::saveFile(fileName, getText(), tr("Save test case to file"), true, log);
     });
 
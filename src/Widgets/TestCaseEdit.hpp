@@ -18,6 +18,7 @@
 #ifndef TESTCASEEDIT_HPP
 #define TESTCASEEDIT_HPP
 
+#include "Core/OutputBuffer.hpp"
 #include <QPlainTextEdit>
 
 class MessageLogger;
@@ -43,6 +44,13 @@ class TestCaseEdit : public QPlainTextEdit
     void dragMoveEvent(QDragMoveEvent *event) override;
     void dropEvent(QDropEvent *event) override;
     void modifyText(const QString &text, bool keepHistory = true);
+
+    /**
+     * @brief set the text of an Output editor without decoding the whole output
+     * @param output the output of the program, only the displayed part of it is decoded here
+     */
+    void setOutput(const Core::OutputBuffer &output);
+
     QString getText();
 
   public slots:
@@ -57,10 +65,18 @@ class TestCaseEdit : public QPlainTextEdit
   private:
     void loadFromFile(const QString &path);
 
+    /**
+     * @brief show the beginning of the text in the editor
+     * @param head the first (limit + 1) characters of the text, or the whole text if it's shorter
+     * @param keepHistory whether to keep the undo history
+     */
+    void showText(const QString &head, bool keepHistory);
+
   private:
     QPropertyAnimation *animation;
     MessageLogger *log;
     QString text;
+    Core::OutputBuffer output; // the text of an Output editor
     Role role;
     int id;
 };
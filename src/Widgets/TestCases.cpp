@@ -271,12 +271,18 @@ void TestCases::setInput(int index, const QString &input)
         testcases[index]->setInput(input);
 }
 
-void TestCases::setOutput(int index, const QString &output)
+void TestCases::setOutput(int index, const Core::OutputBuffer &output)
 {
     if (VALIDATE_INDEX(index))
         testcases[index]->setOutput(output);
 }
 
+void TestCases::setSanitizerReports(int index, const QVector<Core::SanitizerReport> &reports)
+{
+    if (VALIDATE_INDEX(index))
+        testcases[index]->setSanitizerReports(reports);
+}
+
 void TestCases::setExpected(int index, const QString &expected)
 {
     if (VALIDATE_INDEX(index))
@@ -297,6 +303,8 @@ void TestCases::addTestCase(const QString &input, const QString &expected)
         auto *testcase = new TestCase(count(), log, this, input, expected);
         connect(testcase, &TestCase::deleted, this, &TestCases::onChildDeleted);
         connect(testcase, &TestCase::requestRun, this, &TestCases::requestRun);
+        connect(testcase, &TestCase::requestProfileRun, this, &TestCases::requestProfileRun);
+        connect(testcase, &TestCase::requestCoverageRun, this, &TestCases::requestCoverageRun);
         testcases.push_back(testcase);
         scrollAreaLayout->addWidget(testcase);
         updateVerdicts();
@@ -19,6 +19,7 @@
 #define TESTCASES_HPP
 
 #include "Core/Checker.hpp"
+#include "Core/SanitizerReport.hpp"
 #include <QWidget>
 
 class MessageLogger;
@@ -46,7 +47,8 @@ class TestCases : public QWidget
     QString expected(int index) const;
 
     void setInput(int index, const QString &input);
-    void setOutput(int index, const QString &output);
+    void setOutput(int index, const Core::OutputBuffer &output);
+    void setSanitizerReports(int index, const QVector<Core::SanitizerReport> &reports);
     void setExpected(int index, const QString &expected);
 
     void loadStatus(const QStringList &inputList, const QStringList &expectedList);
@@ -90,6 +92,8 @@ class TestCases : public QWidget
   signals:
     void checkerChanged();
     void requestRun(int index);
+    void requestProfileRun(int index);
+    void requestCoverageRun(int index);
 
   private slots:
     void on_addButton_clicked();
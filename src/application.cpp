@@ -17,6 +17,7 @@
 
 #include "application.hpp"
 #include "Core/EventLogger.hpp"
+#include "Core/StallDetector.hpp"
 #include "appwindow.hpp"
 #include <QFileOpenEvent>
 
@@ -35,3 +36,9 @@ bool Application::event(QEvent *event)
     }
     return QApplication::event(event);
 }
+
+bool Application::notify(QObject *receiver, QEvent *event)
+{
+    Core::StallDetector::EventScope scope(receiver, event);
+    return SingleApplication::notify(receiver, event);
+}
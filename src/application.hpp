@@ -27,6 +27,11 @@ class Application : public SingleApplication
   public:
     explicit Application(int &argc, char **argv);
 
+    /**
+     * @brief dispatch an event, the outermost event in the GUI thread is recorded for Core::StallDetector
+     */
+    bool notify(QObject *receiver, QEvent *event) override;
+
   protected:
     bool event(QEvent *event) override;
 
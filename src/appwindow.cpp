@@ -20,7 +20,9 @@
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/PipelineTracer.hpp"
 #include "Core/SessionManager.hpp"
+#include "Core/StallDetector.hpp"
 #include "Core/StyleManager.hpp"
 #include "Core/Translator.hpp"
 #include "Extensions/CFTool.hpp"
@@ -33,11 +35,14 @@
 #include "Telemetry/UpdateChecker.hpp"
 #include "Util/FileUtil.hpp"
 #include "Util/Util.hpp"
+#include "Widgets/GuiStallsDialog.hpp"
+#include "Widgets/LanguageServerStatsDialog.hpp"
 #include "Widgets/SupportUsDialog.hpp"
 #include "application.hpp"
 #include "generated/SettingsHelper.hpp"
 #include "generated/portable.hpp"
 #include "generated/version.hpp"
+#include <QActionGroup>
 #include <QClipboard>
 #include <QDesktopServices>
 #include <QDragEnterEvent>
@@ -218,6 +223,8 @@ AppWindow::~AppWindow()
     delete sessionManager;
     delete wakaTime;
 
+    Core::StallDetector::stop();
+
     SettingsManager::deinit();
 
     LOG_INFO("Destruction finished");
@@ -276,6 +283,11 @@ void AppWindow::setConnections()
     connect(lspTimerCpp, &QTimer::timeout, this, &AppWindow::onLSPTimerElapsedCpp);
     connect(lspTimerJava, &QTimer::timeout, this, &AppWindow::onLSPTimerElapsedJava);
     connect(lspTimerPython, &QTimer::timeout, this, &AppWindow::onLSPTimerElapsedPython);
+    connect(hibernationTimer, &QTimer::timeout, this, &AppWindow::hibernateInactiveTabs);
+    if (SettingsHelper::isTabHibernationEnable())
+        hibernationTimer->start();
+    if (SettingsHelper::isStallDetectionEnable())
+        Core::StallDetector::start(SettingsHelper::getStallDetectionThreshold());
 
     connect(preferencesWindow, &PreferencesWindow::settingsApplied, this, &AppWindow::onSettingsApplied);
 
@@ -293,6 +305,8 @@ void AppWindow::allocate()
     lspTimerCpp = new QTimer();
     lspTimerJava = new QTimer();
     lspTimerPython = new QTimer();
+    hibernationTimer = new QTimer(this);
+    hibernationTimer->setInterval(60 * 1000);
     updateChecker = new Telemetry::UpdateChecker();
     preferencesWindow = new PreferencesWindow(this);
 
@@ -321,6 +335,11 @@ void AppWindow::allocate()
     trayIcon->show();
 
     sessionManager = new Core::SessionManager(this);
+    connect(sessionManager, &Core::SessionManager::tabHibernated, this, [this](MainWindow *window, qint64 freed) {
+        hibernationSavings += freed;
+        LOG_INFO("Hibernated " << INFO_OF(window->getTabTitle(true, false)) << INFO_OF(freed)
+                               << INFO_OF(hibernationSavings));
+    });
 
     wakaTime = new Extensions::WakaTime(this);
 }
@@ -420,6 +439,7 @@ void AppWindow::saveSettings()
 
 void AppWindow::openTab(MainWindow *window, MainWindow *after)
 {
+    sessionManager->trackWindow(window);
     connect(window, &MainWindow::confirmTriggered, this, &AppWindow::onConfirmTriggered);
     connect(window, &MainWindow::editorFileChanged, this, &AppWindow::onEditorFileChanged);
     connect(window, &MainWindow::requestUpdateLanguageServerFilePath, this, &AppWindow::updateLanguageServerFilePath);
@@ -439,9 +459,9 @@ void AppWindow::openTab(MainWindow *window, MainWindow *after)
     onEditorFileChanged();
 }
 
-void AppWindow::openTab(const MainWindow::EditorStatus &status, bool duplicate, MainWindow *after)
+void AppWindow::openTab(const MainWindow::EditorStatus &status, bool duplicate, MainWindow *after, bool deferred)
 {
-    auto *newWindow = new MainWindow(status, duplicate, getNewUntitledIndex(), this);
+    auto *newWindow = new MainWindow(status, duplicate, getNewUntitledIndex(), this, deferred);
     openTab(newWindow, after);
 }
 
@@ -544,7 +564,7 @@ bool AppWindow::quit()
     if (SettingsHelper::isHotExitEnable() || SettingsHelper::isForceClose())
     {
         LOG_INFO("quit() with hotexit");
-        sessionManager->updateSession();
+        sessionManager->updateSessionAndWait();
     }
     else
     {
@@ -770,12 +790,18 @@ void AppWindow::on_actionImportSettings_triggered()
 
 void AppWindow::on_actionExportSession_triggered()
 {
+    const auto binaryFilter = tr("CP Editor Session File") + " (*.cpsession)";
+    const auto jsonFilter = tr("CP Editor Session File in JSON") + " (*.json)";
+    QString selectedFilter;
     auto path =
         DefaultPathManager::getSaveFileName("Export And Load Session", this, tr("Export current session to a file"),
-                                            tr("CP Editor Session File") + " (*.json)");
+                                            binaryFilter + ";;" + jsonFilter, &selectedFilter);
     if (!path.isEmpty())
     {
-        if (!Util::saveFile(path, sessionManager->currentSessionText(), "Export Session"))
+        const bool ok = selectedFilter == jsonFilter || path.endsWith(".json", Qt::CaseInsensitive)
+                            ? Util::saveFile(path, sessionManager->currentSessionText(), "Export Session")
+                            : Util::saveFile(path, sessionManager->currentSessionData(), "Export Session");
+        if (!ok)
         {
             QMessageBox::warning(this, tr("Export Session"),
                                  tr("Failed to export the current session to [%1]").arg(path));
@@ -793,7 +819,7 @@ void AppWindow::on_actionLoadSession_triggered()
         return;
 
     auto path = DefaultPathManager::getOpenFileName("Export And Load Session", this, tr("Load session from a file"),
-                                                    tr("CP Editor Session File") + " (*.json)");
+                                                    tr("CP Editor Session File") + " (*.cpsession *.json)");
     if (!path.isEmpty())
         sessionManager->restoreSession(path);
 }
@@ -862,14 +888,6 @@ void AppWindow::onTabChanged(int index)
         server->setMessageLogger(nullptr);
         findReplaceDialog->setTextEdit(nullptr);
         setWindowTitle(tr("CP Editor: An editor specially designed for competitive programming"));
-
-        if (cppServer->isDocumentOpen())
-            cppServer->closeDocument();
-        if (pythonServer->isDocumentOpen())
-            pythonServer->closeDocument();
-        if (javaServer->isDocumentOpen())
-            javaServer->closeDocument();
-
         return;
     }
 
@@ -878,6 +896,8 @@ void AppWindow::onTabChanged(int index)
 
     auto *tmp = windowAt(index);
 
+    tmp->loadDeferredStatus(); // the tabs restored from a session are loaded when they are activated
+
     reAttachLanguageServer(tmp);
 
     findReplaceDialog->setTextEdit(tmp->getEditor());
@@ -975,15 +995,13 @@ void AppWindow::onEditorTextChanged(MainWindow *window)
 
 void AppWindow::updateLanguageServerFilePath(MainWindow *window, const QString &path)
 {
-    if (currentWindow() == window)
-    {
-        if (window->getLanguage() == "C++" && cppServer->isDocumentOpen())
-            cppServer->updatePath(path);
-        else if (window->getLanguage() == "Java" && javaServer->isDocumentOpen())
-            javaServer->updatePath(path);
-        else if (window->getLanguage() == "Python" && pythonServer->isDocumentOpen())
-            pythonServer->updatePath(path);
-    }
+    // the documents of the tabs not in the front are open as well
+    if (window->getLanguage() == "C++")
+        cppServer->updatePath(window->getEditor(), path);
+    else if (window->getLanguage() == "Java")
+        javaServer->updatePath(window->getEditor(), path);
+    else if (window->getLanguage() == "Python")
+        pythonServer->updatePath(window->getEditor(), path);
 }
 
 void AppWindow::onEditorLanguageChanged(MainWindow *window)
@@ -1094,6 +1112,30 @@ void AppWindow::onSettingsApplied(const QString &pagePath)
         sessionManager->setAutoUpdateSession(SettingsHelper::isHotExitEnable() && SettingsHelper::isHotExitAutoSave());
     }
 
+    if (pageChanged("Actions/Tab Hibernation"))
+    {
+        if (SettingsHelper::isTabHibernationEnable())
+            hibernationTimer->start();
+        else
+            hibernationTimer->stop();
+    }
+
+    if (pageChanged("Language/C++/C++ Commands"))
+    {
+        // probe the compiler in advance, so the column unit is already known for the first compilation
+        const auto command = QProcess::splitCommand(SettingsHelper::getCppCompileCommand());
+        if (!command.isEmpty())
+            Core::Compiler::probeColumnUnit(command.first());
+    }
+
+    if (pageChanged("Advanced/Stall Detection"))
+    {
+        if (SettingsHelper::isStallDetectionEnable())
+            Core::StallDetector::start(SettingsHelper::getStallDetectionThreshold());
+        else
+            Core::StallDetector::stop();
+    }
+
     if (pageChanged("File Path/Default Paths"))
     {
         DefaultPathManager::fromVariantList(SettingsHelper::getDefaultPathNamesAndPaths());
@@ -1248,6 +1290,12 @@ void AppWindow::on_actionRunDetached_triggered()
     }
 }
 
+void AppWindow::on_actionCompileRunWithSanitizers_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->compileAndRunWithSanitizers();
+}
+
 void AppWindow::on_actionKillProcesses_triggered()
 {
     if (currentWindow() != nullptr)
@@ -1453,10 +1501,32 @@ void AppWindow::onTabContextMenuRequested(const QPoint &pos)
         tabMenu->addSeparator();
 
         if (window->getLanguage() != "Python")
+        {
             tabMenu->addAction(tr("Set Compile Command"), [window] { window->updateCompileCommand(); });
 
+            const auto profiles = window->compileProfileNames();
+            if (!profiles.isEmpty())
+            {
+                auto *profileMenu = tabMenu->addMenu(tr("Compile Profile"));
+                auto *profileGroup = new QActionGroup(profileMenu);
+                for (const auto &profile : QStringList{QString()} + profiles)
+                {
+                    auto *action = profileMenu->addAction(profile.isEmpty() ? tr("Default") : profile,
+                                                          [window, profile] { window->setCompileProfile(profile); });
+                    action->setCheckable(true);
+                    action->setChecked(window->getCompileProfile() == profile);
+                    profileGroup->addAction(action);
+                }
+                tabMenu->addAction(tr("Compile All Profiles"), [window] { window->compileAllProfiles(); });
+            }
+        }
+
         tabMenu->addAction(tr("Set Time Limit"), [window] { window->updateTimeLimit(); });
 
+        auto *fileIOAction = tabMenu->addAction(tr("File I/O"), [window](bool checked) { window->setFileIO(checked); });
+        fileIOAction->setCheckable(true);
+        fileIOAction->setChecked(window->isFileIO());
+
         LOG_INFO(INFO_OF(filePath));
 
         const auto outputFilePath =
@@ -1530,38 +1600,61 @@ MainWindow *AppWindow::currentWindow()
 
 void AppWindow::reAttachLanguageServer(MainWindow *window)
 {
-    window->getEditor()->clearSquiggle();
     lspTimerCpp->stop();
     lspTimerJava->stop();
     lspTimerPython->stop();
 
-    if (cppServer->isDocumentOpen())
-        cppServer->closeDocument();
-    if (javaServer->isDocumentOpen())
-        javaServer->closeDocument();
-    if (pythonServer->isDocumentOpen())
-        pythonServer->closeDocument();
+    // The documents of the other tabs are kept open, so the servers don't parse them again when switching back.
+    // Only close the document in the servers of the other languages, in case the language of the tab is changed.
+    auto *editor = window->getEditor();
+    if (window->getLanguage() != "C++" && cppServer->isDocumentOpen(editor))
+        cppServer->closeDocument(editor);
+    if (window->getLanguage() != "Java" && javaServer->isDocumentOpen(editor))
+        javaServer->closeDocument(editor);
+    if (window->getLanguage() != "Python" && pythonServer->isDocumentOpen(editor))
+        pythonServer->closeDocument(editor);
 
     if (window->getLanguage() == "C++")
     {
-        cppServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
+        cppServer->openDocument(window->filePathOrTmpPath(), editor, window->getLogger());
         cppServer->requestLinting();
         lspTimerCpp->start();
     }
     else if (window->getLanguage() == "Java")
     {
-        javaServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
+        javaServer->openDocument(window->filePathOrTmpPath(), editor, window->getLogger());
         javaServer->requestLinting();
         lspTimerJava->start();
     }
     else if (window->getLanguage() == "Python")
     {
-        pythonServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
+        pythonServer->openDocument(window->filePathOrTmpPath(), editor, window->getLogger());
         pythonServer->requestLinting();
         lspTimerPython->start();
     }
 }
 
+void AppWindow::hibernateInactiveTabs()
+{
+    const qint64 limit = SettingsHelper::getTabHibernationInactiveMinutes() * 60LL * 1000;
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+    {
+        auto *window = windowAt(i);
+        if (window == currentWindow() || !window->canHibernate() || window->inactiveTime() < limit)
+            continue;
+
+        // the document is reopened by reAttachLanguageServer when the tab is activated
+        auto *editor = window->getEditor();
+        for (auto *languageServer : {cppServer, javaServer, pythonServer})
+        {
+            if (languageServer->isDocumentOpen(editor))
+                languageServer->closeDocument(editor);
+        }
+
+        sessionManager->hibernate(window);
+    }
+}
+
 MainWindow *AppWindow::windowAt(int index)
 {
     if (index == -1)
@@ -1586,6 +1679,65 @@ void AppWindow::on_actionClearLogs_triggered()
     }
 }
 
+void AppWindow::on_actionLanguageServerStats_triggered()
+{
+    auto *dialog = new Widgets::LanguageServerStatsDialog(
+        [this] {
+            QJsonObject stats;
+            stats["C++"] = cppServer->statistics();
+            stats["Java"] = javaServer->statistics();
+            stats["Python"] = pythonServer->statistics();
+            return stats;
+        },
+        this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+void AppWindow::on_actionGuiStalls_triggered()
+{
+    auto *dialog = new Widgets::GuiStallsDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+void AppWindow::on_actionExportPipelineTrace_triggered()
+{
+    auto path = DefaultPathManager::getSaveFileName(
+        "Export Pipeline Trace", this, tr("Export the trace of the latest compilations and executions"),
+        tr("Chrome Trace File") + " (*.json)");
+    if (!path.isEmpty() && !Util::saveFile(path, Core::PipelineTracer::toTraceJson(), "Export Pipeline Trace"))
+    {
+        QMessageBox::warning(this, tr("Export Pipeline Trace"),
+                             tr("Failed to export the pipeline trace to [%1]").arg(path));
+    }
+}
+
+void AppWindow::on_actionTabMemoryUsage_triggered()
+{
+    const auto kib = [](qint64 bytes) { return QString::number((bytes + 1023) / 1024); };
+
+    QString rows;
+    qint64 total = 0;
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+    {
+        auto *window = windowAt(i);
+        const auto usage = window->memoryUsage();
+        total += usage;
+        rows += QString("<tr><td>%1</td><td>%2</td><td align=\"right\">%3</td></tr>")
+                    .arg(window->getTabTitle(true, false).toHtmlEscaped())
+                    .arg(window->isHibernated() ? tr("Hibernated") : tr("Loaded"))
+                    .arg(kib(usage));
+    }
+
+    QMessageBox::information(
+        this, tr("Tab Memory Usage"),
+        tr("<p>The estimated memory used by the code and the test cases of each tab.</p>"
+           "<table cellpadding=\"3\"><tr><th>Tab</th><th>State</th><th>KiB</th></tr>%1</table>"
+           "<p>Total: %2 KiB<br />Freed by hibernation in this session: %3 KiB</p>")
+            .arg(rows, kib(total), kib(hibernationSavings)));
+}
+
 void AppWindow::showOnTop()
 {
     Util::showWidgetOnTop(this);
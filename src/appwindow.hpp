@@ -144,6 +144,8 @@ class AppWindow : public QMainWindow
 
     void on_actionRunDetached_triggered();
 
+    void on_actionCompileRunWithSanitizers_triggered();
+
     void on_actionKillProcesses_triggered();
 
     void on_actionUseSnippets_triggered();
@@ -176,6 +178,14 @@ class AppWindow : public QMainWindow
 
     void on_actionClearLogs_triggered();
 
+    void on_actionLanguageServerStats_triggered();
+
+    void on_actionTabMemoryUsage_triggered();
+
+    void on_actionExportPipelineTrace_triggered();
+
+    void on_actionGuiStalls_triggered();
+
     // Non-UI Slots
 
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
@@ -231,6 +241,9 @@ class AppWindow : public QMainWindow
     QTimer *lspTimerPython = nullptr;
     QTimer *lspTimerJava = nullptr;
 
+    QTimer *hibernationTimer = nullptr; // checks for the tabs to hibernate periodically
+    qint64 hibernationSavings = 0;      // the estimated memory freed by hibernating tabs in bytes
+
     QMetaObject::Connection activeSplitterMoveConnection;
     QMetaObject::Connection activeRightSplitterMoveConnection;
     Telemetry::UpdateChecker *updateChecker = nullptr;
@@ -260,7 +273,8 @@ class AppWindow : public QMainWindow
     void maybeSetHotkeys();
     bool closeTab(int index);
     void openTab(MainWindow *window, MainWindow *after = nullptr);
-    void openTab(const MainWindow::EditorStatus &status, bool duplicate = false, MainWindow *after = nullptr);
+    void openTab(const MainWindow::EditorStatus &status, bool duplicate = false, MainWindow *after = nullptr,
+                 bool deferred = false);
     void openTabs(const QStringList &paths);
     void openPaths(const QStringList &paths, bool cpp = true, bool java = true, bool python = true, int depth = -1);
     QStringList openFolder(const QString &path, bool cpp, bool java, bool python, int depth);
@@ -268,6 +282,11 @@ class AppWindow : public QMainWindow
     bool quit();
     int getNewUntitledIndex();
     void reAttachLanguageServer(MainWindow *window);
+
+    /**
+     * @brief hibernate the tabs which are inactive for longer than the Tab Hibernation/Inactive Minutes setting
+     */
+    void hibernateInactiveTabs();
     void triggerWakaTime(MainWindow *window, bool isWrite = false);
 
     MainWindow *currentWindow();
@@ -19,9 +19,16 @@
 
 #include "Core/Checker.hpp"
 #include "Core/Compiler.hpp"
+#include "Core/Coverage.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/PipelineTracer.hpp"
+#include "Core/Profiler.hpp"
 #include "Core/Runner.hpp"
+#include "Core/SanitizerReport.hpp"
+#include "Core/SessionStore.hpp"
+#include "Core/SpeculativeCompiler.hpp"
+#include "Core/StallDetector.hpp"
 #include "Editor/CodeEditor.hpp"
 #include "Extensions/CFTool.hpp"
 #include "Extensions/ClangFormatter.hpp"
@@ -31,6 +38,7 @@
 #include "Settings/FileProblemBinder.hpp"
 #include "Settings/PreferencesWindow.hpp"
 #include "Util/FileUtil.hpp"
+#include "Util/Util.hpp"
 #include "Widgets/Stopwatch.hpp"
 #include "Widgets/TestCases.hpp"
 #include "appwindow.hpp"
@@ -42,20 +50,30 @@
 #include <QMimeData>
 #include <QRegularExpression>
 #include <QScrollBar>
+#include <QSignalBlocker>
 #include <QTemporaryDir>
 #include <QTextBlock>
 #include <QTimer>
+#include <cmath>
 
 #include "../ui/ui_mainwindow.h"
 
 static const int MAX_NUMBER_OF_RECENT_FILES = 20;
 
+// the sanitizer build is several times slower, and its time doesn't count, so it has a much looser time limit
+static const int SANITIZER_TIME_LIMIT_FACTOR = 10;
+
+// the compile profile names of the instrumented builds for profileTestCase and coverageTestCase
+static const char PROFILE_RUN_BUILD[] = "profile-run";
+static const char COVERAGE_RUN_BUILD[] = "coverage-run";
+
 // ***************************** RAII  ****************************
 
 MainWindow::MainWindow(int index, AppWindow *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow), editor(nullptr), appWindow(parent), untitledIndex(index),
       fileWatcher(new QFileSystemWatcher(this)), reloading(false), killingProcesses(false),
-      autoSaveTimer(new QTimer(this))
+      autoSaveTimer(new QTimer(this)), runResultTimer(new QTimer(this)),
+      speculativeCompiler(new Core::SpeculativeCompiler(this)), speculativeCompileTimer(new QTimer(this))
 {
     LOG_INFO(INFO_OF(index));
 
@@ -63,11 +81,14 @@ MainWindow::MainWindow(int index, AppWindow *parent)
 
     log = new MessageLogger(appWindow->getPreferencesWindow(), this);
     ui->messageLoggerLayout->addWidget(log);
+    connect(log, &MessageLogger::requestGoToPosition, this, &MainWindow::goToPosition);
 
     testcases = new Widgets::TestCases(log, this);
     ui->testCasesLayout->addWidget(testcases);
     connect(testcases, &Widgets::TestCases::checkerChanged, this, &MainWindow::updateChecker);
     connect(testcases, &Widgets::TestCases::requestRun, this, &MainWindow::runTestCase);
+    connect(testcases, &Widgets::TestCases::requestProfileRun, this, &MainWindow::profileTestCase);
+    connect(testcases, &Widgets::TestCases::requestCoverageRun, this, &MainWindow::coverageTestCase);
 
     setEditor();
     setStopwatch();
@@ -75,6 +96,13 @@ MainWindow::MainWindow(int index, AppWindow *parent)
     connect(
         autoSaveTimer, &QTimer::timeout, autoSaveTimer, [this] { saveFile(AutoSave, tr("Auto Save"), false); },
         Qt::DirectConnection);
+    runResultTimer->setSingleShot(true);
+    runResultTimer->setInterval(16);
+    connect(runResultTimer, &QTimer::timeout, this, &MainWindow::showRunResults);
+    speculativeCompileTimer->setSingleShot(true);
+    connect(speculativeCompileTimer, &QTimer::timeout, this, &MainWindow::speculativeCompile);
+    connect(speculativeCompiler, &Core::SpeculativeCompiler::finished, this,
+            &MainWindow::onSpeculativeCompilationFinished);
     applySettings("");
     QTimer::singleShot(0, [this] { setLanguage(language); }); // See issue #187 for more information
 }
@@ -87,11 +115,17 @@ MainWindow::MainWindow(const QString &fileOpen, int index, AppWindow *parent) :
         testcases->addTestCase();
 }
 
-MainWindow::MainWindow(const EditorStatus &status, bool duplicate, int index, AppWindow *parent)
+MainWindow::MainWindow(const EditorStatus &status, bool duplicate, int index, AppWindow *parent, bool deferred)
     : MainWindow(index, parent)
 {
-    LOG_INFO(INFO_OF(duplicate));
-    loadStatus(status, duplicate);
+    LOG_INFO(INFO_OF(duplicate) << BOOL_INFO_OF(deferred));
+    if (deferred)
+    {
+        loadStatusProperties(status, duplicate);
+        deferredStatus.reset(new EditorStatus(status));
+    }
+    else
+        loadStatus(status, duplicate);
 }
 
 MainWindow::~MainWindow()
@@ -133,16 +167,47 @@ void MainWindow::setStopwatch()
     stopwatch->setVisible(SettingsHelper::isDisplayStopwatch());
 }
 
+void MainWindow::startTracePipeline(const QString &name)
+{
+    tracePipeline = Core::PipelineTracer::startPipeline(QString("%1: %2").arg(name, getTabTitle(true, false)));
+    compileTraceStart = 0;
+    speculativeWaitTraceStart = 0;
+    checker->setTracePipeline(tracePipeline);
+}
+
+void MainWindow::traceCompilation(const QString &result)
+{
+    if (compileTraceStart == 0)
+        return;
+    Core::PipelineTracer::addSpan(tracePipeline, "compiler", "Compile", compileTraceStart,
+                                  {{"language", language}, {"result", result}});
+    compileTraceStart = 0;
+}
+
+void MainWindow::traceVerdict(int index, Widgets::TestCase::Verdict verdict)
+{
+    static const QStringList names = {"AC", "WA", "TLE", "RE", "UNKNOWN"};
+    Core::PipelineTracer::addInstant(tracePipeline, "verdict", "Verdict",
+                                     {{"testCase", index + 1}, {"verdict", names.value(verdict)}});
+}
+
 void MainWindow::compile()
 {
     if (SettingsHelper::isSaveFileOnCompilation())
+    {
+        const Core::PipelineTracer::Scope scope(tracePipeline, "editor", "Save");
         saveFile(IgnoreUntitled, tr("Compiler"), true);
+    }
 
     killProcesses();
 
     compiler = new Core::Compiler();
 
-    auto path = tmpPath();
+    QString path;
+    {
+        const Core::PipelineTracer::Scope scope(tracePipeline, "editor", "Write Temporary File");
+        path = tmpPath();
+    }
     if (path.isEmpty())
         return;
 
@@ -158,18 +223,75 @@ void MainWindow::compile()
         return;
     }
 
+    // The sanitizer build is started after waiting for the speculative build, because compile() is called again
+    // when the wait is over.
+    const auto hash = Core::SpeculativeCompiler::hash(editor->toPlainText(), QFileInfo(path).fileName(), filePath,
+                                                      compileCommand(), language);
+    if (waitForSpeculativeBuild(hash))
+        return;
+
+    if (afterCompile == RunWithSanitizers)
+        compileSanitizerBuild(path);
+
+    if (takeSpeculativeBuild(hash, path))
+        return;
+
     connect(compiler, &Core::Compiler::compilationStarted, this, &MainWindow::onCompilationStarted);
+    connect(compiler, &Core::Compiler::diagnosticArrived, this, &MainWindow::onCompileDiagnosticArrived);
     connect(compiler, &Core::Compiler::compilationFinished, this, &MainWindow::onCompilationFinished);
     connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &MainWindow::onCompilationErrorOccurred);
     connect(compiler, &Core::Compiler::compilationFailed, this, &MainWindow::onCompilationFailed);
     connect(compiler, &Core::Compiler::compilationKilled, this, &MainWindow::onCompilationKilled);
+    compiler->setOutputPath(compileOutputPath(path));
+    compileTraceStart = Core::PipelineTracer::now();
     compiler->start(path, filePath, compileCommand(), language);
 }
 
+void MainWindow::speculativeCompile()
+{
+    // don't replace the speculative build which a real compilation is waiting for
+    if (!SettingsHelper::isSpeculativeCompilationEnable() || waitingForSpeculativeCompilation)
+        return;
+    if (language != "C++" && language != "Java")
+        return;
+    speculativeCompiler->compile(editor->toPlainText(), tmpFileName(), filePath, compileCommand(), language);
+}
+
+bool MainWindow::waitForSpeculativeBuild(const QByteArray &hash)
+{
+    if (!speculativeCompiler->isCompiling(hash))
+        return false;
+
+    LOG_INFO("Waiting for the speculative compilation");
+    onCompilationStarted(); // the background compilation is the compilation now
+    log->info(tr("Compiler"), tr("Waiting for the background compilation to finish"));
+    waitingForSpeculativeCompilation = true;
+    speculativeWaitTraceStart = Core::PipelineTracer::now();
+    return true;
+}
+
+bool MainWindow::takeSpeculativeBuild(const QByteArray &hash, const QString &path)
+{
+    QString warning;
+    if (speculativeCompiler->take(hash, compileOutputPath(path), &warning))
+    {
+        Core::PipelineTracer::addInstant(tracePipeline, "compiler", "Take Speculative Build");
+        log->info(tr("Compiler"), tr("The code has been compiled in the background"));
+        onCompilationFinished(warning);
+        return true;
+    }
+
+    speculativeCompiler->cancel(); // it's building some other code, which is useless now
+    return false;
+}
+
 void MainWindow::run()
 {
     if (SettingsHelper::isSaveFileOnExecution())
+    {
+        const Core::PipelineTracer::Scope scope(tracePipeline, "editor", "Save");
         saveFile(IgnoreUntitled, tr("Runner"), true);
+    }
 
     LOG_INFO("Requesting run of testcases");
     killProcesses();
@@ -185,17 +307,106 @@ void MainWindow::run()
 
     for (int i = 0; i < testcases->count(); ++i)
     {
-        if ((!testcases->input(i).trimmed().isEmpty() || SettingsHelper::isRunOnEmptyTestcase()) &&
-            testcases->isChecked(i))
-        {
+        if (shouldRun(i))
             run(i);
-        }
     }
 
     if (runner.empty())
         log->warn(tr("Runner"), tr("All inputs are empty, nothing to run"));
 }
 
+bool MainWindow::shouldRun(int index) const
+{
+    return (!testcases->input(index).trimmed().isEmpty() || SettingsHelper::isRunOnEmptyTestcase()) &&
+           testcases->isChecked(index);
+}
+
+void MainWindow::compileSanitizerBuild(const QString &path)
+{
+    const auto profile = SettingsHelper::getCppSanitizerProfile();
+
+    QString command;
+    for (const auto &p : compileProfiles())
+    {
+        if (p.first == profile)
+            command = p.second;
+    }
+
+    if (language != "C++" || command.isEmpty())
+    {
+        if (language != "C++")
+            log->warn(tr("Sanitizers"), tr("Sanitizers are only available for C++"));
+        else
+            log->warn(tr("Sanitizers"),
+                      tr("The compile profile \"%1\" doesn't exist. You can set the sanitizer profile at %2.")
+                          .arg(profile)
+                          .arg(SettingsHelper::pathOfCppSanitizerProfile()));
+        sanitizerBuildState = SanitizerBuildFailed;
+        return;
+    }
+
+    // The sanitizer build is compiled at the same time as the normal build, into its own output path.
+    sanitizerBuildState = SanitizerBuilding;
+    sanitizerCompiler = new Core::Compiler();
+    connect(sanitizerCompiler, &Core::Compiler::compilationFinished, this, [this] {
+        log->info(tr("Sanitizers"), tr("The sanitizer build has finished"));
+        onSanitizerBuildFinished(true);
+    });
+    connect(sanitizerCompiler, &Core::Compiler::compilationErrorOccurred, this, [this](const QString &error) {
+        log->error(tr("Sanitizers"), tr("Error occurred while compiling the sanitizer build"));
+        if (!error.trimmed().isEmpty())
+            log->error(tr("Sanitizers"), error);
+        onSanitizerBuildFinished(false);
+    });
+    connect(sanitizerCompiler, &Core::Compiler::compilationFailed, this, [this](const QString &reason) {
+        log->error(tr("Sanitizers"), reason);
+        onSanitizerBuildFinished(false);
+    });
+    sanitizerCompiler->setOutputPath(Core::Compiler::profileOutputPath(path, filePath, language, profile));
+    sanitizerCompiler->start(path, filePath, command, language);
+}
+
+void MainWindow::onSanitizerBuildFinished(bool success)
+{
+    sanitizerBuildState = success ? SanitizerBuilt : SanitizerBuildFailed;
+    if (waitingForSanitizerBuild)
+    {
+        waitingForSanitizerBuild = false;
+        runWithSanitizers();
+    }
+}
+
+void MainWindow::runWithSanitizers()
+{
+    const bool sanitize = sanitizerBuildState == SanitizerBuilt; // run() resets the state
+
+    run(); // the normal build decides the verdicts and the time
+
+    if (!sanitize || runner.empty())
+        return;
+
+    for (int i = 0; i < testcases->count(); ++i)
+    {
+        if (shouldRun(i))
+            runSanitizer(i);
+    }
+}
+
+void MainWindow::runSanitizer(int index)
+{
+    auto *tmp = new Core::Runner(index);
+    connect(tmp, &Core::Runner::runFinished, this, &MainWindow::onSanitizerRunFinished);
+    connect(tmp, &Core::Runner::failedToStartRun, this,
+            [this](int i, const QString &error) { log->warn(tr("Sanitizers[%1]").arg(i + 1), error, false); });
+    if (fileIO)
+        tmp->setFileIO(SettingsHelper::getFileIOInputFile(), SettingsHelper::getFileIOOutputFile());
+    tmp->setProfile(SettingsHelper::getCppSanitizerProfile());
+    tmp->run(tmpPath(), filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+             SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(), testcases->input(index),
+             timeLimit() * SANITIZER_TIME_LIMIT_FACTOR);
+    sanitizerRunner.push_back(tmp);
+}
+
 void MainWindow::run(int index)
 {
     if (index < 0 || index >= testcases->count())
@@ -207,10 +418,22 @@ void MainWindow::run(int index)
     auto *tmp = new Core::Runner(index);
     connect(tmp, &Core::Runner::runStarted, this, &MainWindow::onRunStarted);
     connect(tmp, &Core::Runner::runFinished, this, &MainWindow::onRunFinished);
+    connect(tmp, &Core::Runner::runCountersRead, this,
+            [this](int i, const Core::HardwareCounters::Counts &counts) { runCounts[i] = counts; });
     connect(tmp, &Core::Runner::failedToStartRun, this, &MainWindow::onFailedToStartRun);
     connect(tmp, &Core::Runner::runOutputLimitExceeded, this, &MainWindow::onRunOutputLimitExceeded);
     connect(tmp, &Core::Runner::runKilled, this, &MainWindow::onRunKilled);
-    tmp->run(tmpPath(), filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+    if (fileIO)
+        tmp->setFileIO(SettingsHelper::getFileIOInputFile(), SettingsHelper::getFileIOOutputFile());
+    tmp->setProfile(getCompileProfile());
+    tmp->setTracePipeline(tracePipeline, "runner");
+    QString path;
+    {
+        const Core::PipelineTracer::Scope scope(tracePipeline, "editor", "Write Temporary File",
+                                                {{"testCase", index + 1}});
+        path = tmpPath();
+    }
+    tmp->run(path, filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
              SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(), testcases->input(index),
              timeLimit());
     runner.push_back(tmp);
@@ -219,6 +442,7 @@ void MainWindow::run(int index)
 void MainWindow::runTestCase(int index)
 {
     LOG_INFO(INFO_OF(index));
+    startTracePipeline("Run Test Case");
     killProcesses();
     testcases->clearOutput();
     log->clear();
@@ -232,6 +456,179 @@ void MainWindow::runTestCase(int index)
     run(index);
 }
 
+void MainWindow::profileTestCase(int index)
+{
+    runInstrumented(index, ProfileRun);
+}
+
+void MainWindow::coverageTestCase(int index)
+{
+    runInstrumented(index, CoverageRun);
+}
+
+void MainWindow::runInstrumented(int index, InstrumentedRun kind)
+{
+    LOG_INFO(INFO_OF(index) << INFO_OF(kind));
+    startTracePipeline(kind == ProfileRun ? "Profile" : "Coverage");
+
+    if (SettingsHelper::isSaveFileOnCompilation())
+    {
+        const Core::PipelineTracer::Scope scope(tracePipeline, "editor", "Save");
+        saveFile(IgnoreUntitled, tr("Compiler"), true);
+    }
+
+    killProcesses();
+    testcases->clearOutput();
+    editor->clearLineAnnotations();
+    log->clear();
+
+    if (language != "C++")
+    {
+        log->warn(kind == ProfileRun ? tr("Profiler") : tr("Coverage"), tr("This is only available for C++"));
+        return;
+    }
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    // The instrumented build is the normal build with some flags added, e.g. the debug information and the frame
+    // pointers to map the samples back to the source lines. It has its own output path, so the normal build is kept.
+    const QString build = kind == ProfileRun ? PROFILE_RUN_BUILD : COVERAGE_RUN_BUILD;
+    const auto flags = kind == ProfileRun ? Core::Profiler::compileFlags() : Core::Coverage::compileFlags();
+
+    compiler = new Core::Compiler();
+    connect(compiler, &Core::Compiler::compilationStarted, this, &MainWindow::onCompilationStarted);
+    connect(compiler, &Core::Compiler::diagnosticArrived, this, &MainWindow::onCompileDiagnosticArrived);
+    connect(compiler, &Core::Compiler::compilationFinished, this, [this, index, kind](const QString &warning) {
+        traceCompilation("finished");
+        log->info(tr("Compiler"), tr("Compilation has finished"));
+        if (!warning.trimmed().isEmpty())
+            log->warn(tr("Compile Warnings"), warning);
+        if (kind == ProfileRun)
+            startProfiler(index);
+        else
+            startCoverage(index);
+    });
+    connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &MainWindow::onCompilationErrorOccurred);
+    connect(compiler, &Core::Compiler::compilationFailed, this, &MainWindow::onCompilationFailed);
+    connect(compiler, &Core::Compiler::compilationKilled, this, &MainWindow::onCompilationKilled);
+    compiler->setOutputPath(Core::Compiler::profileOutputPath(path, filePath, language, build));
+    compileTraceStart = Core::PipelineTracer::now();
+    compiler->start(path, filePath, compileCommand() + " " + flags, language);
+}
+
+void MainWindow::startProfiler(int index)
+{
+    if (index < 0 || index >= testcases->count())
+        return;
+
+    const auto head = tr("Profiler[%1]").arg(index + 1);
+    profiler = new Core::Profiler(index);
+    connect(profiler, &Core::Profiler::profileStarted, this, [this, head](int i, const QString &tool) {
+        log->info(head, tr("Profiling test case #%1 with %2").arg(i + 1).arg(tool));
+    });
+    connect(profiler, &Core::Profiler::profileFinished, this, &MainWindow::onProfileFinished);
+    connect(profiler, &Core::Profiler::profileFailed, this,
+            [this, head](int, const QString &error) { log->error(head, error, false); });
+    if (fileIO)
+        profiler->setFileIO(SettingsHelper::getFileIOInputFile(), SettingsHelper::getFileIOOutputFile());
+    profiler->profile(tmpPath(), filePath, PROFILE_RUN_BUILD, SettingsHelper::getCppRunArguments(),
+                      testcases->input(index), timeLimit());
+}
+
+void MainWindow::onProfileFinished(int index, const QMap<int, double> &lineCosts)
+{
+    const auto head = tr("Profiler[%1]").arg(index + 1);
+
+    double maxCost = 0;
+    int hottestLine = 0;
+    for (auto it = lineCosts.constBegin(); it != lineCosts.constEnd(); ++it)
+    {
+        if (it.value() > maxCost)
+        {
+            maxCost = it.value();
+            hottestLine = it.key();
+        }
+    }
+
+    if (hottestLine == 0)
+    {
+        log->warn(head, tr("Nothing is recorded in the source file, the program may have finished too quickly"));
+        return;
+    }
+
+    QMap<int, Editor::CodeEditor::LineAnnotation> annotations;
+    for (auto it = lineCosts.constBegin(); it != lineCosts.constEnd(); ++it)
+    {
+        if (it.value() >= 0.05) // it would be shown as 0.0%
+            annotations[it.key()] = {QString::number(it.value(), 'f', 1) + "%", it.value() / maxCost};
+    }
+    editor->setLineAnnotations(annotations);
+
+    log->info(head, tr("The costs of the lines are shown next to the line numbers, the hottest line is line %1 (%2%)")
+                        .arg(hottestLine)
+                        .arg(maxCost, 0, 'f', 1));
+}
+
+void MainWindow::startCoverage(int index)
+{
+    if (index < 0 || index >= testcases->count())
+        return;
+
+    const auto head = tr("Coverage[%1]").arg(index + 1);
+    coverage = new Core::Coverage(index);
+    connect(coverage, &Core::Coverage::coverageStarted, this,
+            [this, head](int i) { log->info(head, tr("Counting the line executions on test case #%1").arg(i + 1)); });
+    connect(coverage, &Core::Coverage::coverageFinished, this, &MainWindow::onCoverageFinished);
+    connect(coverage, &Core::Coverage::coverageFailed, this,
+            [this, head](int, const QString &error) { log->error(head, error, false); });
+    if (fileIO)
+        coverage->setFileIO(SettingsHelper::getFileIOInputFile(), SettingsHelper::getFileIOOutputFile());
+    coverage->run(tmpPath(), filePath, COVERAGE_RUN_BUILD, SettingsHelper::getCppRunArguments(),
+                  testcases->input(index), timeLimit());
+}
+
+void MainWindow::onCoverageFinished(int index, const QMap<int, qint64> &lineCounts)
+{
+    const auto head = tr("Coverage[%1]").arg(index + 1);
+
+    if (lineCounts.isEmpty())
+    {
+        log->warn(head, tr("No executable lines are found in the source file"));
+        return;
+    }
+
+    qint64 maxCount = 0;
+    int hottestLine = 0;
+    for (auto it = lineCounts.constBegin(); it != lineCounts.constEnd(); ++it)
+    {
+        if (it.value() > maxCount)
+        {
+            maxCount = it.value();
+            hottestLine = it.key();
+        }
+    }
+
+    // The counts differ by orders of magnitude, so the heat is on a log scale. Lines never executed are shown as 0
+    // without a heat, which is useful to find the code that should have been executed.
+    QMap<int, Editor::CodeEditor::LineAnnotation> annotations;
+    for (auto it = lineCounts.constBegin(); it != lineCounts.constEnd(); ++it)
+    {
+        const double heat = maxCount == 0 ? 0 : std::log1p(it.value()) / std::log1p(maxCount);
+        annotations[it.key()] = {Util::shortNumber(it.value()), heat};
+    }
+    editor->setLineAnnotations(annotations);
+
+    if (hottestLine == 0)
+        log->info(head, tr("No line is executed, the execution counts are shown next to the line numbers"));
+    else
+        log->info(head, tr("The execution counts are shown next to the line numbers, line %1 is executed the most "
+                           "(%2 times)")
+                            .arg(hottestLine)
+                            .arg(maxCount));
+}
+
 void MainWindow::loadTests()
 {
     if (!isUntitled() && SettingsHelper::isSaveTests())
@@ -403,6 +800,7 @@ MainWindow::EditorStatus::EditorStatus(const QMap<QString, QVariant> &status)
     FROMSTATUS(editorText).toString();
     FROMSTATUS(language).toString();
     FROMSTATUS(customCompileCommand).toString();
+    FROMSTATUS(compileProfile).toString();
     FROMSTATUS(editorCursor).toInt();
     FROMSTATUS(editorAnchor).toInt();
     FROMSTATUS(horizontalScrollBarValue).toInt();
@@ -410,6 +808,7 @@ MainWindow::EditorStatus::EditorStatus(const QMap<QString, QVariant> &status)
     FROMSTATUS(untitledIndex).toInt();
     FROMSTATUS(checkerIndex).toInt();
     FROMSTATUS_DEFAULT(customTimeLimit, -1).toInt();
+    FROMSTATUS(fileIO).toBool();
     FROMSTATUS(input).toStringList();
     FROMSTATUS(expected).toStringList();
     FROMSTATUS(customCheckers).toStringList();
@@ -431,6 +830,7 @@ QMap<QString, QVariant> MainWindow::EditorStatus::toMap() const
     TOSTATUS(editorText);
     TOSTATUS(language);
     TOSTATUS(customCompileCommand);
+    TOSTATUS(compileProfile);
     TOSTATUS(editorCursor);
     TOSTATUS(editorAnchor);
     TOSTATUS(horizontalScrollBarValue);
@@ -438,6 +838,7 @@ QMap<QString, QVariant> MainWindow::EditorStatus::toMap() const
     TOSTATUS(untitledIndex);
     TOSTATUS(checkerIndex);
     TOSTATUS(customTimeLimit);
+    TOSTATUS(fileIO);
     TOSTATUS(input);
     TOSTATUS(expected);
     TOSTATUS(customCheckers);
@@ -451,28 +852,40 @@ MainWindow::EditorStatus MainWindow::toStatus() const
 {
     EditorStatus status;
 
-    status.timestamp = QDateTime::currentMSecsSinceEpoch();
+    if (deferredStatus)
+    {
+        // The code and the test cases can't be changed before they are loaded. The timestamp is kept, so the file is
+        // still checked for external changes when they are loaded.
+        status = deferredContents();
+    }
+    else
+    {
+        status.timestamp = QDateTime::currentMSecsSinceEpoch();
+        status.editorText = editor->toPlainText();
+        status.editorCursor = editor->textCursor().position();
+        status.editorAnchor = editor->textCursor().anchor();
+        status.horizontalScrollBarValue = editor->horizontalScrollBar()->value();
+        status.verticalScrollbarValue = editor->verticalScrollBar()->value();
+        status.checkerIndex = testcases->checkerIndex();
+        status.input = testcases->inputs();
+        status.expected = testcases->expecteds();
+        status.customCheckers = testcases->customCheckers();
+        for (int i = 0; i < testcases->count(); ++i)
+            status.testcasesIsShow.push_back(testcases->isChecked(i));
+        status.testCaseSplitterStates = testcases->splitterStates();
+    }
 
     status.isLanguageSet = isLanguageSet;
     status.filePath = filePath;
-    status.savedText = savedText;
+    if (hibernationRecordId.isEmpty()) // the saved text of a hibernated tab is in its record
+        status.savedText = savedText;
     status.problemURL = problemURL;
-    status.editorText = editor->toPlainText();
     status.language = language;
     status.customCompileCommand = customCompileCommand;
-    status.editorCursor = editor->textCursor().position();
-    status.editorAnchor = editor->textCursor().anchor();
-    status.horizontalScrollBarValue = editor->horizontalScrollBar()->value();
-    status.verticalScrollbarValue = editor->verticalScrollBar()->value();
+    status.compileProfile = compileProfile;
     status.untitledIndex = untitledIndex;
-    status.checkerIndex = testcases->checkerIndex();
     status.customTimeLimit = customTimeLimit;
-    status.input = testcases->inputs();
-    status.expected = testcases->expecteds();
-    status.customCheckers = testcases->customCheckers();
-    for (int i = 0; i < testcases->count(); ++i)
-        status.testcasesIsShow.push_back(testcases->isChecked(i));
-    status.testCaseSplitterStates = testcases->splitterStates();
+    status.fileIO = fileIO;
 
     return status;
 }
@@ -480,18 +893,133 @@ MainWindow::EditorStatus MainWindow::toStatus() const
 void MainWindow::loadStatus(const EditorStatus &status, bool duplicate)
 {
     LOG_INFO("Requesting loadStatus");
+    deferredStatus.reset();
+    loadStatusProperties(status, duplicate);
+    loadStatusContents(status);
+}
+
+void MainWindow::loadDeferredStatus()
+{
+    if (!deferredStatus)
+        return;
+    LOG_INFO("Loading the deferred status " << INFO_OF(filePath) << INFO_OF(hibernationRecordId));
+    const auto status = deferredContents();
+    deferredStatus.reset();
+    if (!hibernationRecordId.isEmpty())
+    {
+        savedText = status.savedText;
+        hibernationDirectory.clear();
+        hibernationRecordId.clear();
+    }
+    loadStatusContents(status);
+}
+
+MainWindow::EditorStatus MainWindow::deferredContents() const
+{
+    if (hibernationRecordId.isEmpty())
+        return *deferredStatus;
+
+    bool ok = false;
+    const auto record = Core::SessionStore::readRecord(hibernationDirectory, hibernationRecordId, &ok);
+    if (ok)
+        return EditorStatus(record);
+
+    // The code was saved when the tab was hibernated, so it can still be read from the file. The test cases are lost.
+    LOG_ERR("Failed to read the hibernated tab " << INFO_OF(filePath) << INFO_OF(hibernationRecordId));
+    auto status = *deferredStatus;
+    if (!isUntitled())
+        status.savedText = status.editorText = Util::readFile(filePath);
+    return status;
+}
+
+bool MainWindow::canHibernate() const
+{
+    // The undo history can't be kept, which is a part of the unsaved changes. The code is compared with the last
+    // loaded or saved text instead of the file (see isTextChanged), so the files are not read on every check.
+    return !deferredStatus && editor->toPlainText() == savedText && detachedRunner == nullptr;
+}
+
+void MainWindow::hibernate(const QString &storeDirectory, const QString &recordId)
+{
+    if (!canHibernate())
+        return;
+
+    LOG_INFO("Hibernating " << INFO_OF(filePath) << INFO_OF(recordId) << INFO_OF(memoryUsage()));
+
+    // only the parts which are not in the widgets are kept, the rest are read from the record when it's loaded
+    deferredStatus.reset(new EditorStatus());
+    deferredStatus->timestamp = QDateTime::currentMSecsSinceEpoch();
+    deferredStatus->editorCursor = editor->textCursor().position();
+    deferredStatus->editorAnchor = editor->textCursor().anchor();
+    deferredStatus->horizontalScrollBarValue = editor->horizontalScrollBar()->value();
+    deferredStatus->verticalScrollbarValue = editor->verticalScrollBar()->value();
+    deferredStatus->checkerIndex = testcases->checkerIndex();
+    deferredStatus->customCheckers = testcases->customCheckers();
+    hibernationDirectory = storeDirectory;
+    hibernationRecordId = recordId;
+    savedText.clear();
+
+    killProcesses();
+    {
+        // don't start auto save or speculative compilation for the cleared code
+        const QSignalBlocker blocker(editor);
+        editor->clearSquiggle();
+        editor->setPlainText(QString());
+    }
+    testcases->clear();
+}
+
+bool MainWindow::isHibernated() const
+{
+    return deferredStatus != nullptr;
+}
+
+qint64 MainWindow::inactiveTime() const
+{
+    return inactiveTimer.isValid() ? inactiveTimer.elapsed() : -1;
+}
+
+qint64 MainWindow::memoryUsage() const
+{
+    qint64 characters = savedText.size();
+    if (deferredStatus)
+    {
+        characters += deferredStatus->editorText.size();
+        for (const auto &text : deferredStatus->input + deferredStatus->expected)
+            characters += text.size();
+    }
+    else
+    {
+        characters += editor->document()->characterCount();
+        for (int i = 0; i < testcases->count(); ++i)
+            characters += testcases->input(i).size() + testcases->output(i).size() + testcases->expected(i).size();
+    }
+    return characters * static_cast<qint64>(sizeof(QChar));
+}
+
+void MainWindow::loadStatusProperties(const EditorStatus &status, bool duplicate)
+{
     setProblemURL(status.problemURL);
     if (status.isLanguageSet)
         setLanguage(status.language);
     customCompileCommand = status.customCompileCommand; // this must be after setLanguage
+    compileProfile = status.compileProfile;             // this must be after setLanguage
     if (!duplicate)
     {
         untitledIndex = status.untitledIndex;
         setFilePath(status.filePath);
     }
-    testcases->addCustomCheckers(status.customCheckers);
-    testcases->setCheckerIndex(status.checkerIndex);
     savedText = status.savedText;
+    customTimeLimit = status.customTimeLimit;
+    fileIO = status.fileIO;
+}
+
+void MainWindow::loadStatusContents(const EditorStatus &status)
+{
+    Core::StallDetector::Operation operation("Load Tab Contents");
+    if (testcases->customCheckers() != status.customCheckers) // they are kept when the tab is hibernated
+        testcases->addCustomCheckers(status.customCheckers);
+    testcases->setCheckerIndex(status.checkerIndex);
     editor->setPlainText(status.editorText);
     auto cursor = editor->textCursor();
     cursor.setPosition(status.editorAnchor);
@@ -499,7 +1027,6 @@ void MainWindow::loadStatus(const EditorStatus &status, bool duplicate)
     editor->setTextCursor(cursor);
     editor->horizontalScrollBar()->setValue(status.horizontalScrollBarValue);
     editor->verticalScrollBar()->setValue(status.verticalScrollbarValue);
-    customTimeLimit = status.customTimeLimit;
     testcases->loadStatus(status.input, status.expected);
     for (int i = 0; i < status.testcasesIsShow.count() && i < testcases->count(); ++i)
         testcases->setChecked(i, status.testcasesIsShow[i].toBool());
@@ -664,6 +1191,16 @@ void MainWindow::applySettings(const QString &pagePath)
             autoSaveTimer->stop();
     }
 
+    if (pageChanged("Actions/Speculative Compilation"))
+    {
+        speculativeCompileTimer->setInterval(SettingsHelper::getSpeculativeCompilationDelay());
+        if (!SettingsHelper::isSpeculativeCompilationEnable())
+        {
+            speculativeCompileTimer->stop();
+            speculativeCompiler->cancel();
+        }
+    }
+
     if (pageChanged("Actions/Stopwatch"))
     {
         stopwatch->setVisible(SettingsHelper::isDisplayStopwatch());
@@ -705,6 +1242,7 @@ void MainWindow::compileOnly()
 {
     LOG_INFO("Requesting Compile Only");
     emit compileOrRunTriggered();
+    startTracePipeline("Compile Only");
     afterCompile = Nothing;
     log->clear();
     compile();
@@ -714,14 +1252,26 @@ void MainWindow::runOnly()
 {
     LOG_INFO("Requesting Run only");
     emit compileOrRunTriggered();
+    startTracePipeline("Run Only");
     log->clear();
     run();
 }
 
+void MainWindow::compileAndRunWithSanitizers()
+{
+    LOG_INFO("Requested Compile and Run with sanitizers");
+    emit compileOrRunTriggered();
+    startTracePipeline("Compile and Run with Sanitizers");
+    afterCompile = RunWithSanitizers;
+    log->clear();
+    compile();
+}
+
 void MainWindow::compileAndRun()
 {
     LOG_INFO("Requested Compile and Run");
     emit compileOrRunTriggered();
+    startTracePipeline("Compile and Run");
     afterCompile = Run;
     log->clear();
     compile();
@@ -761,6 +1311,7 @@ void MainWindow::setLanguage(const QString &lang)
         language = "C++";
     editor->applySettings(language);
     customCompileCommand.clear();
+    compileProfile.clear();
     ui->changeLanguageButton->setText(language);
     updateCompileAndRunButtons();
     isLanguageSet = true;
@@ -828,12 +1379,52 @@ void MainWindow::killProcesses()
         compiler = nullptr;
     }
 
+    for (auto &t : profileCompilers)
+    {
+        delete t;
+    }
+    profileCompilers.clear();
+
+    if (sanitizerCompiler != nullptr)
+    {
+        // this may be called in a slot of the sanitizer compiler, so it's deleted later
+        sanitizerCompiler->disconnect(this);
+        sanitizerCompiler->deleteLater();
+        sanitizerCompiler = nullptr;
+    }
+    sanitizerBuildState = NoSanitizerBuild;
+    waitingForSanitizerBuild = false;
+
+    for (auto &t : sanitizerRunner)
+    {
+        delete t;
+    }
+    sanitizerRunner.clear();
+
     for (auto &t : runner)
     {
         delete t;
     }
     runner.clear();
 
+    if (profiler != nullptr)
+    {
+        delete profiler;
+        profiler = nullptr;
+    }
+
+    if (coverage != nullptr)
+    {
+        delete coverage;
+        coverage = nullptr;
+    }
+
+    runResultTimer->stop();
+    pendingRunResults.clear();
+    runCounts.clear();
+
+    waitingForSpeculativeCompilation = false;
+
     if (detachedRunner != nullptr)
     {
         delete detachedRunner;
@@ -847,6 +1438,7 @@ void MainWindow::killProcesses()
 
 void MainWindow::setText(const QString &text, bool keep)
 {
+    Core::StallDetector::Operation operation("Set Code");
     if (keep)
     {
         auto cursor = editor->textCursor();
@@ -873,6 +1465,7 @@ void MainWindow::updateWatcher()
 void MainWindow::loadFile(const QString &loadPath)
 {
     LOG_INFO(INFO_OF(loadPath));
+    Core::StallDetector::Operation operation("Load File");
 
     auto path = loadPath;
 
@@ -952,6 +1545,14 @@ void MainWindow::loadFile(const QString &loadPath)
 bool MainWindow::saveFile(SaveMode mode, const QString &head, bool safe)
 {
     LOG_INFO(INFO_OF(mode) << INFO_OF(head) << BOOL_INFO_OF(safe));
+    Core::StallDetector::Operation operation("Save File");
+
+    if (deferredStatus)
+    {
+        if (mode == AutoSave) // nothing is modified before it's loaded
+            return false;
+        loadDeferredStatus();
+    }
 
     if ((mode != AutoSave && SettingsHelper::isFormatOnManualSave()) ||
         (mode == AutoSave && SettingsHelper::isFormatOnAutoSave()))
@@ -1061,6 +1662,9 @@ bool MainWindow::saveFile(SaveMode mode, const QString &head, bool safe)
 
     saveTests(safe);
 
+    if (mode != IgnoreUntitled) // saving before compilation shouldn't start a low priority build to wait for
+        speculativeCompile();
+
     return true;
 }
 
@@ -1079,14 +1683,8 @@ QString MainWindow::tmpPath()
         }
         created = true;
     }
-    QString name;
-    if (language == "C++")
-        name = "sol." + Util::cppSuffix.first();
-    else if (language == "Java")
-        name = SettingsHelper::getJavaClassName() + "." + Util::javaSuffix.first();
-    else if (language == "Python")
-        name = "sol." + Util::pythonSuffix.first();
-    else
+    const auto name = tmpFileName();
+    if (name.isEmpty())
     {
         log->error(tr("Temp File"), tr("Please set the language"));
         return "";
@@ -1099,6 +1697,17 @@ QString MainWindow::tmpPath()
     return path;
 }
 
+QString MainWindow::tmpFileName() const
+{
+    if (language == "C++")
+        return "sol." + Util::cppSuffix.first();
+    if (language == "Java")
+        return SettingsHelper::getJavaClassName() + "." + Util::javaSuffix.first();
+    if (language == "Python")
+        return "sol." + Util::pythonSuffix.first();
+    return QString();
+}
+
 QString MainWindow::filePathOrTmpPath()
 {
     return isUntitled() ? tmpPath() : filePath;
@@ -1109,7 +1718,7 @@ void MainWindow::updateCompileCommand()
     bool ok = false;
     const auto command =
         QInputDialog::getText(this, tr("Set Compile Command"), tr("Custom compile command for this tab:"),
-                              QLineEdit::Normal, compileCommand(), &ok);
+                              QLineEdit::Normal, defaultCompileCommand(), &ok);
     if (ok)
         customCompileCommand = command;
 }
@@ -1123,22 +1732,115 @@ void MainWindow::updateTimeLimit()
         customTimeLimit = limit;
 }
 
+bool MainWindow::isFileIO() const
+{
+    return fileIO;
+}
+
+void MainWindow::setFileIO(bool enabled)
+{
+    LOG_INFO(BOOL_INFO_OF(enabled));
+    fileIO = enabled;
+}
+
+QStringList MainWindow::compileProfileNames() const
+{
+    QStringList names;
+    for (const auto &profile : compileProfiles())
+        names.push_back(profile.first);
+    return names;
+}
+
+QString MainWindow::getCompileProfile() const
+{
+    // the profile may have been removed or renamed in the preferences
+    return compileProfileNames().contains(compileProfile) ? compileProfile : QString();
+}
+
+void MainWindow::setCompileProfile(const QString &profile)
+{
+    LOG_INFO(INFO_OF(profile));
+    compileProfile = profile;
+}
+
+void MainWindow::compileAllProfiles()
+{
+    LOG_INFO("Requesting compile all profiles");
+    emit compileOrRunTriggered();
+    afterCompile = Nothing;
+    log->clear();
+
+    if (SettingsHelper::isSaveFileOnCompilation())
+        saveFile(IgnoreUntitled, tr("Compiler"), true);
+
+    killProcesses();
+
+    if (language != "C++" && language != "Java")
+    {
+        log->warn(tr("Compiler"), tr("Compile profiles are only available for C++ and Java"));
+        return;
+    }
+
+    const auto profiles = compileProfiles();
+    if (profiles.isEmpty())
+    {
+        log->warn(tr("Compiler"), tr("There are no compile profiles. You can add them at %1.")
+                                      .arg(SettingsManager::getPathText(language + "/Compile Profiles")));
+        return;
+    }
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    // The compilers are separate processes writing to separate output paths, so they can run at the same time.
+    for (const auto &profile : profiles)
+    {
+        auto *profileCompiler = new Core::Compiler();
+        const auto head = tr("Compiler [%1]").arg(profile.first);
+        connect(profileCompiler, &Core::Compiler::compilationStarted, this,
+                [this, head] { log->info(head, tr("Compilation has started")); });
+        connect(profileCompiler, &Core::Compiler::compilationFinished, this, [this, head](const QString &warning) {
+            log->info(head, tr("Compilation has finished"));
+            if (!warning.trimmed().isEmpty())
+                log->warn(head, warning);
+        });
+        connect(profileCompiler, &Core::Compiler::compilationErrorOccurred, this, [this, head](const QString &error) {
+            log->error(head, tr("Error occurred while compiling"));
+            if (!error.trimmed().isEmpty())
+                log->error(head, error);
+        });
+        connect(profileCompiler, &Core::Compiler::compilationFailed, this,
+                [this, head](const QString &reason) { log->error(head, reason); });
+        connect(profileCompiler, &Core::Compiler::compilationKilled, this,
+                [this, head] { log->error(head, tr("Compilation is killed")); });
+        profileCompiler->setOutputPath(Core::Compiler::profileOutputPath(path, filePath, language, profile.first));
+        profileCompilers.push_back(profileCompiler);
+        profileCompiler->start(path, filePath, profile.second, language);
+    }
+}
+
 bool MainWindow::isTextChanged() const
 {
+    if (!hibernationRecordId.isEmpty()) // it has no unsaved changes, see canHibernate
+        return false;
+
+    const auto text = deferredStatus ? deferredStatus->editorText : editor->toPlainText();
+
     if (isUntitled())
     {
         auto content = Util::readFile(SettingsManager::get(QString("%1/Template Path").arg(language)).toString(),
                                       tr("Read %1 Template").arg(language), log);
         if (content.isNull())
-            return !editor->toPlainText().isEmpty();
-        return editor->toPlainText() != content;
+            return !text.isEmpty();
+        return text != content;
     }
     auto content = Util::readFile(filePath);
 
     if (content.isNull())
         return true;
 
-    return editor->toPlainText() != content;
+    return text != content;
 }
 
 bool MainWindow::closeConfirm()
@@ -1190,6 +1892,9 @@ void MainWindow::onFileWatcherChanged(const QString &path)
 {
     LOG_INFO(INFO_OF(path));
 
+    if (deferredStatus) // the file is checked by the timestamp of the status when it's loaded
+        return;
+
     emit editorTextChanged(this);
 
     auto currentText = editor->toPlainText();
@@ -1239,6 +1944,8 @@ void MainWindow::onTextChanged()
     {
         autoSaveTimer->start();
     }
+    if (SettingsHelper::isSpeculativeCompilationEnable())
+        speculativeCompileTimer->start();
     emit editorTextChanged(this);
 }
 
@@ -1292,6 +1999,8 @@ void MainWindow::updateChecker()
     else
         checker = new Core::Checker(testcases->checkerType(), log, this);
     connect(checker, &Core::Checker::checkFinished, testcases, &Widgets::TestCases::setVerdict);
+    connect(checker, &Core::Checker::checkFinished, this, &MainWindow::traceVerdict);
+    checker->setTracePipeline(tracePipeline);
     checker->prepare();
 }
 
@@ -1306,12 +2015,45 @@ QSplitter *MainWindow::getRightSplitter()
 }
 
 QString MainWindow::compileCommand() const
+{
+    const auto profile = getCompileProfile();
+    if (!profile.isEmpty())
+    {
+        for (const auto &p : compileProfiles())
+        {
+            if (p.first == profile)
+                return p.second;
+        }
+    }
+    return defaultCompileCommand();
+}
+
+QString MainWindow::defaultCompileCommand() const
 {
     if (customCompileCommand.isEmpty())
         return SettingsManager::get(QString("%1/Compile Command").arg(language)).toString();
     return customCompileCommand;
 }
 
+QVector<QPair<QString, QString>> MainWindow::compileProfiles() const
+{
+    QVector<QPair<QString, QString>> profiles;
+    if (language != "C++" && language != "Java")
+        return profiles;
+    for (const auto &row : SettingsManager::get(QString("%1/Compile Profiles").arg(language)).toList())
+    {
+        const auto list = row.toStringList();
+        if (list.size() == 2 && !list.front().isEmpty() && !list.back().trimmed().isEmpty())
+            profiles.push_back({list.front(), list.back()});
+    }
+    return profiles;
+}
+
+QString MainWindow::compileOutputPath(const QString &tmpFilePath) const
+{
+    return Core::Compiler::profileOutputPath(tmpFilePath, filePath, language, getCompileProfile());
+}
+
 int MainWindow::timeLimit() const
 {
     if (customTimeLimit == -1)
@@ -1352,6 +2094,8 @@ void MainWindow::hideEvent(QHideEvent *event)
         return;
     }
 
+    inactiveTimer.start();
+
     if (SettingsHelper::isToggleStopwatchOnTabSwitch() && stopwatch->isRunning())
         stopwatch->pause();
 
@@ -1366,6 +2110,8 @@ void MainWindow::showEvent(QShowEvent *event)
         return;
     }
 
+    inactiveTimer.invalidate();
+
     if (SettingsHelper::isToggleStopwatchOnTabSwitch() && !stopwatch->isRunning())
         stopwatch->start();
 
@@ -1376,14 +2122,82 @@ void MainWindow::showEvent(QShowEvent *event)
 
 void MainWindow::onCompilationStarted()
 {
+    hasCompileSquiggles = false;
+    hasCompileError = false;
     log->info(tr("Compiler"), tr("Compilation has started"));
 }
 
+void MainWindow::onCompileDiagnosticArrived(const Core::CompileDiagnostic &diagnostic)
+{
+    // the notes are attached to the previous diagnostic, and the diagnostics in other files can't be shown
+    if (diagnostic.severity == Core::CompileDiagnostic::Note ||
+        QFileInfo(diagnostic.file).fileName() != tmpFileName())
+        return;
+
+    auto block = editor->document()->findBlockByNumber(diagnostic.line - 1);
+    if (!block.isValid())
+        return;
+
+    // The compiler only reports the start of the diagnostic, so underline the word starting there, or the whole
+    // line if the column is unknown. The column counts the bytes of the UTF-8 encoded line.
+    const auto text = block.text();
+    int start = 0;
+    int stop = text.length();
+    if (diagnostic.column > 0)
+    {
+        start = qMin(QString::fromUtf8(text.toUtf8().left(diagnostic.column - 1)).length(), text.length());
+        stop = start;
+        while (stop < text.length() && (text[stop].isLetterOrNumber() || text[stop] == '_'))
+            ++stop;
+        if (stop == start)
+            stop = qMin(start + 1, text.length());
+    }
+
+    // the squiggles of the last compilation or the language server are out of date
+    if (!hasCompileSquiggles)
+    {
+        editor->clearSquiggle();
+        hasCompileSquiggles = true;
+    }
+
+    const auto level = diagnostic.severity == Core::CompileDiagnostic::Error
+                           ? Editor::CodeEditor::SeverityLevel::Error
+                           : Editor::CodeEditor::SeverityLevel::Warning;
+    editor->addSquiggle(level, {diagnostic.line, start}, {diagnostic.line, stop}, diagnostic.message);
+    editor->highlightNewSquiggles();
+
+    if (diagnostic.severity == Core::CompileDiagnostic::Error && !hasCompileError)
+    {
+        hasCompileError = true;
+        log->error(tr("Compiler"),
+                   tr("First error at <a href=\"#Line/%1:%2\">line %1</a>: %3")
+                       .arg(diagnostic.line)
+                       .arg(start + 1)
+                       .arg(diagnostic.message.toHtmlEscaped()),
+                   false);
+    }
+}
+
+void MainWindow::goToPosition(int line, int column)
+{
+    auto block = editor->document()->findBlockByNumber(line - 1);
+    if (!block.isValid())
+        return;
+    auto cursor = editor->textCursor();
+    cursor.setPosition(block.position() + qBound(0, column - 1, block.length() - 1));
+    editor->setTextCursor(cursor);
+    editor->setFocus();
+}
+
 void MainWindow::onCompilationFinished(const QString &warning)
 {
+    traceCompilation("finished");
     if (language != "Python")
     {
         log->info(tr("Compiler"), tr("Compilation has finished"));
+        const auto timeReport = compiler == nullptr ? QString() : compiler->timeReport();
+        if (!timeReport.isEmpty())
+            log->info(tr("Compiler"), tr("Compile time: %1").arg(timeReport));
         if (!warning.trimmed().isEmpty())
         {
             log->warn(tr("Compile Warnings"), warning);
@@ -1394,6 +2208,16 @@ void MainWindow::onCompilationFinished(const QString &warning)
     {
         run();
     }
+    else if (afterCompile == RunWithSanitizers)
+    {
+        if (sanitizerBuildState == SanitizerBuilding)
+        {
+            log->info(tr("Sanitizers"), tr("Waiting for the sanitizer build to finish"));
+            waitingForSanitizerBuild = true;
+        }
+        else
+            runWithSanitizers();
+    }
     else if (afterCompile == RunDetached)
     {
         if (SettingsHelper::isSaveFileOnExecution())
@@ -1411,6 +2235,7 @@ void MainWindow::onCompilationFinished(const QString &warning)
         connect(detachedRunner, &Core::Runner::runStarted, this, &MainWindow::onRunStarted);
         connect(detachedRunner, &Core::Runner::failedToStartRun, this, &MainWindow::onFailedToStartRun);
         connect(detachedRunner, &Core::Runner::runKilled, this, &MainWindow::onRunKilled);
+        detachedRunner->setProfile(getCompileProfile());
         detachedRunner->runDetached(tmpPath(), filePath, language,
                                     SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
                                     SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString());
@@ -1419,6 +2244,7 @@ void MainWindow::onCompilationFinished(const QString &warning)
 
 void MainWindow::onCompilationErrorOccurred(const QString &error)
 {
+    traceCompilation("error");
     log->error(tr("Compiler"), tr("Error occurred while compiling"));
     if (!error.trimmed().isEmpty())
     {
@@ -1436,14 +2262,27 @@ void MainWindow::onCompilationErrorOccurred(const QString &error)
 
 void MainWindow::onCompilationFailed(const QString &reason)
 {
+    traceCompilation("failed");
     log->error(tr("Compiler"), tr("Failed to start compilation: %1").arg(reason), false);
 }
 
 void MainWindow::onCompilationKilled()
 {
+    traceCompilation("killed");
     log->error(tr("Compiler"), tr("Compilation is killed"));
 }
 
+void MainWindow::onSpeculativeCompilationFinished()
+{
+    if (waitingForSpeculativeCompilation)
+    {
+        waitingForSpeculativeCompilation = false;
+        Core::PipelineTracer::addSpan(tracePipeline, "compiler", "Wait For Speculative Build",
+                                      speculativeWaitTraceStart);
+        compile(); // take the build if it has succeeded, otherwise compile again to show the errors
+    }
+}
+
 // --------------------- RUNNER SLOTS ----------------------------
 
 QString MainWindow::getRunnerHead(int index)
@@ -1458,39 +2297,99 @@ void MainWindow::onRunStarted(int index)
     log->info(getRunnerHead(index), tr("Execution has started"));
 }
 
-void MainWindow::onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
-                               bool tle)
+void MainWindow::onRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                               qint64 timeUsed, bool tle)
+{
+    // When many test cases are running, their results arrive in bursts. Showing them in batches
+    // lets the test cases widget re-layout and repaint once per batch instead of once per result.
+    pendingRunResults.push_back({index, out, err, exitCode, timeUsed, tle});
+    if (!runResultTimer->isActive())
+        runResultTimer->start();
+}
+
+void MainWindow::onSanitizerRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err,
+                                        int exitCode, qint64 timeUsed, bool tle)
+{
+    Q_UNUSED(out)
+    Q_UNUSED(exitCode)
+
+    const auto reports = Core::SanitizerReport::parse(err.text());
+    testcases->setSanitizerReports(index, reports);
+
+    const auto head = tr("Sanitizers[%1]").arg(index + 1);
+    if (!reports.isEmpty())
+        log->warn(head, tr("%n error(s) reported on test case #%1", "", reports.size()).arg(index + 1));
+    else if (tle)
+        log->warn(head, tr("The sanitizer build on test case #%1 didn't finish in %2ms").arg(index + 1).arg(timeUsed));
+}
+
+void MainWindow::showRunResults()
+{
+    testcases->setUpdatesEnabled(false);
+    for (const auto &result : qAsConst(pendingRunResults))
+        showRunResult(result);
+    pendingRunResults.clear();
+    testcases->setUpdatesEnabled(true);
+}
+
+void MainWindow::showRunResult(const RunResult &result)
 {
+    const int index = result.index;
     auto head = getRunnerHead(index);
+    Core::PipelineTracer::addInstant(tracePipeline, "runner", "Show Result", {{"testCase", index + 1}});
+
+    // the hardware counts are shown next to the time used, e.g. "in 120ms (~1.2G instructions, IPC 2.31, ...)"
+    QString counts;
+    if (runCounts.contains(index))
+        counts = QString(" (%1)").arg(runCounts.take(index).toString());
 
-    if (exitCode == 0)
+    if (result.exitCode == 0)
     {
-        log->info(head, tr("Execution for test case #%1 has finished in %2ms").arg(index + 1).arg(timeUsed));
+        log->info(head, tr("Execution for test case #%1 has finished in %2ms").arg(index + 1).arg(result.timeUsed) +
+                            counts);
 
-        if ((!out.isEmpty() && !testcases->expected(index).isEmpty()) ||
-            (SettingsHelper::isCheckOnTestcasesWithEmptyOutput() && exitCode == 0))
-            checker->reqeustCheck(index, testcases->input(index), out, testcases->expected(index));
+        if ((!result.out.isEmpty() && !testcases->expected(index).isEmpty()) ||
+            SettingsHelper::isCheckOnTestcasesWithEmptyOutput())
+            checker->reqeustCheck(index, testcases->input(index), result.out, testcases->expected(index));
     }
 
     else
     {
-        if (tle)
+        if (result.tle)
         {
             log->warn(head, tr("Time Limit Exceeded"));
             testcases->setVerdict(index, Widgets::TestCase::TLE);
+            traceVerdict(index, Widgets::TestCase::TLE);
         }
         else
+        {
             testcases->setVerdict(index, Widgets::TestCase::RE);
+            traceVerdict(index, Widgets::TestCase::RE);
+        }
 
         log->error(head, tr("Execution for test case #%1 has finished with non-zero exitcode %2 in %3ms")
-                             .arg(index + 1)
-                             .arg(exitCode)
-                             .arg(timeUsed));
+                                 .arg(index + 1)
+                                 .arg(result.exitCode)
+                                 .arg(result.timeUsed) +
+                             counts);
+    }
+
+    if (result.out.isTruncated())
+    {
+        log->warn(head, tr("The output is %1 bytes long, only its beginning and its end are kept. You can change "
+                           "the lengths at %2.")
+                            .arg(result.out.summary().size)
+                            .arg(SettingsHelper::pathOfBoundedOutputCapture()),
+                  false);
     }
 
-    if (!err.trimmed().isEmpty())
-        log->error(head + tr("/stderr"), err);
-    testcases->setOutput(index, out);
+    if (!result.err.isEmpty())
+    {
+        const auto err = result.err.text();
+        if (!err.trimmed().isEmpty())
+            log->error(head + tr("/stderr"), err);
+    }
+    testcases->setOutput(index, result.out);
 }
 
 void MainWindow::onFailedToStartRun(int index, const QString &error)
@@ -18,7 +18,12 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include "Core/HardwareCounters.hpp"
+#include "Core/OutputBuffer.hpp"
+#include <QElapsedTimer>
 #include <QMainWindow>
+#include <QMap>
+#include <memory>
 
 class AppWindow;
 class MessageLogger;
@@ -40,8 +45,12 @@ QT_END_NAMESPACE
 namespace Core
 {
 class Checker;
+struct CompileDiagnostic;
 class Compiler;
+class Coverage;
+class Profiler;
 class Runner;
+class SpeculativeCompiler;
 } // namespace Core
 
 namespace Extensions
@@ -66,9 +75,10 @@ class MainWindow : public QMainWindow
         qint64 timestamp = 0; // MSecsSinceEpoch when the status was recorded
 
         bool isLanguageSet{};
-        QString filePath, savedText, problemURL, editorText, language, customCompileCommand;
+        QString filePath, savedText, problemURL, editorText, language, customCompileCommand, compileProfile;
         int editorCursor{}, editorAnchor{}, horizontalScrollBarValue{}, verticalScrollbarValue{}, untitledIndex{},
             checkerIndex{}, customTimeLimit{};
+        bool fileIO{};
         QStringList input, expected, customCheckers;
         QVariantList testcasesIsShow; // This can't be renamed to "isChecked" because that's not compatible
         QVariantList testCaseSplitterStates;
@@ -82,7 +92,13 @@ class MainWindow : public QMainWindow
 
     explicit MainWindow(int index, AppWindow *parent);
     explicit MainWindow(const QString &fileOpen, int index, AppWindow *parent);
-    explicit MainWindow(const EditorStatus &status, bool duplicate, int index, AppWindow *parent);
+    /**
+     * @brief construct a tab with a status
+     * @param deferred whether to defer loading the code and the test cases until loadDeferredStatus is called,
+     *        so restoring a session with many tabs only loads the tabs which are activated
+     */
+    explicit MainWindow(const EditorStatus &status, bool duplicate, int index, AppWindow *parent,
+                        bool deferred = false);
     ~MainWindow() override;
 
     int getUntitledIndex() const;
@@ -100,6 +116,41 @@ class MainWindow : public QMainWindow
     EditorStatus toStatus() const;
     void loadStatus(const EditorStatus &status, bool duplicate = false);
 
+    /**
+     * @brief load the code and the test cases of a tab constructed with a deferred status
+     * @note it does nothing if they are already loaded, it's called when the tab is activated
+     */
+    void loadDeferredStatus();
+
+    /**
+     * @brief whether the tab can be hibernated, a tab with unsaved changes or a detached execution can't be
+     */
+    bool canHibernate() const;
+
+    /**
+     * @brief unload the code and the test cases to reduce the memory usage, they are read back by loadDeferredStatus
+     * @param storeDirectory the directory of the session store
+     * @param recordId the id of the record of this tab in the store, which must be written from the current status
+     * @note the undo history and the outputs of the test cases are discarded
+     */
+    void hibernate(const QString &storeDirectory, const QString &recordId);
+
+    /**
+     * @brief whether the code and the test cases are not loaded, i.e. it's hibernated or restored but not activated
+     */
+    bool isHibernated() const;
+
+    /**
+     * @brief the time since this tab was hidden by switching tabs in milliseconds, -1 if it's shown
+     */
+    qint64 inactiveTime() const;
+
+    /**
+     * @brief an estimation of the memory used by the texts of this tab in bytes
+     * @note only the UTF-16 texts are counted, not the layouts, the highlighting data, the undo history or the widgets
+     */
+    qint64 memoryUsage() const;
+
     bool save(bool force, const QString &head, bool safe = true);
     void saveAs();
 
@@ -111,6 +162,12 @@ class MainWindow : public QMainWindow
     void compileOnly();
     void runOnly();
     void compileAndRun();
+
+    /**
+     * @brief compile and run like compileAndRun, and run the sanitizer build on the same test cases at the same time
+     * @note only the normal build counts for the verdicts, the sanitizer reports are attached to the test cases
+     */
+    void compileAndRunWithSanitizers();
     void formatSource(bool selectionOnly, bool logOnNoChange);
 
     void applyCompanion(const Extensions::CompanionData &data);
@@ -143,18 +200,54 @@ class MainWindow : public QMainWindow
      */
     void updateTimeLimit();
 
+    /**
+     * @brief whether the program reads the input from a file and writes the output to a file in this tab
+     * @note the file names are set in the preferences
+     */
+    bool isFileIO() const;
+    void setFileIO(bool enabled);
+
+    /**
+     * @brief the names of the compile profiles of the current language, set in the preferences
+     */
+    QStringList compileProfileNames() const;
+
+    /**
+     * @brief the compile profile used by Compile and Run in this tab, empty represents for the default compile command
+     */
+    QString getCompileProfile() const;
+    void setCompileProfile(const QString &profile);
+
+    /**
+     * @brief build all compile profiles concurrently, each into its own output path
+     */
+    void compileAllProfiles();
+
   private slots:
     void onCompilationStarted();
     void onCompilationFinished(const QString &warning);
     void onCompilationErrorOccurred(const QString &error);
     void onCompilationFailed(const QString &reason);
     void onCompilationKilled();
+    void onCompileDiagnosticArrived(const Core::CompileDiagnostic &diagnostic);
+
+    /**
+     * @brief move the cursor to a position in the code
+     * @param line the line number, 1-based
+     * @param column the column number, 1-based
+     */
+    void goToPosition(int line, int column);
 
     void onRunStarted(int index);
-    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+    void onRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                       qint64 timeUsed, bool tle);
     void onFailedToStartRun(int index, const QString &error);
     void onRunOutputLimitExceeded(int index, const QString &type);
     void onRunKilled(int index);
+    void onSanitizerRunFinished(int index, const Core::OutputBuffer &out, const Core::OutputBuffer &err, int exitCode,
+                                qint64 timeUsed, bool tle);
+
+    void onSpeculativeCompilationFinished();
 
     void onFileWatcherChanged(const QString &);
     void onEditorFontChanged(const QFont &newFont);
@@ -162,6 +255,10 @@ class MainWindow : public QMainWindow
     void updateCursorInfo();
     void updateChecker();
     void runTestCase(int index);
+    void profileTestCase(int index);
+    void onProfileFinished(int index, const QMap<int, double> &lineCosts);
+    void coverageTestCase(int index);
+    void onCoverageFinished(int index, const QMap<int, qint64> &lineCounts);
     // UI Slots
 
     void on_compile_clicked();
@@ -197,7 +294,29 @@ class MainWindow : public QMainWindow
     {
         Nothing,
         Run,
-        RunDetached
+        RunDetached,
+        RunWithSanitizers
+    };
+    enum InstrumentedRun
+    {
+        ProfileRun, // profile the run by perf or callgrind
+        CoverageRun // count the line executions by gcov
+    };
+    enum SanitizerBuildState
+    {
+        NoSanitizerBuild,
+        SanitizerBuilding,
+        SanitizerBuilt,
+        SanitizerBuildFailed
+    };
+    // the result of a run, waiting to be shown in a batch with the results finished at about the same time
+    struct RunResult
+    {
+        int index;
+        Core::OutputBuffer out, err;
+        int exitCode;
+        qint64 timeUsed;
+        bool tle;
     };
 
     Ui::MainWindow *ui;
@@ -205,8 +324,23 @@ class MainWindow : public QMainWindow
     QString language;
     bool isLanguageSet = false;
 
+    // the status whose code and test cases are not loaded yet, they are used instead of the widgets until loaded
+    std::unique_ptr<EditorStatus> deferredStatus;
+    // the record in the session store of a hibernated tab, its deferredStatus has no code and no test cases
+    QString hibernationDirectory, hibernationRecordId;
+    QElapsedTimer inactiveTimer; // started when this tab is hidden by switching tabs, invalid while it's shown
+
     Core::Compiler *compiler = nullptr;
+    bool hasCompileSquiggles = false; // whether the squiggles are replaced by the diagnostics of the compilation
+    bool hasCompileError = false;     // whether the first error of the compilation is shown in the message logger
+    QVector<Core::Compiler *> profileCompilers; // the compilers started by compileAllProfiles
+    Core::Compiler *sanitizerCompiler = nullptr; // compiles the sanitizer build for compileAndRunWithSanitizers
+    QVector<Core::Runner *> sanitizerRunner;     // runs the sanitizer build on the test cases
+    SanitizerBuildState sanitizerBuildState = NoSanitizerBuild;
+    bool waitingForSanitizerBuild = false; // whether the normal build is done and waits for the sanitizer build
     QVector<Core::Runner *> runner;
+    Core::Profiler *profiler = nullptr; // profiles a run on a test case for profileTestCase
+    Core::Coverage *coverage = nullptr; // counts the line executions on a test case for coverageTestCase
     Core::Checker *checker = nullptr;
     Core::Runner *detachedRunner = nullptr;
     QTemporaryDir *tmpDir = nullptr;
@@ -234,13 +368,69 @@ class MainWindow : public QMainWindow
 
     QTimer *autoSaveTimer = nullptr;
 
+    QVector<RunResult> pendingRunResults; // the run results not shown yet
+    QTimer *runResultTimer = nullptr;     // shows the pending run results about once per frame
+
+    QMap<int, Core::HardwareCounters::Counts> runCounts; // the hardware counts of the runs, until they are shown
+
     int customTimeLimit = -1;     // the custom time limit for this tab, -1 represents for the same as settings
     QString customCompileCommand; // the custom compile command for this tab, empty represents for the same as settings
+    bool fileIO = false;          // whether the program uses file I/O instead of stdin/stdout in this tab
+    QString compileProfile;       // the compile profile for this tab, empty represents for the default compile command
+
+    Core::SpeculativeCompiler *speculativeCompiler = nullptr; // compiles the code in the background
+    QTimer *speculativeCompileTimer = nullptr;                 // starts a speculative compilation when the code is idle
+    bool waitingForSpeculativeCompilation = false; // whether the compilation waits for the speculative one to finish
+
+    int tracePipeline = 0;                // the current pipeline in the PipelineTracer, 0 before the first compile/run
+    qint64 compileTraceStart = 0;         // when the compiler was started, 0 if it's not running
+    qint64 speculativeWaitTraceStart = 0; // when the compilation started to wait for the speculative one
 
     void setEditor();
+
+    /**
+     * @brief load the properties of a status, i.e. the parts other than the code and the test cases
+     */
+    void loadStatusProperties(const EditorStatus &status, bool duplicate);
+
+    /**
+     * @brief load the code and the test cases of a status, and check whether the file is changed on the disk
+     */
+    void loadStatusContents(const EditorStatus &status);
+
+    /**
+     * @brief the deferred status with the code and the test cases, which are read from the store if it's hibernated
+     */
+    EditorStatus deferredContents() const;
+
+    /**
+     * @brief start a new pipeline in the PipelineTracer, the stages of compiling and running are recorded in it
+     * @param name the name of the action, e.g. "Compile and Run"
+     */
+    void startTracePipeline(const QString &name);
+
+    /**
+     * @brief record the end of the compilation in the current pipeline, if the compiler was started
+     * @param result how the compilation ended, e.g. "finished" or "error"
+     */
+    void traceCompilation(const QString &result);
+
+    void traceVerdict(int index, Widgets::TestCase::Verdict verdict);
+
     void compile();
+    void speculativeCompile();
+    bool waitForSpeculativeBuild(const QByteArray &hash);
+    bool takeSpeculativeBuild(const QByteArray &hash, const QString &path);
     void run();
     void run(int index);
+    bool shouldRun(int index) const;
+    void compileSanitizerBuild(const QString &path);
+    void onSanitizerBuildFinished(bool success);
+    void runWithSanitizers();
+    void runSanitizer(int index);
+    void runInstrumented(int index, InstrumentedRun kind);
+    void startProfiler(int index);
+    void startCoverage(int index);
     void loadTests();
     void saveTests(bool safe);
     void setCFToolUI();
@@ -252,9 +442,15 @@ class MainWindow : public QMainWindow
     void performCompileAndRunDiagonistics();
     static QString getRunnerHead(int index);
     QString compileCommand() const;
+    QString defaultCompileCommand() const;
+    QVector<QPair<QString, QString>> compileProfiles() const;
+    QString compileOutputPath(const QString &tmpFilePath) const;
+    QString tmpFileName() const;
     int timeLimit() const;
     void updateCompileAndRunButtons() const;
     void setStopwatch();
+    void showRunResults();
+    void showRunResult(const RunResult &result);
 
     virtual void hideEvent(QHideEvent *event) override;
     virtual void showEvent(QShowEvent *event) override;